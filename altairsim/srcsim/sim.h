@@ -25,6 +25,7 @@
  * 29-AUG-2021 new memory configuration sections
  * 09-MAY-2024 added more defines for conditional compiling components
  * 14-DEC-2024 added hardware breakpoint support
+ * 18-OCT-2026 added the web based frontend
  */
 
 #ifndef SIM_INC
@@ -53,10 +54,18 @@
 #endif
 
 #define HAS_DAZZLER	/* has simulated I/O for Cromemco Dazzler */
+#define HAS_VIDCAP	/* headless video capture (option -V) */
 #define HAS_DISKS	/* uses disk images */
 #define HAS_CONFIG	/* has configuration files somewhere */
 #define HAS_BANKED_ROM	/* emulates tarbell banked bootstrap ROM */
 
+#define HAS_NETSERVER		/* uses civet webserver to present a web based frontend */
+#define NS_DEF_PORT 8080	/* default port number for civet webserver */
+
+#define ALTAIRSIM
+#define MACHINE "altair"
+#define DOCUMENT_ROOT "../webfrontend/www/" MACHINE
+
 #define NUMNSOC 0	/* number of TCP/IP sockets for SIO connections */
 #define NUMUSOC 2	/* number of UNIX sockets for SIO connections */
 
@@ -31,6 +31,7 @@
  * 31-JUL-2021 allow building machine without frontpanel
  * 29-AUG-2021 new memory configuration sections
  * 03-JAN-2025 changed colors configuration to RGB-triple
+ * 18-OCT-2026 added port for the web server
  */
 
 #include <stdlib.h>
@@ -54,6 +55,7 @@ static const char *TAG = "config";
 
 int  fp_size = 800;	/* default frontpanel size */
 BYTE fp_port = 0;	/* default fp input port value */
+int  ns_port = NS_DEF_PORT;	/* default port to run web server on */
 
 void config(void)
 {
@@ -223,6 +225,15 @@ void config(void)
 			} else if (!strcmp(t1, "fp_size")) {
 #ifdef FRONTPANEL
 				fp_size = atoi(t2);
+#endif
+			} else if (!strcmp(t1, "ns_port")) {
+#ifdef HAS_NETSERVER
+				ns_port = atoi(t2);
+				if (ns_port < 1024 || ns_port > 65535) {
+					LOGW(TAG, "invalid port number %d",
+					     ns_port);
+					ns_port = NS_DEF_PORT;
+				}
 #endif
 			} else if (!strcmp(t1, "vdm_bg")) {
 				if ((t3 = strtok(NULL, " \t,")) == NULL ||
@@ -356,4 +367,15 @@ void config(void)
 	LOG(TAG, "SIO 2 running at %d baud\r\n", sio2_baud_rate);
 	LOG(TAG, "SIO 3 running at %d baud\r\n", sio3_baud_rate);
 	LOG(TAG, "\r\n");
+
+#ifndef HAS_NETSERVER
+	LOG(TAG, "Web server not builtin\r\n");
+#else
+	if (n_flag) {
+		LOG(TAG, "Web server builtin, URL is http://localhost:%d\r\n",
+		    ns_port);
+	} else {
+		LOG(TAG, "Web server builtin, but disabled\r\n");
+	}
+#endif
 }
@@ -31,6 +31,7 @@
  * 22-JAN-2021 added option for config file
  * 31-JUL-2021 allow building machine without frontpanel
  * 29-AUG-2021 new memory configuration sections
+ * 18-OCT-2026 added port for the web server
  */
 
 #ifndef SIMCFG_INC
@@ -41,6 +42,7 @@
 
 extern int  fp_size;
 extern BYTE fp_port;
+extern int  ns_port;
 
 extern void config(void);
 
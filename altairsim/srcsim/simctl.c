@@ -33,6 +33,8 @@
  * 31-JUL-2021 allow building machine without frontpanel
  * 29-APR-2024 print CPU execution statistics
  * 04-JAN-2025 add SDL2 support
+ * 18-OCT-2026 sample the bus for the front panel at a bounded rate
+ * 18-OCT-2026 start the web server
  */
 
 #include <stdio.h>
@@ -53,6 +55,9 @@
 #include "simctl.h"
 
 #include "unix_terminal.h"
+#ifdef HAS_NETSERVER
+#include "netsrv.h"
+#endif
 
 #ifdef FRONTPANEL
 #ifdef WANT_SDL
@@ -70,6 +75,9 @@ static const char *TAG = "system";
 #define CPUSW_STEP	2	/* single step */
 #define CPUSW_STEPCYCLE	3	/* machine cycle step */
 
+int fp_sample_count = 1;	/* memory cycles until the next bus sample */
+WORD fp_sample_seed = 0xace1;	/* LFSR for the distance of the bus samples */
+
 static BYTE fp_led_wait;
 static int cpu_switch;
 static int reset;
@@ -108,6 +116,11 @@ int boot_switch;		/* boot address for switch */
  */
 void mon(void)
 {
+#ifdef HAS_NETSERVER
+	if (n_flag)
+		start_net_services(ns_port);
+#endif
+
 #ifdef FRONTPANEL
 	if (F_flag) {
 #ifndef WANT_SDL
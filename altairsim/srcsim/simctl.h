@@ -12,6 +12,13 @@
 
 extern int boot_switch;			/* boot address for switch */
 
+#ifdef FRONTPANEL
+#define FP_SAMPLE_MASK	15	/* max. memory cycles between bus samples - 1 */
+
+extern int fp_sample_count;		/* memory cycles until the next sample */
+extern WORD fp_sample_seed;		/* LFSR for the distance of the samples */
+#endif
+
 extern void mon(void);
 
 extern bool wait_step(void);
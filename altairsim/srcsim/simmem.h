@@ -19,11 +19,15 @@
  * 31-JUL-2021 allow building machine without frontpanel
  * 29-AUG-2021 new memory configuration sections
  * 14-DEC-2024 added hardware breakpoint support
+ * 18-OCT-2026 add block functions for direct memory access
+ * 18-OCT-2026 sample the bus for the front panel at a bounded rate
  */
 
 #ifndef SIMMEM_INC
 #define SIMMEM_INC
 
+#include <string.h>
+
 #include "sim.h"
 #include "simdefs.h"
 #ifdef WANT_ICE
@@ -69,15 +73,47 @@ extern int p_tab[MAXPAGES];
 
 extern void init_memory(void);
 
+#ifdef FRONTPANEL
 /*
- * memory access for the CPU cores
+ * front panel part of a memory cycle of the CPU. The clock counts every
+ * cycle, but at full speed the bus is sampled only every 1 to
+ * FP_SAMPLE_MASK + 1 cycles, the distance is taken from a LFSR so that
+ * loops don't alias with it. The lights integrate the samples weighted
+ * with the clock, so they still show the right brightness. Only when
+ * single stepping the cycle is timed and may wait in wait_step().
  */
-static inline void memwrt(WORD addr, BYTE data)
+static inline void fp_memcycle(WORD addr, BYTE data)
 {
-#ifdef FRONTPANEL
 	uint64_t t;
+
+	fp_clock++;
+	fp_led_address = addr;
+	fp_led_data = data;
+
+	if (cpu_state == ST_SINGLE_STEP) {
+		t = get_clock_us();
+		fp_sampleData();
+		wait_step();
+		cpu_tadj += get_clock_us() - t;
+		return;
+	}
+
+	cpu_bus &= ~CPU_M1;
+	m1_step = false;
+	if (--fp_sample_count <= 0) {
+		fp_sample_seed = (fp_sample_seed >> 1) ^
+				 (-(fp_sample_seed & 1) & 0xb400);
+		fp_sample_count = (fp_sample_seed & FP_SAMPLE_MASK) + 1;
+		fp_sampleData();
+	}
+}
 #endif
 
+/*
+ * memory access for the CPU cores
+ */
+static inline void memwrt(WORD addr, BYTE data)
+{
 #ifdef BUS_8080
 #ifndef FRONTPANEL
 	cpu_bus &= ~CPU_M1;
@@ -86,15 +122,9 @@ static inline void memwrt(WORD addr, BYTE data)
 #endif
 
 #ifdef FRONTPANEL
-	if (F_flag) {
-		t = get_clock_us();
-		fp_clock++;
-		fp_led_address = addr;
-		fp_led_data = 0xff;
-		fp_sampleData();
-		wait_step();
-		cpu_tadj += get_clock_us() - t;
-	} else
+	if (F_flag)
+		fp_memcycle(addr, 0xff);
+	else
 		cpu_bus &= ~CPU_M1;
 #endif
 
@@ -112,9 +142,6 @@ static inline void memwrt(WORD addr, BYTE data)
 static inline BYTE memrdr(WORD addr)
 {
 	register BYTE data;
-#ifdef FRONTPANEL
-	uint64_t t;
-#endif
 
 #ifdef WANT_HB
 	if (hb_flag && hb_addr == addr) {
@@ -153,15 +180,9 @@ static inline BYTE memrdr(WORD addr)
 #endif
 
 #ifdef FRONTPANEL
-	if (F_flag) {
-		t = get_clock_us();
-		fp_clock++;
-		fp_led_address = addr;
-		fp_led_data = data;
-		fp_sampleData();
-		wait_step();
-		cpu_tadj += get_clock_us() - t;
-	} else
+	if (F_flag)
+		fp_memcycle(addr, data);
+	else
 		cpu_bus &= ~CPU_M1;
 #endif
 
@@ -192,6 +213,50 @@ static inline void dma_write(WORD addr, BYTE data)
 		memory[addr] = data;
 }
 
+/*
+ * block memory access for DMA devices, the transfer is split at page
+ * boundaries and each page is copied with memcpy()
+ */
+static inline void dma_read_block(WORD addr, BYTE *buf, int len)
+{
+	register int n;
+
+	/* an active Tarbell ROM switches off on the first access above it */
+	while (len > 0 && tarbell_rom_active && tarbell_rom_enabled) {
+		*buf++ = dma_read(addr++);
+		len--;
+	}
+
+	while (len > 0) {
+		n = 256 - (addr & 0xff);
+		if (n > len)
+			n = len;
+		if (p_tab[addr >> 8] != MEM_NONE)
+			memcpy(buf, &memory[addr], n);
+		else
+			memset(buf, 0xff, n);
+		addr += n;
+		buf += n;
+		len -= n;
+	}
+}
+
+static inline void dma_write_block(WORD addr, const BYTE *buf, int len)
+{
+	register int n;
+
+	while (len > 0) {
+		n = 256 - (addr & 0xff);
+		if (n > len)
+			n = len;
+		if (p_tab[addr >> 8] == MEM_RW)
+			memcpy(&memory[addr], buf, n);
+		addr += n;
+		buf += n;
+		len -= n;
+	}
+}
+
 /*
  * direct memory access for simulation frame, video logic, etc.
  */
@@ -29,12 +29,12 @@
 #endif
 
 #define HAS_DISKS	/* uses disk images */
+#define HAS_BATCH	/* batch jobs with console script (option -b) */
 /*#define HAS_CONFIG*/	/* has no configuration file */
 
 #define PIPES		/* use named pipes for auxiliary device */
 #define NETWORKING	/* TCP/IP networked serial ports */
-#define NUMSOC	4	/* number of server sockets */
-#define TCPASYNC	/* tcp/ip server can use async I/O */
+#define NUMSOC	15	/* number of server sockets, MP/M has max. 16 consoles */
 /*#define CNETDEBUG*/	/* client network protocol debugger */
 /*#define SNETDEBUG*/	/* server network protocol debugger */
 
@@ -27,6 +27,28 @@
 #include "log.h"
 static const char *TAG = "system";
 
+#ifdef WANT_ICE
+/*
+ *	give the terminal to the machine
+ */
+static void ice_go(void)
+{
+	set_unix_terminal();
+	hold_io(false);
+}
+
+/*
+ *	give the terminal back to ICE
+ */
+static void ice_break(void)
+{
+	hold_io(true);
+	/* write the output the guest left buffered before ICE prompts */
+	flush_io();
+	reset_unix_terminal();
+}
+#endif
+
 /*
  *	This function initializes the terminal, loads boot code
  *	and then the Z80 CPU emulation is started.
@@ -40,9 +62,18 @@ void mon(void)
 	/* empty buffer for teletype */
 	fflush(stdout);
 
+	/* a batch job runs without terminal and ICE */
+	if (b_flag) {
+		run_cpu();
+		flush_io();
+		report_cpu_error();
+		report_cpu_stats();
+		return;
+	}
+
 #ifdef WANT_ICE
-	ice_before_go = set_unix_terminal;
-	ice_after_go = reset_unix_terminal;
+	ice_before_go = ice_go;
+	ice_after_go = ice_break;
 	atexit(reset_unix_terminal);
 
 	ice_cmd_loop(0);
@@ -54,6 +85,9 @@ void mon(void)
 	/* start CPU emulation */
 	run_cpu();
 
+	/* write the output the guest left buffered */
+	flush_io();
+
 	/* reset terminal */
 	reset_unix_terminal();
 
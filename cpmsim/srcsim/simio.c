@@ -58,6 +58,18 @@
  * 08-OCT-2019 (Mike Douglas) added OUT 161 trap to simbdos.c for host file I/O
  * 24-OCT-2019 move RTC to I/O module for usage by any machine
  * 27-MAY-2024 moved io_in & io_out to simcore
+ * 18-OCT-2026 disk images can be host directories
+ * 18-OCT-2026 read ahead whole tracks from disk images
+ * 18-OCT-2026 collect disk I/O statistics
+ * 18-OCT-2026 read console and socket input with an input thread into rings
+ * 18-OCT-2026 buffer console, printer and aux output
+ * 18-OCT-2026 timer and server sockets handled by the I/O thread, no signals
+ * 18-OCT-2026 up to NUMSOC socket consoles through multiplexer ports
+ * 18-OCT-2026 batch jobs with console script and exit status
+ * 18-OCT-2026 read ahead windows of large tracks, detect changed images
+ * 18-OCT-2026 no stat of the disk image for every sector read
+ * 18-OCT-2026 don't read stdin in the input thread while ICE runs
+ * 18-OCT-2026 telnet negotiation in the input thread, without blocking it
  */
 
 /*
@@ -110,6 +122,11 @@
  *	50 - client socket #1 status
  *	51 - client socket #1 data
  *
+ *	52 - console multiplexer select (write console 1-NUMSOC,
+ *	     read number of consoles)
+ *	53 - selected console status
+ *	54 - selected console data
+ *
  *	160 - hardware control
  */
 
@@ -119,6 +136,8 @@
 #include <string.h>
 #include <signal.h>
 #include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/poll.h>
@@ -134,6 +153,11 @@
 
 #include "rtc80.h"
 #include "simbdos.h"
+#include "trackcache.h"
+#include "diskstats.h"
+#include "ringbuf.h"
+#include "outbuf.h"
+#include "batch.h"
 
 #ifdef NETWORKING
 #include <stdio.h>
@@ -152,6 +176,21 @@ static const char *TAG = "IO";
 #define MAX_BUSY_COUNT 10	/* max counter to detect I/O busy waiting
 				   on the console status port */
 
+/* input rings: console 0, the server sockets and the client socket */
+#ifdef NETWORKING
+#define IN_CS	(NUMSOC + 1)	/* input ring of client socket #1 */
+#define NUMIN	(NUMSOC + 2)	/* number of input rings */
+#define NUMPOLL	(NUMIN + NUMSOC + 1) /* fds polled incl. server sockets */
+#else
+#define NUMIN	1
+#define NUMPOLL	(NUMIN + 1)
+#endif
+#define OUT_PRT	NUMIN		/* output buffer of the printer */
+#define OUT_AUX	(NUMIN + 1)	/* output buffer of the aux device */
+#define NUMOUT	(NUMIN + 2)	/* number of output buffers */
+#define OUT_DELAY 1		/* max. milliseconds output stays buffered */
+#define TIMER_US 10000		/* period of the interrupt timer */
+
 static BYTE drive;		/* current drive A..P (0..15) */
 static BYTE track;		/* current track (0..255) */
 static unsigned int sector;	/* current sector (0..65535) */
@@ -175,11 +214,38 @@ static int drivem;		/* fd for file "drivem.dsk" */
 static int driven;		/* fd for file "driven.dsk" */
 static int driveo;		/* fd for file "driveo.dsk" */
 static int drivep;		/* fd for file "drivep.dsk" */
+static trackcache_t tcache[16];	/* read-ahead buffers for the disk images */
+static diskstats_t dstat[16] = { /* I/O statistics for the disks */
+	DISKSTATS_INIT("FDC", "drivea.dsk"), DISKSTATS_INIT("FDC", "driveb.dsk"),
+	DISKSTATS_INIT("FDC", "drivec.dsk"), DISKSTATS_INIT("FDC", "drived.dsk"),
+	DISKSTATS_INIT("FDC", "drivee.dsk"), DISKSTATS_INIT("FDC", "drivef.dsk"),
+	DISKSTATS_INIT("FDC", "driveg.dsk"), DISKSTATS_INIT("FDC", "driveh.dsk"),
+	DISKSTATS_INIT("FDC", "drivei.dsk"), DISKSTATS_INIT("FDC", "drivej.dsk"),
+	DISKSTATS_INIT("FDC", "drivek.dsk"), DISKSTATS_INIT("FDC", "drivel.dsk"),
+	DISKSTATS_INIT("FDC", "drivem.dsk"), DISKSTATS_INIT("FDC", "driven.dsk"),
+	DISKSTATS_INIT("FDC", "driveo.dsk"), DISKSTATS_INIT("FDC", "drivep.dsk")
+};
 static int printer;		/* fd for file "printer.txt" */
 static char fn[MAX_LFN];	/* path/filename for disk images */
 static int speed;		/* to reset CPU speed */
 static BYTE hwctl_lock = 0xff;	/* lock status hardware control port */
 
+static ringbuf_t in_rb[NUMIN];	/* input rings */
+static bool in_skip[NUMIN];	/* telnet: drop byte following CR */
+static pthread_t in_thread;	/* input thread */
+static int in_wake[2] = { -1, -1 }; /* pipe to wake up the input thread */
+static bool in_exit;		/* tell the input thread to exit */
+#ifdef WANT_ICE
+static bool in_hold = true;	/* ICE reads stdin, the thread doesn't */
+#else
+static bool in_hold;
+#endif
+static pthread_mutex_t in_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t in_cond = PTHREAD_COND_INITIALIZER; /* input arrived */
+static bool in_idle;		/* input thread polls without timeout */
+static outbuf_t out_buf[NUMOUT]; /* output buffers, same index as input */
+static bool out_pending;	/* output buffered, flush by input thread */
+
 #ifdef PIPES
 static int auxin;		/* fd for pipe "auxin" */
 static int auxout;		/* fd for pipe "auxout" */
@@ -195,10 +261,17 @@ static int aux_out;		/* fd for file "auxiliaryout.txt" */
 
 #define TELNET_TIMEOUT 800	/* telnet negotiation timeout in milliseconds */
 
+/* telnet protocol states */
+enum { TN_DATA, TN_IAC, TN_OPT, TN_SB, TN_SB_IAC };
+
 static int ss[NUMSOC];		/* server socket descriptors */
 static int ssc[NUMSOC];		/* connected server socket descriptors */
 static int ss_port[NUMSOC];	/* TCP/IP port for server sockets */
 static int ss_telnet[NUMSOC];	/* telnet protocol flag for server sockets */
+static int tn_state[NUMSOC];	/* telnet protocol state of connections */
+static BYTE tn_cmd[NUMSOC];	/* telnet option command received */
+static uint64_t tn_until[NUMSOC]; /* end of telnet negotiation, 0 if done */
+static int con_sel;		/* console selected at multiplexer ports */
 static int cs;			/* client socket #1 descriptor */
 static int cs_port;		/* TCP/IP port for cs */
 static char cs_host[BUFSIZE];	/* hostname for cs */
@@ -214,22 +287,22 @@ static int sdirection = -1; /* protocol direction, 0 = send 1 = receive */
 #endif /* NETWORKING */
 
 dskdef_t disks[16] = {
-	{ "drivea.dsk", &drivea, 77, 26 },
-	{ "driveb.dsk", &driveb, 77, 26 },
-	{ "drivec.dsk", &drivec, 77, 26 },
-	{ "drived.dsk", &drived, 77, 26 },
-	{ "drivee.dsk", &drivee,  0,  0 },
-	{ "drivef.dsk", &drivef,  0,  0 },
-	{ "driveg.dsk", &driveg,  0,  0 },
-	{ "driveh.dsk", &driveh,  0,  0 },
-	{ "drivei.dsk", &drivei, 255, 128 },
-	{ "drivej.dsk", &drivej, 255, 128 },
-	{ "drivek.dsk", &drivek, 255, 128 },
-	{ "drivel.dsk", &drivel, 255, 128 },
-	{ "drivem.dsk", &drivem,  0,  0 },
-	{ "driven.dsk", &driven,  0,  0 },
-	{ "driveo.dsk", &driveo,  0,  0 },
-	{ "drivep.dsk", &drivep, 256, 16384 }
+	{ "drivea.dsk", &drivea, 77, 26, NULL },
+	{ "driveb.dsk", &driveb, 77, 26, NULL },
+	{ "drivec.dsk", &drivec, 77, 26, NULL },
+	{ "drived.dsk", &drived, 77, 26, NULL },
+	{ "drivee.dsk", &drivee,  0,  0, NULL },
+	{ "drivef.dsk", &drivef,  0,  0, NULL },
+	{ "driveg.dsk", &driveg,  0,  0, NULL },
+	{ "driveh.dsk", &driveh,  0,  0, NULL },
+	{ "drivei.dsk", &drivei, 255, 128, NULL },
+	{ "drivej.dsk", &drivej, 255, 128, NULL },
+	{ "drivek.dsk", &drivek, 255, 128, NULL },
+	{ "drivel.dsk", &drivel, 255, 128, NULL },
+	{ "drivem.dsk", &drivem,  0,  0, NULL },
+	{ "driven.dsk", &driven,  0,  0, NULL },
+	{ "driveo.dsk", &driveo,  0,  0, NULL },
+	{ "drivep.dsk", &drivep, 256, 16384, NULL }
 };
 
 /*
@@ -277,20 +350,24 @@ static BYTE cond3_in(void), cons3_in(void);
 static void cond3_out(BYTE data), cons3_out(BYTE data);
 static BYTE cond4_in(void), cons4_in(void);
 static void cond4_out(BYTE data), cons4_out(BYTE data);
+static BYTE consel_in(void), consm_in(void), condm_in(void);
+static void consel_out(BYTE data), consm_out(BYTE data), condm_out(BYTE data);
 static BYTE netd1_in(void), nets1_in(void);
 static void netd1_out(BYTE data), nets1_out(BYTE data);
 
 /*
  *	Forward declaration of support functions
  */
-static void int_timer(int sig);
+static void *input_thread(void *arg);
+static void in_wakeup(void);
+static int out_fd(int i);
+static void out_flush(int i, bool wait);
 
 #ifdef NETWORKING
 static void net_server_config(void), net_client_config(void);
-static void init_server_socket(int n), telnet_negotiation(int fd);
-#ifdef TCPASYNC
-static void int_io(int sig);
-#endif
+static void init_server_socket(int n);
+static bool telnet_filter(int n, BYTE c);
+static void accept_server_socket(int n);
 #endif
 
 /*
@@ -332,6 +409,9 @@ in_func_t *const port_in[256] = {
 	[ 47] = cond4_in,
 	[ 50] = nets1_in,
 	[ 51] = netd1_in,
+	[ 52] = consel_in,
+	[ 53] = consm_in,
+	[ 54] = condm_in,
 	[160] = hwctl_in	/* virtual hardware control */
 };
 
@@ -374,30 +454,37 @@ out_func_t *const port_out[256] = {
 	[ 47] = cond4_out,
 	[ 50] = nets1_out,
 	[ 51] = netd1_out,
+	[ 52] = consel_out,
+	[ 53] = consm_out,
+	[ 54] = condm_out,
 	[160] = hwctl_out,	/* virtual hardware control */
 	[161] = host_bdos_out	/* host file I/O hook */
 };
 
 /*
  *	This function initializes the I/O handlers:
- *	1. Creates the named pipes under /tmp/.z80pack, if they don't
+ *	1. Read the console script of a batch job.
+ *	2. Creates the named pipes under /tmp/.z80pack, if they don't
  *	   exist.
- *	2. Fork the process for receiving from the auxiliary serial port.
- *	3. Open the named pipes "auxin" and "auxout" for simulation
+ *	3. Fork the process for receiving from the auxiliary serial port.
+ *	4. Open the named pipes "auxin" and "auxout" for simulation
  *	   of the auxiliary serial port.
- *	4. Open the files which emulate the disk drives.
+ *	5. Open the files which emulate the disk drives.
  *	   Errors for opening one of the drives results
  *	   in a NULL pointer for fd in the dskdef structure,
- *	   so that this drive can't be used.
- *	5. Prepare TCP/IP sockets for serial port simulation
+ *	   so that this drive can't be used. If the disk
+ *	   image is a directory, its files are used as disk.
+ *	6. Prepare TCP/IP sockets for serial port simulation
+ *	7. Start the I/O thread handling input, connections and timer
  */
 void init_io(void)
 {
 	register int i;
 	struct stat sbuf;
-#if defined(NETWORKING) && defined(TCPASYNC)
-	static struct sigaction newact;
-#endif
+	sigset_t set, oset;
+
+	if (b_flag && !batch_init(bfn))
+		exit(EXIT_FAILURE);
 
 #ifdef PIPES
 	/* check if /tmp/.z80pack exists */
@@ -458,6 +545,14 @@ void init_io(void)
 		strcat(fn, "/");
 		strcat(fn, disks[i].fn);
 
+		/* a directory is used as a disk holding its files */
+		if ((stat(fn, &sbuf) == 0) && S_ISDIR(sbuf.st_mode)) {
+			disks[i].fd = NULL;
+			disks[i].hd = hostdisk_open(fn, disks[i].tracks,
+						    disks[i].sectors);
+			continue;
+		}
+
 		if ((*disks[i].fd = open(fn, O_RDWR)) == -1)
 			if ((*disks[i].fd = open(fn, O_RDONLY)) == -1)
 				disks[i].fd = NULL;
@@ -467,16 +562,28 @@ void init_io(void)
 	net_server_config();
 	net_client_config();
 
-#ifdef TCPASYNC
-	newact.sa_handler = int_io;
-	sigemptyset(&newact.sa_mask);
-	newact.sa_flags = 0;
-	sigaction(SIGIO, &newact, NULL);
-#endif
-
 	for (i = 0; i < NUMSOC; i++)
 		init_server_socket(i);
 #endif /* NETWORKING */
+
+	for (i = 0; i < NUMOUT; i++)
+		outbuf_init(&out_buf[i], (i > 0) && (i < NUMIN));
+
+	if (pipe(in_wake) == -1) {
+		LOGE(TAG, "can't create pipe for input thread");
+		exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < 2; i++)
+		fcntl(in_wake[i], F_SETFL,
+		      fcntl(in_wake[i], F_GETFL, 0) | O_NONBLOCK);
+	/* signals are handled by the CPU thread */
+	sigfillset(&set);
+	pthread_sigmask(SIG_BLOCK, &set, &oset);
+	if (pthread_create(&in_thread, NULL, input_thread, NULL) != 0) {
+		LOGE(TAG, "can't create input thread");
+		exit(EXIT_FAILURE);
+	}
+	pthread_sigmask(SIG_SETMASK, &oset, NULL);
 }
 
 #ifdef NETWORKING
@@ -487,9 +594,6 @@ static void init_server_socket(int n)
 {
 	struct sockaddr_in sin;
 	int on = 1;
-#ifdef TCPASYNC
-	int i;
-#endif
 
 	if (ss_port[n] == 0)
 		return;
@@ -502,14 +606,6 @@ static void init_server_socket(int n)
 		LOGE(TAG, "can't setsockopt SO_REUSEADDR on server socket");
 		exit(EXIT_FAILURE);
 	}
-#ifdef TCPASYNC
-	fcntl(ss[n], F_SETOWN, getpid());
-	i = fcntl(ss[n], F_GETFL, 0);
-	if (fcntl(ss[n], F_SETFL, i | O_ASYNC) == -1) {
-		LOGE(TAG, "can't fcntl O_ASYNC on server socket");
-		exit(EXIT_FAILURE);
-	}
-#endif
 	memset((void *) &sin, 0, sizeof(sin));
 	sin.sin_family = AF_INET;
 	sin.sin_addr.s_addr = INADDR_ANY;
@@ -545,7 +641,7 @@ static void net_server_config(void)
 			if ((*s == '\n') || (*s == '#'))
 				continue;
 			i = atoi(s);
-			if ((i < 1) || (i > 4)) {
+			if ((i < 1) || (i > NUMSOC)) {
 				LOGW(TAG, "console %d not supported", i);
 				continue;
 			}
@@ -613,14 +709,30 @@ static void net_client_config(void)
  *	3. The named pipes "auxin" and "auxout" are closed.
  *	4. The receiving process for the aux serial port is stopped.
  *	5. All connected sockets are closed
+ *	6. The input thread is stopped and buffered output written
  */
 void exit_io(void)
 {
 	register int i;
 
-	for (i = 0; i <= 15; i++)
+	if (in_wake[1] != -1) {
+		in_exit = true;
+		in_wakeup();
+		pthread_join(in_thread, NULL);
+		close(in_wake[0]);
+		close(in_wake[1]);
+		in_wake[0] = in_wake[1] = -1;
+	}
+	for (i = 0; i < NUMOUT; i++)
+		outbuf_drain(&out_buf[i], out_fd(i));
+
+	for (i = 0; i <= 15; i++) {
 		if (disks[i].fd != NULL)
 			close(*disks[i].fd);
+		if (disks[i].hd != NULL)
+			hostdisk_close(disks[i].hd);
+		trackcache_free(&tcache[i]);
+	}
 
 	if (printer != 0)
 		close(printer);
@@ -667,315 +779,531 @@ void reset_system(void)
 }
 
 /*
- *	I/O handler for read console 0 status:
- *	0xff : input available
- *	0x00 : no input available
+ *	All host events are handled by one I/O thread, so that no signals
+ *	interrupt the CPU thread. The input of console 0, the connected
+ *	server sockets and the client socket is read into the input rings,
+ *	so that the status and data port handlers just test and get
+ *	bytes from memory. The thread also accepts connections on the
+ *	server sockets, runs the 10ms interrupt timer and writes the
+ *	buffered output. It polls the file descriptors which are set
+ *	when it is woken up through the pipe in_wake, the CPU thread
+ *	closes a socket while holding in_mutex, so that the input
+ *	thread doesn't read from a closed descriptor.
  */
-static BYTE cons_in(void)
+static int in_fd(int i)
+{
+#ifdef NETWORKING
+	if (i == IN_CS)
+		return (cs != 0) ? cs : -1;
+	if (i > 0)
+		return (ssc[i - 1] != 0) ? ssc[i - 1] : -1;
+#endif
+	/* console 0 of a batch job is the script */
+	if (b_flag || __atomic_load_n(&in_hold, __ATOMIC_ACQUIRE))
+		return -1;
+	return fileno(stdin);
+}
+
+/*
+ *	Output of console 0, the connected server sockets, the client
+ *	socket, the printer and the aux device is collected in output
+ *	buffers. They are written when full, when the guest polls the
+ *	input of the device, so that echoed characters show up right
+ *	away, and by the input thread at the latest OUT_DELAY ms after
+ *	the output. Buffers with index < NUMIN belong to the input ring
+ *	with the same index.
+ */
+static int out_fd(int i)
 {
-	struct pollfd p[1];
+	if (i == OUT_PRT)
+		return (printer != 0) ? printer : -1;
+	if (i == OUT_AUX)
+#ifdef PIPES
+		return auxout;
+#else
+		return (aux_out != 0) ? aux_out : -1;
+#endif
+	if (i == 0)
+		return fileno(stdout);
+	return in_fd(i);
+}
 
-	if (++busy_loop_cnt >= MAX_BUSY_COUNT) {
-		sleep_for_ms(1);
-		busy_loop_cnt = 0;
+/*
+ *	report a write error of output buffer i
+ */
+static void out_error(int i)
+{
+	if (i == OUT_AUX) {
+		LOGE(TAG, "can't write to aux device");
+		return;
 	}
-
-	p[0].fd = fileno(stdin);
-	p[0].events = POLLIN;
-	p[0].revents = 0;
-	poll(p, 1, 0);
-	if (p[0].revents & POLLIN)
-		return (BYTE) 0xff;
+	if (i == OUT_PRT)
+		LOGE(TAG, "can't write to printer.txt");
+#ifdef NETWORKING
+	else if (i == IN_CS)
+		LOGE(TAG, "can't write client socket");
+#endif
 	else
-		return (BYTE) 0x00;
+		LOGE(TAG, "can't write console %d", i);
+	cpu_error = IOERROR;
+	cpu_state = ST_STOPPED;
 }
 
 /*
- *	I/O handler for read console 1 status:
- *	bit 0 = 1: input available
- *	bit 1 = 1: output writable
+ *	put a byte into output buffer i and have the input thread
+ *	flush it, if it isn't flushed earlier
  */
-static BYTE cons1_in(void)
+static void out_put(int i, BYTE data)
 {
-	BYTE status = 0;
-#ifdef NETWORKING
-	struct pollfd p[1];
+	if (!outbuf_put(&out_buf[i], out_fd(i), data))
+		out_error(i);
 
-#ifndef TCPASYNC
-	socklen_t alen;
-	struct sockaddr_in fsin;
-	int go_away;
-	int on = 1;
+	if (!__atomic_load_n(&out_pending, __ATOMIC_RELAXED)) {
+		__atomic_store_n(&out_pending, true, __ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&in_idle, __ATOMIC_SEQ_CST))
+			in_wakeup();
+	}
+}
 
-	if (ss[0] == 0)
-		return status;
+/*
+ *	write output buffer i, if wait is false sockets are
+ *	written without blocking
+ */
+static void out_flush(int i, bool wait)
+{
+	if (outbuf_pending(&out_buf[i]) &&
+	    !outbuf_flush(&out_buf[i], out_fd(i), wait))
+		out_error(i);
+}
 
-	p[0].fd = ss[0];
-	p[0].events = POLLIN;
-	p[0].revents = 0;
-	poll(p, 1, 0);
+/*
+ *	write all output buffers
+ */
+static void out_flush_all(bool wait)
+{
+	int i;
 
-	if (p[0].revents) {
+	__atomic_store_n(&out_pending, false, __ATOMIC_SEQ_CST);
+	for (i = 0; i < NUMOUT; i++) {
+		out_flush(i, wait);
+		if (outbuf_pending(&out_buf[i]))
+			__atomic_store_n(&out_pending, true, __ATOMIC_SEQ_CST);
+	}
+}
 
-		alen = sizeof(fsin);
+/*
+ *	write all buffered output, before the simulator
+ *	prints something itself
+ */
+void flush_io(void)
+{
+	out_flush_all(true);
+}
 
-		if (ssc[0] != 0) {
-			go_away = accept(ss[0],
-					 (struct sockaddr *) &fsin, &alen);
-			close(go_away);
-			goto ss0_done;
-		}
+static void *input_thread(void *arg)
+{
+	struct pollfd p[NUMPOLL];
+	int idx[NUMIN];
+	BYTE buf[256], *s;
+	ssize_t n;
+	size_t len;
+	int i, np, fd, timeout;
+	uint64_t now, tick = 0;
 
-		if ((ssc[0] = accept(ss[0], (struct sockaddr *) &fsin,
-				     &alen)) == -1) {
-			LOGW(TAG, "can't accept server socket");
-			ssc[0] = 0;
-		}
+	UNUSED(arg);
 
-		if (setsockopt(ssc[0], IPPROTO_TCP, TCP_NODELAY,
-			       (void *) &on, sizeof(on)) == -1) {
-			LOGW(TAG, "can't setsockopt TCP_NODELAY on server socket");
+	while (!in_exit) {
+		p[0].fd = in_wake[0];
+		p[0].events = POLLIN;
+		p[0].revents = 0;
+		np = 1;
+		timeout = -1;
+
+		/* 10ms timer causing maskable interrupt */
+		if (__atomic_load_n(&timer, __ATOMIC_ACQUIRE)) {
+			now = get_clock_us();
+			if (tick == 0)
+				tick = now + TIMER_US;
+			else if (now >= tick) {
+				int_data = 0xff; /* RST 38H for IM 0, 0FFH for IM 2 */
+				__atomic_store_n(&int_int, true,
+						 __ATOMIC_RELEASE);
+				tick += TIMER_US;
+				if (tick <= now)	/* drop lost ticks */
+					tick = now + TIMER_US;
+			}
+			timeout = (tick - now + 999) / 1000;
+		} else
+			tick = 0;
+
+		for (i = 0; i < NUMIN; i++) {
+			idx[i] = -1;
+			if ((fd = in_fd(i)) == -1 || rb_closed(&in_rb[i]))
+				continue;
+			if (rb_space(&in_rb[i]) == 0) {
+				/* retry when the CPU got some */
+				if ((timeout == -1) || (timeout > 10))
+					timeout = 10;
+				continue;
+			}
+			p[np].fd = fd;
+			p[np].events = POLLIN;
+			p[np].revents = 0;
+			idx[i] = np++;
+		}
+		/* buffered output is written after OUT_DELAY ms */
+		if (__atomic_load_n(&out_pending, __ATOMIC_SEQ_CST))
+			timeout = OUT_DELAY;
+		else if ((timeout == -1) || (timeout > OUT_DELAY)) {
+			__atomic_store_n(&in_idle, true, __ATOMIC_SEQ_CST);
+			if (__atomic_load_n(&out_pending, __ATOMIC_SEQ_CST))
+				timeout = OUT_DELAY;
+		}
+#ifdef NETWORKING
+		for (i = 0; i < NUMSOC; i++) {
+			p[np + i].fd = (ss[i] != 0) ? ss[i] : -1;
+			p[np + i].events = POLLIN;
+			p[np + i].revents = 0;
+		}
+		if (poll(p, np + NUMSOC, timeout) == -1) {
+#else
+		if (poll(p, np, timeout) == -1) {
+#endif
+			__atomic_store_n(&in_idle, false, __ATOMIC_SEQ_CST);
+			if (errno == EINTR)
+				continue;
+			LOGE(TAG, "can't poll console input");
+			break;
 		}
+		__atomic_store_n(&in_idle, false, __ATOMIC_SEQ_CST);
 
-		if (ss_telnet[0])
-			telnet_negotiation(ssc[0]);
-	}
-ss0_done:
-#endif /* !TCPASYNC */
+		if (__atomic_load_n(&out_pending, __ATOMIC_SEQ_CST))
+			out_flush_all(false);
 
-	if (ssc[0] != 0) {
-		p[0].fd = ssc[0];
-		p[0].events = POLLIN | POLLOUT;
-		p[0].revents = 0;
-		poll(p, 1, 0);
-		if (p[0].revents & POLLHUP) {
-			close(ssc[0]);
-			ssc[0] = 0;
-			return 0;
-		}
 		if (p[0].revents & POLLIN)
-			status |= 1;
-		if (p[0].revents & POLLOUT)
-			status |= 2;
+			while (read(in_wake[0], buf, sizeof(buf)) > 0)
+				;
+
+		pthread_mutex_lock(&in_mutex);
+		for (i = 0; i < NUMIN; i++) {
+			if ((idx[i] == -1) || !p[idx[i]].revents ||
+			    (p[idx[i]].revents & POLLNVAL))
+				continue;
+			/* closed by the CPU thread in the meantime? */
+			if ((fd = in_fd(i)) != p[idx[i]].fd)
+				continue;
+			len = rb_space(&in_rb[i]);
+			if (len > sizeof(buf))
+				len = sizeof(buf);
+			n = read(fd, buf, len);
+			if ((n == -1) && ((errno == EINTR) || (errno == EAGAIN)))
+				continue;
+			if (n <= 0) {
+				rb_close(&in_rb[i]);
+				continue;
+			}
+			for (s = buf; n > 0; n--, s++) {
+#ifdef NETWORKING
+				/* options sent during telnet negotiation */
+				if ((i > 0) && (i <= NUMSOC) && tn_until[i - 1]
+				    && !telnet_filter(i - 1, *s))
+					continue;
+#endif
+				/* telnet sends CR LF or CR NUL, drop the 2nd */
+				if (in_skip[i]) {
+					in_skip[i] = false;
+					continue;
+				}
+#ifdef NETWORKING
+				if ((*s == '\r') && (i > 0) && (i <= NUMSOC) &&
+				    ss_telnet[i - 1])
+					in_skip[i] = true;
+#endif
+				rb_put(&in_rb[i], *s);
+			}
+		}
+		pthread_cond_broadcast(&in_cond);
+		pthread_mutex_unlock(&in_mutex);
+
+#ifdef NETWORKING
+		for (i = 0; i < NUMSOC; i++)
+			if (p[np + i].revents)
+				accept_server_socket(i);
+#endif
 	}
-#endif /* NETWORKING */
-	return status;
+
+	return NULL;
 }
 
 /*
- *	I/O handler for read console 2 status:
- *	bit 0 = 1: input available
- *	bit 1 = 1: output writable
+ *	stop or continue reading stdin in the input thread, while
+ *	ICE reads the terminal the keys typed must not go to the guest
  */
-static BYTE cons2_in(void)
+void hold_io(bool hold)
 {
-	BYTE status = 0;
-#ifdef NETWORKING
-	struct pollfd p[1];
-
-#ifndef TCPASYNC
-	socklen_t alen;
-	struct sockaddr_in fsin;
-	int go_away;
-	int on = 1;
-
-	if (ss[1] == 0)
-		return status;
-
-	p[0].fd = ss[1];
-	p[0].events = POLLIN;
-	p[0].revents = 0;
-	poll(p, 1, 0);
-
-	if (p[0].revents) {
+	pthread_mutex_lock(&in_mutex);
+	__atomic_store_n(&in_hold, hold, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&in_mutex);
+	in_wakeup();
+}
 
-		alen = sizeof(fsin);
+/*
+ *	wake up the input thread after a descriptor was opened
+ */
+static void in_wakeup(void)
+{
+	BYTE c = 0;
 
-		if (ssc[1] != 0) {
-			go_away = accept(ss[1],
-					 (struct sockaddr *) &fsin, &alen);
-			close(go_away);
-			goto ss1_done;
-		}
+	if (write(in_wake[1], &c, 1) != 1) {
+		/* pipe is full, the thread will wake up anyway */
+	}
+}
 
-		if ((ssc[1] = accept(ss[1], (struct sockaddr *) &fsin,
-				     &alen)) == -1) {
-			LOGW(TAG, "can't accept server socket");
-			ssc[1] = 0;
-		}
+/*
+ *	Wait until input ring i has data, the input is closed or the
+ *	CPU is stopped. Waits at most ms milliseconds if ms > 0.
+ *	Returns true if data is available.
+ */
+static bool in_wait(int i, int ms)
+{
+	struct timespec ts;
+	bool avail;
 
-		if (setsockopt(ssc[1], IPPROTO_TCP, TCP_NODELAY,
-			       (void *) &on, sizeof(on)) == -1) {
-			LOGW(TAG, "can't setsockopt TCP_NODELAY on server socket");
+	pthread_mutex_lock(&in_mutex);
+	while (rb_empty(&in_rb[i]) && !rb_closed(&in_rb[i]) &&
+	       (cpu_state != ST_STOPPED)) {
+		clock_gettime(CLOCK_REALTIME, &ts);
+		ts.tv_nsec += ((ms > 0) ? ms : 100) * 1000000L;
+		if (ts.tv_nsec >= 1000000000L) {
+			ts.tv_sec++;
+			ts.tv_nsec -= 1000000000L;
 		}
-
-		if (ss_telnet[1])
-			telnet_negotiation(ssc[1]);
+		if ((pthread_cond_timedwait(&in_cond, &in_mutex, &ts)
+		     == ETIMEDOUT) && (ms > 0))
+			break;
 	}
-ss1_done:
-#endif /* !TCPASYNC */
+	avail = !rb_empty(&in_rb[i]);
+	pthread_mutex_unlock(&in_mutex);
 
-	if (ssc[1] != 0) {
-		p[0].fd = ssc[1];
-		p[0].events = POLLIN | POLLOUT;
-		p[0].revents = 0;
-		poll(p, 1, 0);
-		if (p[0].revents & POLLHUP) {
-			close(ssc[1]);
-			ssc[1] = 0;
-			return 0;
-		}
-		if (p[0].revents & POLLIN)
-			status |= 1;
-		if (p[0].revents & POLLOUT)
-			status |= 2;
-	}
-#endif /* NETWORKING */
-	return status;
+	return avail;
 }
 
+#ifdef NETWORKING
 /*
- *	I/O handler for read console 3 status:
+ *	close socket *fd with input ring i
+ */
+static void in_hangup(int i, int *fd)
+{
+	outbuf_discard(&out_buf[i]);
+	pthread_mutex_lock(&in_mutex);
+	close(*fd);
+	*fd = 0;
+	rb_reset(&in_rb[i]);
+	in_skip[i] = false;
+	pthread_mutex_unlock(&in_mutex);
+}
+
+/*
+ *	status of socket *fd with input ring i:
  *	bit 0 = 1: input available
  *	bit 1 = 1: output writable
+ *	The socket is closed when the peer closed the connection
+ *	and all input was read.
  */
-static BYTE cons3_in(void)
+static BYTE sock_status(int i, int *fd)
 {
-	BYTE status = 0;
-#ifdef NETWORKING
-	struct pollfd p[1];
+	BYTE status = 2;	/* writes block until the socket can take it */
 
-#ifndef TCPASYNC
-	socklen_t alen;
-	struct sockaddr_in fsin;
-	int go_away;
-	int on = 1;
-
-	if (ss[2] == 0)
-		return status;
-
-	p[0].fd = ss[2];
-	p[0].events = POLLIN;
-	p[0].revents = 0;
-	poll(p, 1, 0);
-
-	if (p[0].revents) {
+	if (*fd == 0)
+		return 0;
+	out_flush(i, true);
+	if (!rb_empty(&in_rb[i]))
+		status |= 1;
+	else if (rb_closed(&in_rb[i])) {
+		in_hangup(i, fd);
+		status = 0;
+	}
+	return status;
+}
 
-		alen = sizeof(fsin);
+/*
+ *	read a byte from socket *fd with input ring i,
+ *	waits for input like a read() of the socket
+ */
+static BYTE sock_data(int i, int *fd)
+{
+	BYTE c = 0;
 
-		if (ssc[2] != 0) {
-			go_away = accept(ss[2],
-					 (struct sockaddr *) &fsin, &alen);
-			close(go_away);
-			goto ss2_done;
-		}
+	if (*fd == 0)
+		return 0;
+	out_flush(i, true);
+	if (in_wait(i, 0))
+		rb_get(&in_rb[i], &c);
+	else if (rb_closed(&in_rb[i]))
+		in_hangup(i, fd);
+	return c;
+}
+#endif /* NETWORKING */
 
-		if ((ssc[2] = accept(ss[2], (struct sockaddr *) &fsin,
-				     &alen)) == -1) {
-			LOGW(TAG, "can't accept server socket");
-			ssc[2] = 0;
-		}
+/*
+ *	I/O handler for read console 0 status:
+ *	0xff : input available
+ *	0x00 : no input available
+ */
+static BYTE cons_in(void)
+{
+	/* a batch job gets input as soon as it asks for it */
+	if (b_flag)
+		return batch_ready() ? (BYTE) 0xff : (BYTE) 0x00;
 
-		if (setsockopt(ssc[2], IPPROTO_TCP, TCP_NODELAY,
-			       (void *) &on, sizeof(on)) == -1) {
-			LOGW(TAG, "can't setsockopt TCP_NODELAY on server socket");
-		}
+	out_flush(0, true);
 
-		if (ss_telnet[2])
-			telnet_negotiation(ssc[2]);
+	/* if polled in a loop give the host CPU a break until input */
+	if (++busy_loop_cnt >= MAX_BUSY_COUNT) {
+		in_wait(0, 1);
+		busy_loop_cnt = 0;
 	}
-ss2_done:
-#endif /* !TCPASYNC */
 
-	if (ssc[2] != 0) {
-		p[0].fd = ssc[2];
-		p[0].events = POLLIN | POLLOUT;
-		p[0].revents = 0;
-		poll(p, 1, 0);
-		if (p[0].revents & POLLHUP) {
-			close(ssc[2]);
-			ssc[2] = 0;
-			return 0;
-		}
-		if (p[0].revents & POLLIN)
-			status |= 1;
-		if (p[0].revents & POLLOUT)
-			status |= 2;
-	}
-#endif /* NETWORKING */
-	return status;
+	if (!rb_empty(&in_rb[0]) || rb_closed(&in_rb[0]))
+		return (BYTE) 0xff;
+	else
+		return (BYTE) 0x00;
 }
 
 /*
- *	I/O handler for read console 4 status:
- *	bit 0 = 1: input available
- *	bit 1 = 1: output writable
+ *	Console n (1-NUMSOC) is connected to server socket n. The
+ *	fixed ports of consoles 1-4 and the multiplexer ports for
+ *	all consoles use these handlers:
+ *
+ *	status:	bit 0 = 1: input available
+ *		bit 1 = 1: output writable
+ *	data:	read input from / write output to the socket
  */
-static BYTE cons4_in(void)
+static BYTE con_status(int n)
 {
-	BYTE status = 0;
 #ifdef NETWORKING
-	struct pollfd p[1];
+	if ((n >= 1) && (n <= NUMSOC))
+		return sock_status(n, &ssc[n - 1]);
+#else
+	UNUSED(n);
+#endif
+	return 0;
+}
 
-#ifndef TCPASYNC
-	socklen_t alen;
-	struct sockaddr_in fsin;
-	int go_away;
-	int on = 1;
+static BYTE con_read(int n)
+{
+	BYTE c = 0;
 
-	if (ss[3] == 0)
-		return status;
+#ifdef NETWORKING
+	if ((n < 1) || (n > NUMSOC))
+		return c;
+	c = sock_data(n, &ssc[n - 1]);
+#ifdef SNETDEBUG
+	if (sdirection != 1) {
+		printf("\n<- ");
+		sdirection = 1;
+	}
+	printf("%02x ", c);
+#endif
+#else /* !NETWORKING */
+	UNUSED(n);
+#endif
+	return c;
+}
 
-	p[0].fd = ss[3];
-	p[0].events = POLLIN;
-	p[0].revents = 0;
-	poll(p, 1, 0);
+static void con_write(int n, BYTE data)
+{
+#ifdef NETWORKING
+	if ((n < 1) || (n > NUMSOC))
+		return;
+#ifdef SNETDEBUG
+	if (sdirection != 0) {
+		printf("\n-> ");
+		sdirection = 0;
+	}
+	printf("%02x ", (BYTE) data);
+#endif
+	out_put(n, data);
+#else /* !NETWORKING */
+	UNUSED(n);
+	UNUSED(data);
+#endif
+}
 
-	if (p[0].revents) {
+/*
+ *	I/O handlers for the fixed ports of consoles 1-4,
+ *	writing the status port has no function
+ */
+#define CON_PORTS(n)						\
+static BYTE cons##n##_in(void) { return con_status(n); }	\
+static BYTE cond##n##_in(void) { return con_read(n); }		\
+static void cons##n##_out(BYTE data) { UNUSED(data); }		\
+static void cond##n##_out(BYTE data) { con_write(n, data); }
 
-		alen = sizeof(fsin);
+CON_PORTS(1)
+CON_PORTS(2)
+CON_PORTS(3)
+CON_PORTS(4)
 
-		if (ssc[3] != 0) {
-			go_away = accept(ss[3],
-					 (struct sockaddr *) &fsin, &alen);
-			close(go_away);
-			goto ss3_done;
-		}
+/*
+ *	I/O handler for read console multiplexer select:
+ *	return the number of consoles
+ */
+static BYTE consel_in(void)
+{
+#ifdef NETWORKING
+	return (BYTE) NUMSOC;
+#else
+	return (BYTE) 0;
+#endif
+}
 
-		if ((ssc[3] = accept(ss[3], (struct sockaddr *) &fsin,
-				     &alen)) == -1) {
-			LOGW(TAG, "can't accept server socket");
-			ssc[3] = 0;
-		}
+/*
+ *	I/O handler for write console multiplexer select:
+ *	select the console accessed by the multiplexer ports
+ */
+static void consel_out(BYTE data)
+{
+#ifdef NETWORKING
+	con_sel = data;
+#else
+	UNUSED(data);
+#endif
+}
 
-		if (setsockopt(ssc[3], IPPROTO_TCP, TCP_NODELAY,
-			       (void *) &on, sizeof(on)) == -1) {
-			LOGW(TAG, "can't setsockopt TCP_NODELAY on server socket");
-		}
+/*
+ *	I/O handlers for the selected console
+ */
+static BYTE consm_in(void)
+{
+#ifdef NETWORKING
+	return con_status(con_sel);
+#else
+	return (BYTE) 0;
+#endif
+}
 
-		if (ss_telnet[3])
-			telnet_negotiation(ssc[3]);
-	}
-ss3_done:
-#endif /* !TCPASYNC */
+static void consm_out(BYTE data)
+{
+	UNUSED(data);
+}
 
-	if (ssc[3] != 0) {
-		p[0].fd = ssc[3];
-		p[0].events = POLLIN | POLLOUT;
-		p[0].revents = 0;
-		poll(p, 1, 0);
-		if (p[0].revents & POLLHUP) {
-			close(ssc[3]);
-			ssc[3] = 0;
-			return 0;
-		}
-		if (p[0].revents & POLLIN)
-			status |= 1;
-		if (p[0].revents & POLLOUT)
-			status |= 2;
-	}
-#endif /* NETWORKING */
-	return status;
+static BYTE condm_in(void)
+{
+#ifdef NETWORKING
+	return con_read(con_sel);
+#else
+	return (BYTE) 0;
+#endif
+}
+
+static void condm_out(BYTE data)
+{
+#ifdef NETWORKING
+	con_write(con_sel, data);
+#else
+	UNUSED(data);
+#endif
 }
 
 /*
@@ -989,7 +1317,6 @@ static BYTE nets1_in(void)
 #ifdef NETWORKING
 	struct addrinfo hints;
 	struct addrinfo *result, *rp;
-	struct pollfd p[1];
 	int on = 1, s;
 	char service[6];
 
@@ -1031,68 +1358,20 @@ static BYTE nets1_in(void)
 			LOGW(TAG,
 			     "can't setsockopt TCP_NODELAY on client socket");
 		}
-	}
 
-	if (cs != 0) {
-		p[0].fd = cs;
-		p[0].events = POLLIN | POLLOUT;
-		p[0].revents = 0;
-		poll(p, 1, 0);
-		if (p[0].revents & POLLHUP) {
-			close(cs);
-			cs = 0;
-			return (BYTE) 0;
-		}
-		if (p[0].revents & POLLIN)
-			status |= 1;
-		if (p[0].revents & POLLOUT)
-			status |= 2;
+		in_wakeup();
 	}
-#endif /* NETWORKING */
-	return status;
-}
-
-/*
- *	I/O handler for write console 0 status:
- *	no function
- */
-static void cons_out(BYTE data)
-{
-	UNUSED(data);
-}
-
-/*
- *	I/O handler for write console 1 status:
- *	no function
- */
-static void cons1_out(BYTE data)
-{
-	UNUSED(data);
-}
-
-/*
- *	I/O handler for write console 2 status:
- *	no function
- */
-static void cons2_out(BYTE data)
-{
-	UNUSED(data);
-}
-
-/*
- *	I/O handler for write console 3 status:
- *	no function
- */
-static void cons3_out(BYTE data)
-{
-	UNUSED(data);
+
+	status = sock_status(IN_CS, &cs);
+#endif /* NETWORKING */
+	return status;
 }
 
 /*
- *	I/O handler for write console 4 status:
+ *	I/O handler for write console 0 status:
  *	no function
  */
-static void cons4_out(BYTE data)
+static void cons_out(BYTE data)
 {
 	UNUSED(data);
 }
@@ -1111,160 +1390,20 @@ static void nets1_out(BYTE data)
  */
 static BYTE cond_in(void)
 {
-	char c;
-
-	busy_loop_cnt = 0;
-	if (read(fileno(stdin), &c, 1) != 1)
-		LOGE(TAG, "can't read console 0");
-	return (BYTE) c;
-}
-
-/*
- *	I/O handler for read console 1 data
- */
-static BYTE cond1_in(void)
-{
-	char c;
-#ifdef NETWORKING
-	char x;
-
-	if (read(ssc[0], &c, 1) != 1) {
-		if ((errno == EAGAIN) || (errno == EINTR)) {
-			close(ssc[0]);
-			ssc[0] = 0;
-			return (BYTE) 0;
-		} else {
-			LOGE(TAG, "can't read console 1");
-			cpu_error = IOERROR;
-			cpu_state = ST_STOPPED;
-			return (BYTE) 0;
-		}
-	}
-	if (ss_telnet[0] && (c == '\r'))
-		if (read(ssc[0], &x, 1) != 1)
-			LOGE(TAG, "can't read console 1");
-#ifdef SNETDEBUG
-	if (sdirection != 1) {
-		printf("\n<- ");
-		sdirection = 1;
-	}
-	printf("%02x ", (BYTE) c);
-#endif
-#else /* !NETWORKING */
-	c = 0;
-#endif
-	return (BYTE) c;
-}
-
-/*
- *	I/O handler for read console 2 data
- */
-static BYTE cond2_in(void)
-{
-	char c;
-#ifdef NETWORKING
-	char x;
-
-	if (read(ssc[1], &c, 1) != 1) {
-		if ((errno == EAGAIN) || (errno == EINTR)) {
-			close(ssc[1]);
-			ssc[1] = 0;
-			return (BYTE) 0;
-		} else {
-			LOGE(TAG, "can't read console 2");
-			cpu_error = IOERROR;
-			cpu_state = ST_STOPPED;
-			return (BYTE) 0;
-		}
-	}
-	if (ss_telnet[1] && (c == '\r'))
-		if (read(ssc[1], &x, 1) != 1)
-			LOGE(TAG, "can't read console 2");
-#ifdef SNETDEBUG
-	if (sdirection != 1) {
-		printf("\n<- ");
-		sdirection = 1;
-	}
-	printf("%02x ", (BYTE) c);
-#endif
-#else /* !NETWORKING */
-	c = 0;
-#endif
-	return (BYTE) c;
-}
-
-/*
- *	I/O handler for read console 3 data
- */
-static BYTE cond3_in(void)
-{
-	char c;
-#ifdef NETWORKING
-	char x;
+	BYTE c = 0;
+	int i;
 
-	if (read(ssc[2], &c, 1) != 1) {
-		if ((errno == EAGAIN) || (errno == EINTR)) {
-			close(ssc[2]);
-			ssc[2] = 0;
-			return (BYTE) 0;
-		} else {
-			LOGE(TAG, "can't read console 3");
-			cpu_error = IOERROR;
-			cpu_state = ST_STOPPED;
-			return (BYTE) 0;
-		}
+	if (b_flag) {
+		out_flush(0, true);
+		i = batch_get();
+		return (i < 0) ? 0 : (BYTE) i;
 	}
-	if (ss_telnet[2] && (c == '\r'))
-		if (read(ssc[2], &x, 1) != 1)
-			LOGE(TAG, "can't read console 3");
-#ifdef SNETDEBUG
-	if (sdirection != 1) {
-		printf("\n<- ");
-		sdirection = 1;
-	}
-	printf("%02x ", (BYTE) c);
-#endif
-#else /* !NETWORKING */
-	c = 0;
-#endif
-	return (BYTE) c;
-}
-
-/*
- *	I/O handler for read console 4 data
- */
-static BYTE cond4_in(void)
-{
-	char c;
-#ifdef NETWORKING
-	char x;
 
-	if (read(ssc[3], &c, 1) != 1) {
-		if ((errno == EAGAIN) || (errno == EINTR)) {
-			close(ssc[3]);
-			ssc[3] = 0;
-			return (BYTE) 0;
-		} else {
-			LOGE(TAG, "can't read console 4");
-			cpu_error = IOERROR;
-			cpu_state = ST_STOPPED;
-			return (BYTE) 0;
-		}
-	}
-	if (ss_telnet[3] && (c == '\r'))
-		if (read(ssc[3], &x, 1) != 1)
-			LOGE(TAG, "can't read console 4");
-#ifdef SNETDEBUG
-	if (sdirection != 1) {
-		printf("\n<- ");
-		sdirection = 1;
-	}
-	printf("%02x ", (BYTE) c);
-#endif
-#else /* !NETWORKING */
-	c = 0;
-#endif
-	return (BYTE) c;
+	busy_loop_cnt = 0;
+	out_flush(0, true);
+	if (!in_wait(0, 0) || !rb_get(&in_rb[0], &c))
+		LOGE(TAG, "can't read console 0");
+	return c;
 }
 
 /*
@@ -1272,26 +1411,26 @@ static BYTE cond4_in(void)
  */
 static BYTE netd1_in(void)
 {
-	char c;
+	BYTE c = 0;
 
 #ifdef NETWORKING
-	if (read(cs, &c, 1) != 1) {
+	out_flush(IN_CS, true);
+	if ((cs == 0) || !in_wait(IN_CS, 0)) {
 		LOGE(TAG, "can't read client socket");
 		cpu_error = IOERROR;
 		cpu_state = ST_STOPPED;
 		return (BYTE) 0;
 	}
+	rb_get(&in_rb[IN_CS], &c);
 #ifdef CNETDEBUG
 	if (cdirection != 1) {
 		printf("\n<- ");
 		cdirection = 1;
 	}
-	printf("%02x ", (BYTE) c);
-#endif
-#else /* !NETWORKING */
-	c = 0;
+	printf("%02x ", c);
 #endif
-	return (BYTE) c;
+#endif /* NETWORKING */
+	return c;
 }
 
 /*
@@ -1300,132 +1439,9 @@ static BYTE netd1_in(void)
  */
 static void cond_out(BYTE data)
 {
-again:
-	if (write(fileno(stdout), (char *) &data, 1) != 1) {
-		if (errno == EINTR) {
-			goto again;
-		} else {
-			LOGE(TAG, "can't write console 0");
-			cpu_error = IOERROR;
-			cpu_state = ST_STOPPED;
-		}
-	}
-}
-
-/*
- *	I/O handler for write console 1 data:
- *	the output is written to the socket
- */
-static void cond1_out(BYTE data)
-{
-#ifdef NETWORKING
-#ifdef SNETDEBUG
-	if (sdirection != 0) {
-		printf("\n-> ");
-		sdirection = 0;
-	}
-	printf("%02x ", (BYTE) data);
-#endif
-again:
-	if (write(ssc[0], (char *) &data, 1) != 1) {
-		if (errno == EINTR) {
-			goto again;
-		} else {
-			LOGE(TAG, "can't write console 1");
-			cpu_error = IOERROR;
-			cpu_state = ST_STOPPED;
-		}
-	}
-#else /* !NETWORKING */
-	UNUSED(data);
-#endif
-}
-
-/*
- *	I/O handler for write console 2 data:
- *	the output is written to the socket
- */
-static void cond2_out(BYTE data)
-{
-#ifdef NETWORKING
-#ifdef SNETDEBUG
-	if (sdirection != 0) {
-		printf("\n-> ");
-		sdirection = 0;
-	}
-	printf("%02x ", (BYTE) data);
-#endif
-again:
-	if (write(ssc[1], (char *) &data, 1) != 1) {
-		if (errno == EINTR) {
-			goto again;
-		} else {
-			LOGE(TAG, "can't write console 2");
-			cpu_error = IOERROR;
-			cpu_state = ST_STOPPED;
-		}
-	}
-#else /* !NETWORKING */
-	UNUSED(data);
-#endif
-}
-
-/*
- *	I/O handler for write console 3 data:
- *	the output is written to the socket
- */
-static void cond3_out(BYTE data)
-{
-#ifdef NETWORKING
-#ifdef SNETDEBUG
-	if (sdirection != 0) {
-		printf("\n-> ");
-		sdirection = 0;
-	}
-	printf("%02x ", (BYTE) data);
-#endif
-again:
-	if (write(ssc[2], (char *) &data, 1) != 1) {
-		if (errno == EINTR) {
-			goto again;
-		} else {
-			LOGE(TAG, "can't write console 3");
-			cpu_error = IOERROR;
-			cpu_state = ST_STOPPED;
-		}
-	}
-#else /* !NETWORKING */
-	UNUSED(data);
-#endif
-}
-
-/*
- *	I/O handler for write console 4 data:
- *	the output is written to the socket
- */
-static void cond4_out(BYTE data)
-{
-#ifdef NETWORKING
-#ifdef SNETDEBUG
-	if (sdirection != 0) {
-		printf("\n-> ");
-		sdirection = 0;
-	}
-	printf("%02x ", (BYTE) data);
-#endif
-again:
-	if (write(ssc[3], (char *) &data, 1) != 1) {
-		if (errno == EINTR) {
-			goto again;
-		} else {
-			LOGE(TAG, "can't write console 4");
-			cpu_error = IOERROR;
-			cpu_state = ST_STOPPED;
-		}
-	}
-#else /* !NETWORKING */
-	UNUSED(data);
-#endif
+	out_put(0, data);
+	if (b_flag)
+		batch_put(data);
 }
 
 /*
@@ -1442,16 +1458,7 @@ static void netd1_out(BYTE data)
 	}
 	printf("%02x ", (BYTE) data);
 #endif
-again:
-	if (write(cs, (char *) &data, 1) != 1) {
-		if (errno == EINTR) {
-			goto again;
-		} else {
-			LOGE(TAG, "can't write client socket");
-			cpu_error = IOERROR;
-			cpu_state = ST_STOPPED;
-		}
-	}
+	out_put(IN_CS, data);
 #else /* !NETWORKING */
 	UNUSED(data);
 #endif
@@ -1500,18 +1507,8 @@ static void prtd_out(BYTE data)
 		}
 	}
 
-	if (data != '\r') {
-again:
-		if (write(printer, (char *) &data, 1) != 1) {
-			if (errno == EINTR) {
-				goto again;
-			} else {
-				LOGE(TAG, "can't write to printer.txt");
-				cpu_error = IOERROR;
-				cpu_state = ST_STOPPED;
-			}
-		}
-	}
+	if (data != '\r')
+		out_put(OUT_PRT, data);
 }
 
 /*
@@ -1596,8 +1593,7 @@ static void auxd_out(BYTE data)
 		return;
 
 	if (data != '\r')
-		if (write(auxout, (char *) &data, 1) != 1)
-			LOGE(TAG, "can't write to auxout pipe");
+		out_put(OUT_AUX, data);
 #else
 	if (data == 0)
 		return;
@@ -1612,14 +1608,14 @@ static void auxd_out(BYTE data)
 	}
 
 	if (data == 0x1a) {
+		out_flush(OUT_AUX, true);
 		close(aux_out);
 		aux_out = 0;
 		return;
 	}
 
 	if (data != '\r')
-		if (write(aux_out, (char *) &data, 1) != 1)
-			LOGE(TAG, "can't write to auxiliaryout.txt");
+		out_put(OUT_AUX, data);
 #endif
 }
 
@@ -1721,11 +1717,11 @@ static BYTE fdco_in(void)
  */
 static void fdco_out(BYTE data)
 {
-	register int i;
-	off_t pos;
-	static char buf[128];
+	off_t pos, trkpos;
+	uint64_t t0;
+	static BYTE buf[128];
 
-	if (disks[drive].fd == NULL) {
+	if (disks[drive].fd == NULL && disks[drive].hd == NULL) {
 		status = 1;
 		return;
 	}
@@ -1737,33 +1733,48 @@ static void fdco_out(BYTE data)
 		status = 3;
 		return;
 	}
-	pos = (((off_t) track) * ((off_t) disks[drive].sectors) + sector - 1) << 7;
-	if (lseek(*disks[drive].fd, pos, SEEK_SET) == -1L) {
-		status = 4;
+	if (data > 1) {		/* invalid command */
+		status = 7;
 		return;
 	}
-	switch (data) {
-	case 0:	/* read */
-		if (read(*disks[drive].fd, buf, 128) != 128)
+	t0 = diskstats_start();
+	trkpos = (((off_t) track) * ((off_t) disks[drive].sectors)) << 7;
+	pos = trkpos + ((sector - 1) << 7);
+	if (disks[drive].hd != NULL) {
+		if (data == 0) {	/* read */
+			if (!hostdisk_read(disks[drive].hd, track, sector, buf))
+				status = 5;
+			else {
+				dma_write_block((dmadh << 8) + dmadl, buf, 128);
+				status = 0;
+			}
+		} else {		/* write */
+			dma_read_block((dmadh << 8) + dmadl, buf, 128);
+			if (!hostdisk_write(disks[drive].hd, track, sector, buf))
+				status = 6;
+			else
+				status = 0;
+		}
+	} else if (data == 0) {		/* read */
+		/* the cache checks itself if the image was changed */
+		if (!trackcache_read(&tcache[drive], *disks[drive].fd, NULL,
+				     trkpos, disks[drive].sectors << 7,
+				     pos, buf, 128))
 			status = 5;
 		else {
-			for (i = 0; i < 128; i++)
-				dma_write((dmadh << 8) + dmadl + i, buf[i]);
+			dma_write_block((dmadh << 8) + dmadl, buf, 128);
 			status = 0;
 		}
-		break;
-	case 1:	/* write */
-		for (i = 0; i < 128; i++)
-			buf[i] = dma_read((dmadh << 8) + dmadl + i);
-		if (write(*disks[drive].fd, buf, 128) != 128)
+	} else {			/* write */
+		dma_read_block((dmadh << 8) + dmadl, buf, 128);
+		trackcache_inval(&tcache[drive], pos, 128);
+		if (pwrite(*disks[drive].fd, buf, 128, pos) != 128)
 			status = 6;
 		else
 			status = 0;
-		break;
-	default:		/* invalid command */
-		status = 7;
-		break;
 	}
+	diskstats_io(&dstat[drive], data == 1, track, pos, 128, t0,
+		     status == 0);
 }
 
 /*
@@ -1937,30 +1948,11 @@ static void mmup_out(BYTE data)
  */
 static void time_out(BYTE data)
 {
-	static struct itimerval tim;
-	static struct sigaction newact;
-
-	if (data == 1) {
-		timer = 1;
-		newact.sa_handler = int_timer;
-		sigemptyset(&newact.sa_mask);
-		newact.sa_flags = 0;
-		sigaction(SIGALRM, &newact, NULL);
-		tim.it_value.tv_sec = 0;
-		tim.it_value.tv_usec = 10000;
-		tim.it_interval.tv_sec = 0;
-		tim.it_interval.tv_usec = 10000;
-		setitimer(ITIMER_REAL, &tim, NULL);
-	} else {
-		timer = 0;
-		newact.sa_handler = SIG_IGN;
-		sigemptyset(&newact.sa_mask);
-		newact.sa_flags = 0;
-		sigaction(SIGALRM, &newact, NULL);
-		tim.it_value.tv_sec = 0;
-		tim.it_value.tv_usec = 0;
-		setitimer(ITIMER_REAL, &tim, NULL);
-	}
+	__atomic_store_n(&timer, (data == 1) ? 1 : 0, __ATOMIC_RELEASE);
+
+	/* the I/O thread runs the timer */
+	if (in_wake[1] != -1)
+		in_wakeup();
 }
 
 /*
@@ -1979,7 +1971,9 @@ static BYTE time_in(void)
  */
 static void delay_out(BYTE data)
 {
-	sleep_for_ms(data * 10);
+	/* batch jobs don't wait */
+	if (!b_flag)
+		sleep_for_ms(data * 10);
 
 #ifdef CNETDEBUG
 	printf(". ");
@@ -2003,7 +1997,8 @@ static BYTE delay_in(void)
  *	bit 4 = 1	switch CPU model to 8080
  *	bit 5 = 1	switch CPU model to Z80
  *	bit 6 = 1	reset CPU, MMU and reboot
- *	bit 7 = 1	halt emulation via I/O
+ *	bit 7 = 1	halt emulation via I/O, in batch mode
+ *			bits 0-3 are the exit status of the job
  */
 static void hwctl_out(BYTE data)
 {
@@ -2022,6 +2017,8 @@ static void hwctl_out(BYTE data)
 	hwctl_lock = 0xff;
 
 	if (data & 128) {	/* halt system */
+		if (b_flag)
+			batch_exit(data & 15);
 		cpu_error = IOHALT;
 		cpu_state = ST_STOPPED;
 		return;
@@ -2076,6 +2073,9 @@ static BYTE speedl_in(void)
 static void speedh_out(BYTE data)
 {
 	speed += data << 8;
+	/* batch jobs always run unlimited */
+	if (b_flag)
+		return;
 	f_value = speed;
 	if (f_value)
 		tmax = speed * 10000;
@@ -2091,111 +2091,113 @@ static BYTE speedh_in(void)
 	return f_value >> 8;
 }
 
+#ifdef NETWORKING
 /*
- *	timer interrupt causes maskable CPU interrupt
- */
-static void int_timer(int sig)
-{
-	UNUSED(sig);
-
-	int_int = true;
-	int_data = 0xff;	/* RST 38H for IM 0, 0FFH for IM 2 */
-}
-
-#if defined(NETWORKING) && defined(TCPASYNC)
-/*
- *	SIGIO interrupt handler
+ *	accept a connection on server socket n, there can be only one
+ *	connection per socket, others are closed right away
  */
-static void int_io(int sig)
+static void accept_server_socket(int n)
 {
-	register int i;
+	static BYTE will_echo[3] = {255, 251, 1};
+	static BYTE char_mode[3] = {255, 251, 3};
 	struct sockaddr_in fsin;
-	socklen_t alen;
-	struct pollfd p[NUMSOC];
-	int go_away;
-	int on = 1;
+	socklen_t alen = sizeof(fsin);
+	int fd, on = 1;
 
-	UNUSED(sig);
-
-	for (i = 0; i < NUMSOC; i++) {
-		p[i].fd = ss[i];
-		p[i].events = POLLIN;
-		p[i].revents = 0;
+	if ((fd = accept(ss[n], (struct sockaddr *) &fsin, &alen)) == -1) {
+		LOGW(TAG, "can't accept on server socket");
+		return;
 	}
 
-	poll(p, NUMSOC, 0);
-
-	for (i = 0; i < NUMSOC; i++) {
-		if ((ss[i] != 0) && (p[i].revents)) {
-			alen = sizeof(fsin);
-
-			if (ssc[i] != 0) {
-				go_away = accept(ss[i],
-						 (struct sockaddr *) &fsin,
-						 &alen);
-				close(go_away);
-				return;
-			}
+	if (ssc[n] != 0) {
+		close(fd);
+		return;
+	}
 
-			if ((ssc[i] = accept(ss[i], (struct sockaddr *) &fsin,
-					     &alen)) == -1) {
-				LOGW(TAG, "can't accept on server socket");
-				ssc[i] = 0;
-			}
+	if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY,
+		       (void *) &on, sizeof(on)) == -1) {
+		LOGW(TAG, "can't setsockopt TCP_NODELAY on server socket");
+	}
 
-			if (setsockopt(ssc[i], IPPROTO_TCP, TCP_NODELAY,
-				       (void *) &on, sizeof(on)) == -1) {
-				LOGW(TAG, "can't setsockopt TCP_NODELAY on server socket");
-			}
+	/* send the telnet options we need, the replies and other
+	   options offered are handled by the input thread */
+	if (ss_telnet[n]) {
+		if (write(fd, &char_mode, 3) != 3)
+			LOGE(TAG, "can't send char_mode telnet option");
+		if (write(fd, &will_echo, 3) != 3)
+			LOGE(TAG, "can't send will_echo telnet option");
+		tn_state[n] = TN_DATA;
+		tn_until[n] = get_clock_us() + TELNET_TIMEOUT * 1000ULL;
+	} else
+		tn_until[n] = 0;
 
-			if (ss_telnet[i])
-				telnet_negotiation(ssc[i]);
-		}
-	}
+	/* hand the connection over to the input thread */
+	ssc[n] = fd;
+	in_wakeup();
 }
-#endif /* NETWORKING && TCPASYNC */
 
-#ifdef NETWORKING
 /*
- *	do the telnet option negotiation
+ *	telnet option negotiation, called by the input thread for
+ *	byte c received on server socket n until no more options
+ *	arrived for TELNET_TIMEOUT milliseconds. Options offered
+ *	are rejected, returns true if c is data for the console.
  */
-void telnet_negotiation(int fd)
+static bool telnet_filter(int n, BYTE c)
 {
-	static unsigned char will_echo[3] = {255, 251, 1};
-	static unsigned char char_mode[3] = {255, 251, 3};
-	struct pollfd p[1];
-	BYTE c[3];
+	BYTE opt[3];
 
-	/* send the telnet options we need */
-	if (write(fd, &char_mode, 3) != 3)
-		LOGE(TAG, "can't send char_mode telnet option");
-	if (write(fd, &will_echo, 3) != 3)
-		LOGE(TAG, "can't send will_echo telnet option");
+	switch (tn_state[n]) {
+	case TN_IAC:
+		if (c == 255) {		/* quoted 255 is data */
+			tn_state[n] = TN_DATA;
+			return true;
+		}
+		if (c >= 251) {		/* WILL, WONT, DO, DONT */
+			tn_cmd[n] = c;
+			tn_state[n] = TN_OPT;
+		} else if (c == 250)	/* SB */
+			tn_state[n] = TN_SB;
+		else
+			tn_state[n] = TN_DATA;
+		return false;
+
+	case TN_OPT:
+		tn_state[n] = TN_DATA;
+		tn_until[n] = get_clock_us() + TELNET_TIMEOUT * 1000ULL;
+		LOGD(TAG, "telnet: %d %d %d", 255, tn_cmd[n], c);
+		if (c == 1 || c == 3)
+			return false;	/* ignore answers to our requests */
+		opt[0] = 255;		/* and reject other options */
+		if (tn_cmd[n] == 251)
+			opt[1] = 254;
+		else if (tn_cmd[n] == 253)
+			opt[1] = 252;
+		else
+			return false;
+		opt[2] = c;
+		if (send(ssc[n], opt, 3, MSG_DONTWAIT) != 3)
+			LOGE(TAG, "can't write telnet option");
+		return false;
 
-	/* and reject all others offered */
-	p[0].fd = fd;
-	p[0].events = POLLIN;
-	while (true) {
-		/* wait for input */
-		p[0].revents = 0;
-		poll(p, 1, TELNET_TIMEOUT);
+	case TN_SB:			/* skip subnegotiation up to IAC SE */
+		if (c == 255)
+			tn_state[n] = TN_SB_IAC;
+		return false;
 
-		/* done if no more input */
-		if (! p[0].revents)
-			break;
+	case TN_SB_IAC:
+		tn_state[n] = (c == 240) ? TN_DATA : TN_SB;
+		return false;
 
-		/* else read the option */
-		if (read(fd, &c, 3) != 3)
-			LOGE(TAG, "can't read telnet option");
-		LOGD(TAG, "telnet: %d %d %d", c[0], c[1], c[2]);
-		if (c[2] == 1 || c[2] == 3)
-			continue;	/* ignore answers to our requests */
-		if (c[1] == 251)	/* and reject other options */
-			c[1] = 254;
-		else if (c[1] == 253)
-			c[1] = 252;
-		if (write(fd, &c, 3) != 3)
-			LOGE(TAG, "can't write telnet option");
+	default:
+		if (get_clock_us() >= tn_until[n]) {
+			tn_until[n] = 0;	/* negotiation done */
+			return true;
+		}
+		if (c == 255) {
+			tn_state[n] = TN_IAC;
+			return false;
+		}
+		return true;
 	}
 }
 #endif /* NETWORKING */
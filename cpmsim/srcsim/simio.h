@@ -10,6 +10,8 @@
 #include "sim.h"
 #include "simdefs.h"
 
+#include "hostdisk.h"
+
 #define IO_DATA_UNUSED	0xff	/* data returned on unused ports */
 
 /*
@@ -20,6 +22,7 @@ typedef struct dskdef {
 	int *fd;			/* file descriptor */
 	unsigned int tracks;		/* number of tracks */
 	unsigned int sectors;		/* number of sectors */
+	hostdisk_t *hd;			/* host directory used as disk */
 } dskdef_t;
 
 extern dskdef_t disks[16];
@@ -29,5 +32,7 @@ extern out_func_t *const port_out[256];
 
 extern void init_io(void);
 extern void exit_io(void);
+extern void flush_io(void);
+extern void hold_io(bool hold);
 
 #endif /* !SIMIO_INC */
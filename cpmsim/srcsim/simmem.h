@@ -29,11 +29,14 @@
  * 09-APR-2018 modified MMU write protect port as used by Alan Cox for FUZIX
  * 04-NOV-2019 add functions for direct memory access
  * 14-DEC-2024 added hardware breakpoint support
+ * 18-OCT-2026 add block functions for direct memory access
  */
 
 #ifndef SIMMEM_INC
 #define SIMMEM_INC
 
+#include <string.h>
+
 #include "sim.h"
 #include "simdefs.h"
 #ifdef WANT_ICE
@@ -149,6 +152,57 @@ static inline BYTE dma_read(WORD addr)
 		return *(memory[selbnk] + addr);
 }
 
+/*
+ * block memory access for DMA devices, the transfer is split at the
+ * bank boundary and each part is copied with memcpy()
+ */
+static inline void dma_write_block(WORD addr, const BYTE *buf, int len)
+{
+	register int n;
+
+	while (len > 0) {
+		if (addr < segsize) {
+			n = segsize - addr;
+			if (n > len)
+				n = len;
+			memcpy(memory[selbnk] + addr, buf, n);
+		} else {
+			n = 65536 - addr;
+			if (n > len)
+				n = len;
+			if (wp_common != 0)
+				wp_common |= 0x80;
+			else
+				memcpy(memory[0] + addr, buf, n);
+		}
+		addr += n;
+		buf += n;
+		len -= n;
+	}
+}
+
+static inline void dma_read_block(WORD addr, BYTE *buf, int len)
+{
+	register int n;
+
+	while (len > 0) {
+		if (addr < segsize) {
+			n = segsize - addr;
+			if (n > len)
+				n = len;
+			memcpy(buf, memory[selbnk] + addr, n);
+		} else {
+			n = 65536 - addr;
+			if (n > len)
+				n = len;
+			memcpy(buf, memory[0] + addr, n);
+		}
+		addr += n;
+		buf += n;
+		len -= n;
+	}
+}
+
 /*
  * direct memory access for simulation frame, video logic, etc.
  */
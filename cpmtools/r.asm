@@ -6,6 +6,8 @@
 ;
 ;	Rev	 Date	  Desc
 ;	1.0	10/2/19   Mike Douglas, Original
+;	1.1	10/18/26  Read many records per host request into a buffer
+;			  up to the BDOS
 ;
 ;*****************************************************************************
 
@@ -20,6 +22,7 @@ READF	equ	20		;BDOS read file
 WRITEF	equ	21		;BDOS write file
 MAKEF	equ	22		;BDOS make file
 SETDMA	equ	26		;BDOS set DMA address
+READM	equ	200		;host read multiple records
 
 ; CP/M default File Control Block (FCB)
 
@@ -39,6 +42,7 @@ LF	equ	10		;ascii for line feed
 ;-----------------------------------------------------------------------------
 ; Main program
 ;-----------------------------------------------------------------------------
+	lxi	sp,stack	;buffer overwrites the CCP, use own stack
 	call	vfyFcb		;verify the FCB from command line
 
 	lxi	d,mFile		;display file name
@@ -145,25 +149,70 @@ opnFile	lxi	d,DEFDMA	;use the CP/M default buffer
 	lxi	d,mNoFile	;DE->file not found message
 	inr	a		;test for FFh error
 	jz	exitM1F		;file not found, close one file & exit
-	
+
+; Compute the number of records which fit between buffer and BDOS
+
+	lhld	BDOS+1		;HL=BDOS entry address
+	lxi	d,buffer	;HL=HL-buffer
+	mov	a,l
+	sub	e
+	mov	l,a
+	mov	a,h
+	sbb	d
+	mov	h,a
+	dad	h		;HL=HL/128
+	mov	l,h
+	mvi	a,0
+	aci	0
+	mov	h,a
+	shld	bufRecs
 	ret
 	
 ;-----------------------------------------------------------------------------	
-; cpyFile - Copy the input file from the PC to the output file in CP/M
+; cpyFile - Copy the input file from the PC to the output file in CP/M.
+;    The buffer is filled with one host request, then the records are
+;    written to the CP/M file one by one.
 ;-----------------------------------------------------------------------------
-cpyFile	lxi	d,inFcb		;DE->input file FCB
-	mvi	c,READF		;C=read file sequential
+cpyFile	lxi	d,buffer	;set host buffer address
+	mvi	c,SETDMA
+	call	pcBdos
+
+	lhld	bufRecs		;DE=number of records to read
+	xchg
+	mvi	c,READM		;C=read multiple records
 	call	pcBdos
 	ora	a		;end of file?
 	rnz			;yes, file copy is done
 
+	shld	count		;HL=number of records read
+	lxi	h,buffer	;start at begin of buffer
+	shld	dmaPtr
+
+wrtRec	lhld	dmaPtr		;set CP/M buffer address
+	xchg
+	mvi	c,SETDMA
+	call	BDOS
+
 	lxi	d,FCB		;DE->output file FCB
 	mvi	c,WRITEF	;C=write file sequential
 	call	BDOS
 	ora	a		;test for write error
-	jz	cpyFile		;no error, do next record
-
-	lxi	d,mWrtErr	;DE->write error message
+	jnz	wrtErr		;write error
+
+	lhld	dmaPtr		;bump buffer pointer
+	lxi	d,128
+	dad	d
+	shld	dmaPtr
+
+	lhld	count		;decrement record count
+	dcx	h
+	shld	count
+	mov	a,h
+	ora	l
+	jnz	wrtRec		;write next record
+	jmp	cpyFile		;buffer done, read next chunk
+
+wrtErr	lxi	d,mWrtErr	;DE->write error message
 	jmp	exitM2F		;display error, close two files & exit
 
 ;-----------------------------------------------------------------------------
@@ -225,7 +274,7 @@ wildErr	lxi	d,mNoWild	;DE->no wildcard message
 ;  String Constants
 ;-----------------------------------------------------------------------------
 mHelp	db	CR,LF
- 	db	'R.COM v1.0 - Read file from host PC into CP/M',CR,LF
+ 	db	'R.COM v1.1 - Read file from host PC into CP/M',CR,LF
 	db	LF
  	db	'Usage: R <filename>',CR,LF,'$'
 
@@ -244,5 +293,14 @@ mDone	db	' read from host, written to CP/M',CR,LF,'$'
 ;-----------------------------------------------------------------------------
 inFcb	dw	0,0,0,0,0,0,0,0,0	;36 byte FCB
 	dw	0,0,0,0,0,0,0,0,0
-	
+
+bufRecs	dw	0		;number of records in buffer
+count	dw	0		;records left to write
+dmaPtr	dw	0		;current record in buffer
+
+	ds	64		;local stack
+stack	equ	$
+
+buffer	equ	$		;file buffer up to the BDOS
+
 	end
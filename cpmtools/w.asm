@@ -6,6 +6,8 @@
 ;
 ;	Rev	 Date	  Desc
 ;	1.0	10/2/19   Mike Douglas, Original
+;	1.1	10/18/26  Buffer records up to the BDOS and write them with
+;			  one host request
 ;
 ;*****************************************************************************
 
@@ -20,6 +22,7 @@ READF	equ	20		;BDOS read file
 WRITEF	equ	21		;BDOS write file
 MAKEF	equ	22		;BDOS make file
 SETDMA	equ	26		;BDOS set DMA address
+WRITEM	equ	201		;host write multiple records
 
 ; CP/M default File Control Block (FCB)
 
@@ -39,6 +42,7 @@ LF	equ	10		;ASCII for line feed
 ;-----------------------------------------------------------------------------
 ; Main program
 ;-----------------------------------------------------------------------------
+	lxi	sp,stack	;buffer overwrites the CCP, use own stack
 	call	vfyFcb		;verify the FCB from command line
 	
 	lxi	d,mFile		;display file name
@@ -134,23 +138,85 @@ opnFile	lxi	d,DEFDMA	;use the CP/M default buffer
 	lxi	d,mMakErr	;DE->can't create file message
 	inr	a		;test for FF (make file fail)
 	jz	exitM1F		;create failed, close one file & exit
-	
+
+; Compute the number of records which fit between buffer and BDOS
+
+	lhld	BDOS+1		;HL=BDOS entry address
+	lxi	d,buffer	;HL=HL-buffer
+	mov	a,l
+	sub	e
+	mov	l,a
+	mov	a,h
+	sbb	d
+	mov	h,a
+	dad	h		;HL=HL/128
+	mov	l,h
+	mvi	a,0
+	aci	0
+	mov	h,a
+	shld	bufRecs
 	ret
 	
 ;-----------------------------------------------------------------------------	
-; cpyFile - Copy the input file from CP/M to the output file on the PC
+; cpyFile - Copy the input file from CP/M to the output file on the PC.
+;    The records are read from the CP/M file one by one into the buffer,
+;    a full buffer is written with one host request.
 ;-----------------------------------------------------------------------------
-cpyFile	lxi	d,FCB		;DE->input file FCB
+cpyFile	lxi	h,buffer	;start at begin of buffer
+	shld	dmaPtr
+	lxi	h,0		;buffer is empty
+	shld	count
+
+rdRec	lhld	dmaPtr		;set CP/M buffer address
+	xchg
+	mvi	c,SETDMA
+	call	BDOS
+
+	lxi	d,FCB		;DE->input file FCB
 	mvi	c,READF		;C=read file sequential
 	call	BDOS
 	ora	a		;end of file?
-	rnz			;yes, file copy is done
+	jnz	flush		;yes, write what's left and done
+
+	lhld	dmaPtr		;bump buffer pointer
+	lxi	d,128
+	dad	d
+	shld	dmaPtr
+
+	lhld	count		;increment record count
+	inx	h
+	shld	count
+
+	xchg			;buffer full?
+	lhld	bufRecs
+	mov	a,l
+	cmp	e
+	jnz	rdRec		;no, read next record
+	mov	a,h
+	cmp	d
+	jnz	rdRec
+
+	call	flush		;write the full buffer
+	jmp	cpyFile		;and continue
 
-	lxi	d,outFcb	;DE->output file FCB
-	mvi	c,WRITEF	;C=write file sequential
+;-----------------------------------------------------------------------------
+; flush - Write the records in the buffer to the output file on the PC
+;-----------------------------------------------------------------------------
+flush	lhld	count		;anything in the buffer?
+	mov	a,h
+	ora	l
+	rz			;no, done
+
+	lxi	d,buffer	;set host buffer address
+	mvi	c,SETDMA
+	call	pcBdos
+
+	lhld	count		;DE=number of records to write
+	xchg
+	mvi	c,WRITEM	;C=write multiple records
 	call	pcBdos		;write destination file
 	ora	a		;test for write error
-	jz	cpyFile		;no error, do next record
+	rz			;no error
 
 	lxi	d,mWrtErr	;DE->write error message
 	jmp	exitM2F		;display error, close two files & exit
@@ -214,7 +280,7 @@ wildErr	lxi	d,mNoWild	;DE->no wildcard message
 ;  String Constants
 ;-----------------------------------------------------------------------------
 mHelp	db	CR,LF
- 	db	'W.COM v1.0 - Write file to host PC from CP/M',CR,LF
+ 	db	'W.COM v1.1 - Write file to host PC from CP/M',CR,LF
 	db	LF
  	db	'Usage: W <filename>',CR,LF,'$'
 
@@ -233,5 +299,14 @@ mDone	db	' written to host PC',CR,LF,'$'
 ;-----------------------------------------------------------------------------
 outFcb	dw	0,0,0,0,0,0,0,0,0	;36 byte FCB
 	dw	0,0,0,0,0,0,0,0,0
-	
+
+bufRecs	dw	0		;number of records in buffer
+count	dw	0		;records in buffer
+dmaPtr	dw	0		;current record in buffer
+
+	ds	64		;local stack
+stack	equ	$
+
+buffer	equ	$		;file buffer up to the BDOS
+
 	end
@@ -54,6 +54,7 @@
 #endif
 
 #define HAS_DAZZLER	/* has simulated I/O for Cromemco Dazzler */
+#define HAS_VIDCAP	/* headless video capture (option -V) */
 #define HAS_DISKS	/* uses disk images */
 #define HAS_CONFIG	/* has configuration files somewhere */
 #define HAS_BANKED_ROM	/* has banked RDOS ROM */
@@ -68,7 +69,6 @@
 #define DOCUMENT_ROOT "../webfrontend/www/" MACHINE
 
 #define NUMNSOC 2	/* number of TCP/IP sockets, 2 per TU-ART */
-#define TCPASYNC	/* use async I/O if possible */
 #define SERVERPORT 4010	/* first TCP/IP server port used */
 #define NUMUSOC 0	/* number of UNIX sockets */
 
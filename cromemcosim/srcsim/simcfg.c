@@ -16,6 +16,7 @@
  * 17-JUN-2021 allow building machine without frontpanel
  * 29-JUL-2021 add boot config for machine without frontpanel
  * 30-AUG-2021 new memory configuration sections
+ * 18-OCT-2026 option to pace TU-ART characters at the programmed baud rates
  */
 
 #include <stdlib.h>
@@ -28,6 +29,8 @@
 #include "simmem.h"
 #include "simcfg.h"
 
+#include "cromemco-tu-art.h"
+
 #include "log.h"
 static const char *TAG = "config";
 
@@ -87,6 +90,8 @@ void config(void)
 					ns_port = NS_DEF_PORT;
 				}
 #endif
+			} else if (!strcmp(t1, "tuart_baud_pacing")) {
+				tuart_pacing = (atoi(t2) != 0);
 			} else if (!strcmp(t1, "ram")) {
 				if (num_segs >= MAXMEMMAP) {
 					LOGW(TAG, "too many rom/ram statements");
@@ -175,4 +180,7 @@ void config(void)
 		LOG(TAG, "Web server builtin, but disabled\r\n");
 	}
 #endif
+
+	if (tuart_pacing)
+		LOG(TAG, "TU-ART running at the programmed baud rates\r\n");
 }
@@ -28,6 +28,7 @@
  * 17-JUN-2021 allow building machine without frontpanel
  * 29-APR-2024 added CPU execution statistics
  * 04-JAN-2025 add SDL2 support
+ * 18-OCT-2026 sample the bus for the front panel at a bounded rate
  */
 
 #include <stdio.h>
@@ -68,6 +69,9 @@ static const char *TAG = "system";
 #define CPUSW_STEP	2	/* single step */
 #define CPUSW_STEPCYCLE	3	/* machine cycle step */
 
+int fp_sample_count = 1;	/* memory cycles until the next bus sample */
+WORD fp_sample_seed = 0xace1;	/* LFSR for the distance of the bus samples */
+
 static BYTE fp_led_wait;
 static BYTE fp_led_speed;
 static int cpu_switch;
@@ -32,6 +32,9 @@
  * 17-JUN-2021 allow building machine without frontpanel
  * 29-JUL-2021 add boot config for machine without frontpanel
  * 27-MAY-2024 moved io_in & io_out to simcore
+ * 18-OCT-2026 TU-ART HAL accepts telnet connections, SIGIO removed
+ * 18-OCT-2026 optional TU-ART pacing at the programmed baud rates
+ * 18-OCT-2026 close the TU-ART connections through the HAL on exit
  */
 
 #include <pthread.h>
@@ -227,14 +230,7 @@ void init_io(void)
 	static struct itimerval tim;
 	static struct sigaction newact;
 
-	/* initialize TCP/IP networking */
-#ifdef TCPASYNC
-	newact.sa_handler = sigio_tcp_server_socket;
-	sigemptyset(&newact.sa_mask);
-	newact.sa_flags = 0;
-	sigaction(SIGIO, &newact, NULL);
-#endif
-
+	/* initialize TCP/IP networking, the HAL accepts connections */
 	for (i = 0; i < NUMNSOC; i++) {
 		ncons[i].port = SERVERPORT + i;
 		ncons[i].telnet = 1;
@@ -283,8 +279,6 @@ void init_io(void)
  */
 void exit_io(void)
 {
-	register int i;
-
 	wdi_exit();
 
 	/* close line printer files */
@@ -294,10 +288,7 @@ void exit_io(void)
 		close(lpt2);
 
 	/* close network connections */
-	for (i = 0; i < NUMNSOC; i++) {
-		if (ncons[i].ssc)
-			close(ncons[i].ssc);
-	}
+	hal_hangup();
 
 	/* shutdown DAZZLER */
 	cromemco_dazzler_off();
@@ -492,7 +483,7 @@ static void *timing(void *arg)
 			index_pulse++;
 
 		/* the tty transmit clear happens irrespective of anything */
-		if (uart0a_tbe == 0)
+		if (uart0a_tbe == 0 && !tuart_busy(uart0a_tx_t, uart0a_baud))
 			uart0a_tbe = 2;
 
 		/* count down the timers */
@@ -655,7 +646,7 @@ static void *timing(void *arg)
 		}
 
 		/* UART 1A transmit buffer empty */
-		if (!uart1a_tbe) {
+		if (!uart1a_tbe && !tuart_busy(uart1a_tx_t, uart1a_baud)) {
 			uart1a_tbe = true;
 			if (uart1a_int_mask & 32) {
 				uart1a_int = 0xef;
@@ -693,7 +684,7 @@ static void *timing(void *arg)
 		}
 
 		/* UART 1B transmit buffer empty */
-		if (!uart1b_tbe) {
+		if (!uart1b_tbe && !tuart_busy(uart1b_tx_t, uart1b_baud)) {
 			uart1b_tbe = true;
 			if (uart1b_int_mask & 32) {
 				uart1b_int = 0xef;
@@ -753,15 +744,10 @@ static void interrupt(int sig)
 	if ((counter % 51) == 0)
 		rtc = true;
 
-#ifndef TCPASYNC
-	/* poll TCP sockets if SIGIO not working */
-	sigio_tcp_server_socket(0);
-#endif
-
 	BYTE status = 0;
 	hal_status_in(TUART0A, &status);
 
-	if (status & 2) {
+	if ((status & 2) && !tuart_busy(uart0a_rx_t, uart0a_baud)) {
 		uart0a_rda = true;
 	} else {
 		uart0a_rda = false;
@@ -770,7 +756,7 @@ static void interrupt(int sig)
 	status = 0;
 	hal_status_in(TUART1A, &status);
 
-	if (status & 2) {
+	if ((status & 2) && !tuart_busy(uart1a_rx_t, uart1a_baud)) {
 		uart1a_rda = true;
 	} else {
 		uart1a_rda = false;
@@ -779,7 +765,7 @@ static void interrupt(int sig)
 	status = 0;
 	hal_status_in(TUART1B, &status);
 
-	if (status & 2) {
+	if ((status & 2) && !tuart_busy(uart1b_rx_t, uart1b_baud)) {
 		uart1b_rda = true;
 	} else {
 		uart1b_rda = false;
@@ -795,6 +781,7 @@ void ice_go(void)
 	static struct sigaction newact;
 
 	set_unix_terminal();
+	hal_stdio_hold(false);
 
 	newact.sa_handler = interrupt;
 	sigemptyset(&newact.sa_mask);
@@ -814,6 +801,7 @@ void ice_break(void)
 	newact.sa_flags = 0;
 	sigaction(SIGALRM, &newact, NULL);
 
+	hal_stdio_hold(true);
 	reset_unix_terminal();
 }
 #endif
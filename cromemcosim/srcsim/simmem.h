@@ -18,11 +18,15 @@
  * 30-AUG-2021 new memory configuration sections
  * 02-SEP-2021 implement banked ROM
  * 14-DEC-2024 added hardware breakpoint support
+ * 18-OCT-2026 add block functions for direct memory access
+ * 18-OCT-2026 sample the bus for the front panel at a bounded rate
  */
 
 #ifndef SIMMEM_INC
 #define SIMMEM_INC
 
+#include <string.h>
+
 #include "sim.h"
 #include "simdefs.h"
 #ifdef WANT_ICE
@@ -85,15 +89,48 @@ extern int p_tab[MAXPAGES];		/* 256 pages of 256 bytes */
 extern void init_memory(void);
 extern void reset_fdc_rom_map(void);
 
+#ifdef FRONTPANEL
+/*
+ * front panel part of a memory cycle of the CPU. The clock counts every
+ * cycle, but at full speed the bus is sampled only every 1 to
+ * FP_SAMPLE_MASK + 1 cycles, the distance is taken from a LFSR so that
+ * loops don't alias with it. The lights integrate the samples weighted
+ * with the clock, so they still show the right brightness. Only when
+ * single stepping the cycle is timed and may wait in wait_step().
+ */
+static inline void fp_memcycle(WORD addr, BYTE data)
+{
+	uint64_t t;
+
+	fp_clock++;
+	fp_led_address = addr;
+	fp_led_data = data;
+
+	if (cpu_state == ST_SINGLE_STEP) {
+		t = get_clock_us();
+		fp_sampleData();
+		wait_step();
+		cpu_tadj += get_clock_us() - t;
+		return;
+	}
+
+	cpu_bus &= ~CPU_M1;
+	m1_step = false;
+	if (--fp_sample_count <= 0) {
+		fp_sample_seed = (fp_sample_seed >> 1) ^
+				 (-(fp_sample_seed & 1) & 0xb400);
+		fp_sample_count = (fp_sample_seed & FP_SAMPLE_MASK) + 1;
+		fp_sampleData();
+	}
+}
+#endif
+
 /*
  * memory access for the CPU cores
  */
 static inline void memwrt(WORD addr, BYTE data)
 {
 	register int i;
-#ifdef FRONTPANEL
-	uint64_t t;
-#endif
 
 #ifdef BUS_8080
 #ifndef FRONTPANEL
@@ -103,15 +140,9 @@ static inline void memwrt(WORD addr, BYTE data)
 #endif
 
 #ifdef FRONTPANEL
-	if (F_flag) {
-		t = get_clock_us();
-		fp_clock++;
-		fp_led_address = addr;
-		fp_led_data = data;
-		fp_sampleData();
-		wait_step();
-		cpu_tadj += get_clock_us() - t;
-	} else
+	if (F_flag)
+		fp_memcycle(addr, data);
+	else
 		cpu_bus &= ~CPU_M1;
 #endif
 
@@ -140,9 +171,6 @@ static inline void memwrt(WORD addr, BYTE data)
 static inline BYTE memrdr(WORD addr)
 {
 	register BYTE data;
-#ifdef FRONTPANEL
-	uint64_t t;
-#endif
 
 #ifdef WANT_HB
 	if (hb_flag && hb_addr == addr) {
@@ -172,15 +200,9 @@ static inline BYTE memrdr(WORD addr)
 #endif
 
 #ifdef FRONTPANEL
-	if (F_flag) {
-		t = get_clock_us();
-		fp_clock++;
-		fp_led_address = addr;
-		fp_led_data = data;
-		fp_sampleData();
-		wait_step();
-		cpu_tadj += get_clock_us() - t;
-	} else
+	if (F_flag)
+		fp_memcycle(addr, data);
+	else
 		cpu_bus &= ~CPU_M1;
 #endif
 
@@ -210,6 +232,49 @@ static inline void dma_write(WORD addr, BYTE data)
 	}
 }
 
+/*
+ * block memory access for DMA devices, the transfer is split at page
+ * boundaries and each page is copied with memcpy()
+ */
+static inline void dma_read_block(WORD addr, BYTE *buf, int len)
+{
+	register int n;
+
+	while (len > 0) {
+		n = 256 - (addr & 0xff);
+		if (n > len)
+			n = len;
+		if (fdc_rom_active && (addr >> 13) == 0x6) /* C000 to DFFF */
+			memcpy(buf, fdc_banked_rom + addr - 0xC000, n);
+		else if (selbnk || p_tab[addr >> 8] != MEM_NONE)
+			memcpy(buf, memory[selbnk] + addr, n);
+		else
+			memset(buf, 0xff, n);
+		addr += n;
+		buf += n;
+		len -= n;
+	}
+}
+
+static inline void dma_write_block(WORD addr, const BYTE *buf, int len)
+{
+	register int n;
+
+	while (len > 0) {
+		n = 256 - (addr & 0xff);
+		if (n > len)
+			n = len;
+		if (fdc_rom_active && (addr >> 13) == 0x6) { /* C000 to DFFF */
+			/* banked ROM is not writable */
+		} else if (selbnk || p_tab[addr >> 8] == MEM_RW) {
+			memcpy(memory[selbnk] + addr, buf, n);
+		}
+		addr += n;
+		buf += n;
+		len -= n;
+	}
+}
+
 /*
  * direct memory access for simulation frame, video logic, etc.
  */
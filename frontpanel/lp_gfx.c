@@ -19,7 +19,17 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
+#if !defined(__MINGW32__) && !defined(_WIN32) && !defined(_WIN32_) && !defined(__WIN32__)
+#define LP_TEXCACHE
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 #ifdef WANT_SDL
 #include <SDL.h>
 #include <SDL_image.h>
@@ -185,6 +195,8 @@ void lpObject_init(lpObject_t *p)		// initializer
 	p->envmapped = false;
 	p->texture_scale[0] = p->texture_scale[1] = 1.0;
 	p->texture_translate[0] = p->texture_translate[1] = 0.0;
+	p->list = 0;
+	p->list_texture = 0;
 
 	for (i = 0; i < 3; i++) {
 		p->rotate[i] = 0.;
@@ -229,9 +241,46 @@ lpElement_t *lpObject_addElement(lpObject_t *p, lpObject_t *obj)
 	return element;
 }
 
+// draw the elements of an object from a display list, which is compiled
+// when the object is drawn the first time. The texture coordinates depend
+// on the texture bound, so if the object is drawn with another texture
+// the elements are drawn directly.
+
+static void drawElements(lpObject_t *p)
+{
+	int i, tex;
+
+	tex = p->textures ? p->textures->last_accessed : 0;
+
+	if (p->list && p->list_texture == tex) {
+		glCallList(p->list);
+		return;
+	}
+
+	if (p->list == 0 && (p->list = glGenLists(1)) != 0) {
+		p->list_texture = tex;
+		glNewList(p->list, GL_COMPILE_AND_EXECUTE);
+		for (i = 0; i < p->num_elements; i++)
+			lpElement_draw(p->elements[i]);
+		glEndList();
+		return;
+	}
+
+	for (i = 0; i < p->num_elements; i++)
+		lpElement_draw(p->elements[i]);
+}
+
+// delete the display list, needed before the GL context is destroyed
+
+void lpObject_releaseList(lpObject_t *p)
+{
+	if (p->list)
+		glDeleteLists(p->list, 1);
+	p->list = 0;
+}
+
 void lpObject_draw(lpObject_t *p)
 {
-	int i;
 	lpObject_t *obj;
 
 	if (p->referenced)
@@ -262,8 +311,7 @@ void lpObject_draw(lpObject_t *p)
 	glRotatef(p->rotate[0], 1., 0., 0.);
 	glRotatef(p->rotate[1], 1., 0., 0.);
 
-	for (i = 0; i < p->num_elements; i++)
-		lpElement_draw(p->elements[i]);
+	drawElements(p);
 
 	if (p->have_normals)
 		glDisable(GL_LIGHTING);
@@ -280,8 +328,7 @@ void lpObject_draw(lpObject_t *p)
 			} else
 				glColor3fv(obj->color);
 
-			for (i = 0; i < obj->num_elements; i++)
-				lpElement_draw(obj->elements[i]);
+			drawElements(obj);
 
 			glDisable(GL_LIGHTING);
 		}
@@ -301,7 +348,6 @@ void lpObject_draw(lpObject_t *p)
 
 void lpObject_draw_refoverride(lpObject_t *p, int refoverride)
 {
-	int i;
 	lpObject_t *obj;
 
 	if (p->texture_num) {
@@ -329,8 +375,7 @@ void lpObject_draw_refoverride(lpObject_t *p, int refoverride)
 	glRotatef(p->rotate[0], 1., 0., 0.);
 	glRotatef(p->rotate[1], 1., 0., 0.);
 
-	for (i = 0; i < p->num_elements; i++)
-		lpElement_draw(p->elements[i]);
+	drawElements(p);
 
 	obj = p->instance_object;
 
@@ -343,8 +388,7 @@ void lpObject_draw_refoverride(lpObject_t *p, int refoverride)
 		} else
 			glColor3fv(obj->color);
 
-		for (i = 0; i < obj->num_elements; i++)
-			lpElement_draw(obj->elements[i]);
+		drawElements(obj);
 
 		glDisable(GL_LIGHTING);
 
@@ -658,6 +702,11 @@ void lpTextures_fini(lpTextures_t *p)
 	if (p->tex) {
 		for (i = 0; i < p->num_textures; i++)
 			if (p->tex[i]) {
+#ifdef LP_TEXCACHE
+				if (p->tex[i]->cache_map)
+					munmap(p->tex[i]->cache_map, p->tex[i]->cache_size);
+				else
+#endif
 				if (p->tex[i]->texels)
 					free(p->tex[i]->texels);
 				free(p->tex[i]);
@@ -667,10 +716,247 @@ void lpTextures_fini(lpTextures_t *p)
 	}
 }
 
+/* get power of 2 */
+
+static int GetPowerOf2i(int n)
+{
+	int result = 0x2;
+
+	while (result < n)
+		result = result << 1;
+	return result;
+}
+
+// size of all mip map levels of a texture, also sets the number of levels
+
+static size_t texelsSize(texture_t *tp)
+{
+	int w = tp->texSsize, h = tp->texTsize;
+	size_t n = 0;
+
+	for (tp->texLevels = 1; ; tp->texLevels++) {
+		n += (size_t) w * h * tp->imgZsize;
+		if (w == 1 && h == 1)
+			break;
+		w = (w > 1) ? w / 2 : 1;
+		h = (h > 1) ? h / 2 : 1;
+	}
+
+	return n;
+}
+
+// copy the image with rows of pitch bytes into the power of 2 texture,
+// bottom row first. The texture is padded by repeating the last column
+// and row of the image, so the smaller mip map levels don't get dark
+// edges. Each mip map level is the 2x2 box filtered previous level.
+
+static bool makeTexels(texture_t *tp, const unsigned char *pixels, int pitch, bool flip)
+{
+	const unsigned char *src, *s0, *s1;
+	unsigned char *dst;
+	int x, y, yy, z, w, h, nw, nh, dx, dy, zs = tp->imgZsize;
+
+	tp->texSsize = GetPowerOf2i(tp->imgXsize);
+	tp->texTsize = GetPowerOf2i(tp->imgYsize);
+
+	if ((tp->texels = (unsigned char *) malloc(texelsSize(tp))) == NULL)
+		return false;
+
+	dst = tp->texels;
+	for (y = 0; y < tp->texTsize; y++) {
+		yy = (y < tp->imgYsize) ? y : tp->imgYsize - 1;
+		if (flip)
+			yy = tp->imgYsize - 1 - yy;
+		memcpy(dst, pixels + (size_t) pitch * yy, (size_t) tp->imgXsize * zs);
+		dst += (size_t) tp->imgXsize * zs;
+		for (x = tp->imgXsize; x < tp->texSsize; x++, dst += zs)
+			memcpy(dst, dst - zs, zs);
+	}
+
+	src = tp->texels;
+	for (w = tp->texSsize, h = tp->texTsize; w > 1 || h > 1; w = nw, h = nh) {
+		nw = (w > 1) ? w / 2 : 1;
+		nh = (h > 1) ? h / 2 : 1;
+		dx = (w > 1) ? zs : 0;
+		dy = (h > 1) ? w * zs : 0;
+		for (y = 0; y < nh; y++) {
+			s0 = src + (size_t) (h > 1 ? 2 * y : y) * w * zs;
+			s1 = s0 + dy;
+			for (x = 0; x < nw; x++, s0 += 2 * zs, s1 += 2 * zs)
+				for (z = 0; z < zs; z++)
+					*dst++ = (s0[z] + s0[z + dx] + s1[z] + s1[z + dx] + 2) >> 2;
+		}
+		src += (size_t) w * h * zs;
+	}
+
+	return true;
+}
+
+#ifdef LP_TEXCACHE
+
+// The decoded textures with all mip map levels are cached in files under
+// $XDG_CACHE_HOME/z80pack (default ~/.cache/z80pack), named by a hash of
+// the image path. A cache file is only used if the path, modification
+// time, size and inode of the image and the loader match, otherwise it
+// is rewritten. The texels are used directly from the mapped file.
+
+#define TEXCACHE_MAGIC		"LPTEX\0\0\1"
+#ifdef WANT_SDL
+#define TEXCACHE_LOADER		1	// SDL_image, converted to RGBA32
+#else
+#define TEXCACHE_LOADER		0	// libjpeg
+#endif
+
+typedef struct {
+	char		magic[8];
+	int64_t		mtime,		// key: the image file
+			size;
+	uint64_t	ino;
+	int32_t		loader,
+			pathlen;
+	int32_t		imgXsize,	// the texture
+			imgYsize,
+			imgZsize,
+			texSsize,
+			texTsize,
+			texLevels;
+	uint64_t	offset,		// of the texels in the file
+			texels_size;
+} texcache_hdr_t;
+
+static bool texcachePath(const char *fname, char *path, size_t len, texcache_hdr_t *hdr,
+			 char *real)
+{
+	const char *dir;
+	struct stat st;
+	uint64_t h = 0xcbf29ce484222325ULL;
+	const unsigned char *s;
+
+	if (realpath(fname, real) == NULL || stat(real, &st) == -1)
+		return false;
+
+	memset(hdr, 0, sizeof(*hdr));
+	memcpy(hdr->magic, TEXCACHE_MAGIC, sizeof(hdr->magic));
+	hdr->mtime = st.st_mtime;
+	hdr->size = st.st_size;
+	hdr->ino = st.st_ino;
+	hdr->loader = TEXCACHE_LOADER;
+	hdr->pathlen = strlen(real);
+
+	for (s = (const unsigned char *) real; *s; s++) {
+		h ^= *s;
+		h *= 0x100000001b3ULL;
+	}
+
+	if ((dir = getenv("XDG_CACHE_HOME")) != NULL && *dir)
+		snprintf(path, len, "%s", dir);
+	else if ((dir = getenv("HOME")) != NULL && *dir)
+		snprintf(path, len, "%s/.cache", dir);
+	else
+		return false;
+	mkdir(path, 0700);
+	snprintf(path + strlen(path), len - strlen(path), "/z80pack");
+	if (mkdir(path, 0755) == -1 && errno != EEXIST)
+		return false;
+	snprintf(path + strlen(path), len - strlen(path), "/%016llx.tex",
+		 (unsigned long long) h);
+
+	return true;
+}
+
+static bool texcacheLoad(texture_t *tp, const char *path, const texcache_hdr_t *key,
+			 const char *real)
+{
+	const texcache_hdr_t *hdr;
+	struct stat st;
+	void *map;
+	int fd;
+
+	if ((fd = open(path, O_RDONLY)) == -1)
+		return false;
+	if (fstat(fd, &st) == -1 || st.st_size < (off_t) sizeof(texcache_hdr_t)) {
+		close(fd);
+		return false;
+	}
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return false;
+
+	hdr = (const texcache_hdr_t *) map;
+	if (memcmp(hdr->magic, key->magic, sizeof(hdr->magic))
+	    || hdr->mtime != key->mtime || hdr->size != key->size
+	    || hdr->ino != key->ino || hdr->loader != key->loader
+	    || hdr->pathlen != key->pathlen
+	    || (uint64_t) st.st_size < sizeof(*hdr) + hdr->pathlen
+	    || memcmp(hdr + 1, real, hdr->pathlen)
+	    || hdr->offset + hdr->texels_size != (uint64_t) st.st_size) {
+		munmap(map, st.st_size);
+		return false;
+	}
+
+	tp->imgXsize = hdr->imgXsize;
+	tp->imgYsize = hdr->imgYsize;
+	tp->imgZsize = hdr->imgZsize;
+	tp->texSsize = hdr->texSsize;
+	tp->texTsize = hdr->texTsize;
+	if (texelsSize(tp) != hdr->texels_size || tp->texLevels != hdr->texLevels) {
+		munmap(map, st.st_size);
+		return false;
+	}
+	tp->texels = (unsigned char *) map + hdr->offset;
+	tp->cache_map = map;
+	tp->cache_size = st.st_size;
+
+	return true;
+}
+
+// written under a temporary name and renamed, so that concurrently
+// starting simulators never see a partial file
+
+static void texcacheSave(texture_t *tp, const char *path, texcache_hdr_t *hdr,
+			 const char *real)
+{
+	static const char pad[64];
+	char tmp[PATH_MAX + 32];
+	size_t n;
+	FILE *fp;
+	bool ok;
+
+	hdr->imgXsize = tp->imgXsize;
+	hdr->imgYsize = tp->imgYsize;
+	hdr->imgZsize = tp->imgZsize;
+	hdr->texSsize = tp->texSsize;
+	hdr->texTsize = tp->texTsize;
+	hdr->texLevels = tp->texLevels;
+	hdr->texels_size = texelsSize(tp);
+	n = sizeof(*hdr) + hdr->pathlen;
+	hdr->offset = (n + sizeof(pad) - 1) & ~(sizeof(pad) - 1);
+
+	snprintf(tmp, sizeof(tmp), "%s.%ld", path, (long) getpid());
+	if ((fp = fopen(tmp, "wb")) == NULL)
+		return;
+	ok = fwrite(hdr, sizeof(*hdr), 1, fp) == 1
+	     && fwrite(real, hdr->pathlen, 1, fp) == 1
+	     && fwrite(pad, hdr->offset - n, 1, fp) == (hdr->offset > n ? 1U : 0U)
+	     && fwrite(tp->texels, hdr->texels_size, 1, fp) == 1;
+	ok = (fclose(fp) == 0) && ok;
+	if (!ok || rename(tmp, path) == -1)
+		unlink(tmp);
+}
+
+#endif /* LP_TEXCACHE */
+
 int lpTextures_addTexture(lpTextures_t *p, char *fname)
 {
 	int texnum;
 	texture_t *tp;
+	bool ok;
+#ifdef LP_TEXCACHE
+	char path[PATH_MAX + 32], real[PATH_MAX];
+	texcache_hdr_t hdr;
+	bool cached;
+#endif
 #ifdef WANT_SDL
 	SDL_Surface *surface, *temp_surface;
 #else
@@ -683,6 +969,12 @@ int lpTextures_addTexture(lpTextures_t *p, char *fname)
 
 	p->tex[texnum] = tp = (texture_t *) calloc(1, sizeof(texture_t));
 
+#ifdef LP_TEXCACHE
+	cached = texcachePath(fname, path, sizeof(path), &hdr, real);
+	if (cached && texcacheLoad(tp, path, &hdr, real))
+		goto loaded;
+#endif
+
 #ifdef WANT_SDL
 	temp_surface = IMG_Load(fname);
 	if (!temp_surface)
@@ -695,14 +987,34 @@ int lpTextures_addTexture(lpTextures_t *p, char *fname)
 	tp->imgXsize = surface->w;
 	tp->imgYsize = surface->h;
 	tp->imgZsize = surface->format->BytesPerPixel;
-	tp->surface = surface;
+
+	// lock SDL surface for direct access
+	if (SDL_MUSTLOCK(surface) && SDL_LockSurface(surface) < 0) {
+		fprintf(stderr, "addTexture: Can't lock SDL surface.\n");
+		SDL_FreeSurface(surface);
+		return 0;
+	}
+	// SDL surface rows are top to bottom
+	ok = makeTexels(tp, (unsigned char *) surface->pixels, surface->pitch, true);
+	if (SDL_MUSTLOCK(surface))
+		SDL_UnlockSurface(surface);
+	SDL_FreeSurface(surface);
 #else /* !WANT_SDL */
 	pixels = read_jpeg(fname, &tp->imgXsize, &tp->imgYsize, &tp->imgZsize);
 	if (!pixels)
 		return 0;
-	tp->pixels = pixels;
+	// read_jpeg() returns the rows bottom to top
+	ok = makeTexels(tp, pixels, tp->imgXsize * tp->imgZsize, false);
+	free(pixels);
 #endif /* !WANT_SDL */
+	if (!ok)
+		return 0;
 
+#ifdef LP_TEXCACHE
+	if (cached)
+		texcacheSave(tp, path, &hdr, real);
+loaded:
+#endif
 	p->num_textures++;
 
 	// printf("\n\nAddTextureFile: added %s %dx%dx%d as texnum %d \n", fname,
@@ -713,35 +1025,16 @@ int lpTextures_addTexture(lpTextures_t *p, char *fname)
 	return texnum;
 }
 
-/* get power of 2 */
-
-static int GetPowerOf2i(int n)
-{
-	int result = 0x2;
-
-	while (result < n)
-		result = result << 1;
-	return result;
-}
-
 int lpTextures_downloadTextures(lpTextures_t *p)
 {
-	int texnum, n;
+	int texnum, n, level, w, h;
+	unsigned char *texels;
 	texture_t *tp;
 
 	for (texnum = 1; texnum < p->num_textures; texnum++) {
 		tp = p->tex[texnum];
 
-#ifdef WANT_SDL
-		if (tp->surface) {
-#else
-		if (tp->pixels) {
-#endif
-			// calc power of two S and T dimensions
-
-			tp->texSsize = GetPowerOf2i(tp->imgXsize);
-			tp->texTsize = GetPowerOf2i(tp->imgYsize);
-
+		if (tp->texels && !tp->bind_id) {
 			// set gl parms
 
 			switch (tp->imgZsize) {
@@ -774,70 +1067,6 @@ int lpTextures_downloadTextures(lpTextures_t *p)
 
 			tp->texTmax = (float) tp->imgYsize / (float) tp->texTsize;
 
-#ifdef WANT_SDL
-			// copy SDL surface pixel data to texel data bottom to top
-
-			unsigned char *src, *rsrc, *dst;
-			int x, y, z;
-
-			// lock SDL surface for direct access
-			if (SDL_MUSTLOCK(tp->surface) && SDL_LockSurface(tp->surface) < 0) {
-				fprintf(stderr, "addTexture: Can't lock SDL surface.\n");
-				return 0;
-			}
-
-			// position after last row of pixels
-			rsrc = (unsigned char *) tp->surface->pixels +
-			       tp->surface->pitch * tp->imgYsize;
-
-			tp->texels = (unsigned char *) malloc(tp->texSsize * tp->texTsize *
-							      tp->imgZsize);
-
-			dst = tp->texels;
-
-			for (y = 0; y < tp->texTsize; y++) {
-				// move up one row of pixels
-				rsrc -= tp->surface->pitch;
-				src = rsrc;
-				for (x = 0; x < tp->texSsize; x++)
-					for (z = 0; z < tp->imgZsize; z++)
-						if (y < tp->imgYsize && x < tp->imgXsize) {
-							*dst++ = *src++;
-						} else
-							*dst++ = 0;
-			}
-
-			// unlock SDL surface and free it
-			if (SDL_MUSTLOCK(tp->surface))
-				SDL_UnlockSurface(tp->surface);
-			SDL_FreeSurface(tp->surface);
-			tp->surface = NULL;
-#else /* !WANT_SDL */
-			// copy image pixel data to texel data
-
-			unsigned char *src, *dst;
-			int x, y, z;
-
-			src = tp->pixels;
-
-			tp->texels = (unsigned char *) malloc(tp->texSsize * tp->texTsize *
-							      tp->imgZsize);
-
-			dst = tp->texels;
-
-			for (y = 0; y < tp->texTsize; y++)
-				for (x = 0; x < tp->texSsize; x++)
-					for (z = 0; z < tp->imgZsize; z++)
-						if (y < tp->imgYsize && x < tp->imgXsize)
-							*dst++ = *src++;
-						else
-							*dst++ = 0;
-
-			// free pixels
-			free(tp->pixels);
-			tp->pixels = NULL;
-#endif /* !WANT_SDL */
-
 			// get a bind id from OpenGL
 
 			(void) glGetError();	/* clear any gl errors */
@@ -846,11 +1075,21 @@ int lpTextures_downloadTextures(lpTextures_t *p)
 			glBindTexture(GL_TEXTURE_2D, tp->bind_id);
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+					GL_LINEAR_MIPMAP_LINEAR);
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-			glTexImage2D(GL_TEXTURE_2D, 0, tp->imgZsize, tp->texSsize, tp->texTsize,
-				     0, tp->format, GL_UNSIGNED_BYTE, tp->texels);
+			// the small mip map levels have rows of less than 4 bytes
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			for (level = 0, w = tp->texSsize, h = tp->texTsize, texels = tp->texels;
+			     level < tp->texLevels; level++) {
+				glTexImage2D(GL_TEXTURE_2D, level, tp->imgZsize, w, h,
+					     0, tp->format, GL_UNSIGNED_BYTE, texels);
+				texels += (size_t) w * h * tp->imgZsize;
+				w = (w > 1) ? w / 2 : 1;
+				h = (h > 1) ? h / 2 : 1;
+			}
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
 			glBindTexture(GL_TEXTURE_2D, 0);
 
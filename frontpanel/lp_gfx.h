@@ -78,6 +78,9 @@ typedef struct lpObject {
 
 	struct lpTextures *textures;
 	lpBBox_t	bbox;
+
+	GLuint		list;		// display list of the elements, 0 if none
+	int		list_texture;	// texture bound when the list was compiled
 } lpObject_t;
 
 extern lpObject_t	*lpObject_new(void);
@@ -98,6 +101,7 @@ extern void 		lpObject_draw(lpObject_t *p);
 extern void		lpObject_draw_refoverride(lpObject_t *p, int refoverride);
 extern void		lpObject_setTextureManager(lpObject_t *p, struct lpTextures *textures);
 extern void		lpObject_genGraphicsData(lpObject_t *p);
+extern void		lpObject_releaseList(lpObject_t *p);
 
 typedef struct lpElement {
 	int		type,		// LP_POLYGON, LP_LINE
@@ -141,22 +145,19 @@ typedef struct texture {
 			imgYsize,
 			imgZsize;
 
-#ifdef WANT_SDL
-	SDL_Surface	*surface;
-#else
-	unsigned char	*pixels;
-#endif
-
 	// texture specific attributes
 
 	GLuint		bind_id;
 	GLuint		format,		// GL_RGB etc.
 			type;		// GL_UNSIGNED_BYTE etc.
 
-	unsigned char	*texels;
+	unsigned char	*texels;	// all mip map levels, largest first
+	void		*cache_map;	// texels are mapped from the cache file
+	size_t		cache_size;
 
 	int		texSsize,	// power of 2 texture size
-			texTsize;
+			texTsize,
+			texLevels;	// number of mip map levels
 
 	float		texSmin,
 			texSmax,
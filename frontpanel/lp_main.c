@@ -41,11 +41,8 @@
 
 #define UNUSED(x) (void) (x)
 
-#ifdef WANT_SDL
-static SDL_mutex *data_sample_lock;
-#else
+#ifndef WANT_SDL
 static pthread_mutex_t data_lock;
-static pthread_mutex_t data_sample_lock;
 static thread_info_t thread_info;
 #endif
 
@@ -82,10 +79,8 @@ static void *lp_mainloop_thread(void *n)
 		// Lpanel_sampleData(panel);
 		Lpanel_procEvents(panel);
 
-		// draw
-		pthread_mutex_lock(&data_sample_lock);
+		// draw, integrates the samples taken since the last frame
 		Lpanel_draw(panel);
-		pthread_mutex_unlock(&data_sample_lock);
 
 		// unlock
 		pthread_mutex_unlock(&data_lock);
@@ -128,7 +123,6 @@ static int start_threads(void)
 	int n;
 
 	pthread_mutex_init(&data_lock, NULL);
-	pthread_mutex_init(&data_sample_lock, NULL);
 	thread_info.run = 1;
 	n = pthread_create(&thread_info.thread_id, NULL, lp_mainloop_thread,
 			   &thread_info.thread_no);
@@ -302,8 +296,6 @@ int fp_init2(const char *cfg_root_path, const char *cfg_fname, int size)
 
 void fp_openWindow(void)
 {
-	data_sample_lock = SDL_CreateMutex();
-
 	if (!Lpanel_openWindow(panel, "FrontPanel")) {
 		fprintf(stderr, "Can't open FrontPanel window\n");
 		exit(EXIT_FAILURE);
@@ -317,9 +309,7 @@ void fp_procEvent(SDL_Event *event)
 
 void fp_draw(bool tick)
 {
-	SDL_LockMutex(data_sample_lock);
 	Lpanel_draw(panel);
-	SDL_UnlockMutex(data_sample_lock);
 	SDL_GL_SwapWindow(panel->window);
 	glFinish();
 	framecount++;
@@ -356,24 +346,12 @@ void fp_draw(void)
 
 #endif /* !WANT_SDL */
 
+// no locking, the bound data words are stored in a ring buffer
+// which the renderer integrates when drawing the next frame
+
 void fp_sampleData(void)
 {
-	// mutex lock
-#ifdef WANT_SDL
-	SDL_LockMutex(data_sample_lock);
-#else
-	pthread_mutex_lock(&data_sample_lock);
-#endif
-
 	Lpanel_sampleData(panel);
-
-	// mutex unlock
-#ifdef WANT_SDL
-	SDL_UnlockMutex(data_sample_lock);
-#else
-	pthread_mutex_unlock(&data_sample_lock);
-#endif
-
 	samplecount++;
 }
 
@@ -406,8 +384,6 @@ void fp_quit(void)
 {
 #ifdef WANT_SDL
 	Lpanel_destroyWindow(panel);
-
-	SDL_DestroyMutex(data_sample_lock);
 #else /* !WANT_SDL */
 	int i;
 	bool okay = false;
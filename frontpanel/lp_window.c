@@ -1011,6 +1011,8 @@ int Lpanel_openWindow(Lpanel_t *p, const char *title)
 
 void Lpanel_destroyWindow(Lpanel_t *p)
 {
+	Lpanel_releaseGraphics(p);
+
 	glFlush();
 	glFinish();
 
@@ -110,71 +110,6 @@ static void sampleData8_error(lpLight_t *p)
 #endif
 }
 
-static void sampleData8(lpLight_t *p)
-{
-	unsigned char bit;
-	uint8_t *ptr = (uint8_t *) p->dataptr;
-
-	bit = (int) (*ptr >> p->bitnum) & 0x01;
-
-	if (bit) {
-		p->on_time += (*p->simclock - p->old_clock);
-	}
-	p->old_clock = *p->simclock;
-	p->dirty = true;
-	p->state = bit;
-}
-
-static void sampleData8invert(lpLight_t *p)
-{
-	unsigned char bit;
-	uint8_t *ptr = (uint8_t *) p->dataptr;
-
-	bit = (int) ~(*ptr >> p->bitnum) & 0x01;
-
-	if (bit) {
-		p->on_time += (*p->simclock - p->old_clock);
-	}
-	p->old_clock = *p->simclock;
-	p->dirty = true;
-	p->state = bit;
-}
-
-static void sampleData16(lpLight_t *p)
-{
-	unsigned char bit;
-	uint16_t *ptr = (uint16_t *) p->dataptr;
-#if 0
-	uint64_t on_time_inc = 0;
-#endif
-	bit = (int) (*ptr >> p->bitnum) & 0x01;
-
-#if 0
-	if (bit) {
-#if 0
-		p->on_time += (*p->simclock - p->old_clock);
-#endif
-		on_time_inc = (*p->simclock - p->old_clock);
-	}
-
-	if (bit != p->state) {
-		on_time_inc = on_time_inc >> 1;
-	}
-	p->on_time += on_time_inc;
-#endif
-
-	// if (p->old_clock > *p->simclock)
-	// 	printf("sampleData16: clock stepped backward\n");
-
-	if (bit) {
-		p->on_time += (*p->simclock - p->old_clock);
-	}
-
-	p->old_clock = *p->simclock;
-	p->dirty = true;
-	p->state = bit;
-}
-
 static void sampleDatafv(lpLight_t *p)
 {
 	float *ptr = (float *) p->dataptr;
@@ -195,79 +130,14 @@ static void sampleDatafv(lpLight_t *p)
 		p->intensity = ptr[p->bitnum];
 }
 
-static void sampleData16invert(lpLight_t *p)
-{
-	unsigned char bit;
-	uint16_t *ptr = (uint16_t *) p->dataptr;
-
-	bit = (int) ~(*ptr >> p->bitnum) & 0x01;
-
-	if (bit) {
-		p->on_time += (*p->simclock - p->old_clock);
-	}
-	p->old_clock = *p->simclock;
-	p->dirty = true;
-	p->state = bit;
-}
+// bind a light to a bit of a data word, lights of the same word share one
+// source which is sampled as a whole
 
-static void sampleData32(lpLight_t *p)
+static void bindDataBits(lpLight_t *p, void *ptr, int size, bool invert)
 {
-	unsigned char bit;
-	uint32_t *ptr = (uint32_t *) p->dataptr;
-
-	bit = (int) (*ptr >> p->bitnum) & 0x01;
-
-	if (bit) {
-		p->on_time += (*p->simclock - p->old_clock);
-	}
-	p->old_clock = *p->simclock;
-	p->dirty = true;
-	p->state = bit;
-}
-
-static void sampleData32invert(lpLight_t *p)
-{
-	unsigned char bit;
-	uint32_t *ptr = (uint32_t *) p->dataptr;
-
-	bit = (int) ~(*ptr >> p->bitnum) & 0x01;
-
-	if (bit) {
-		p->on_time += (*p->simclock - p->old_clock);
-	}
-	p->old_clock = *p->simclock;
-	p->dirty = true;
-	p->state = bit;
-}
-
-static void sampleData64(lpLight_t *p)
-{
-	unsigned char bit;
-	uint64_t *ptr = (uint64_t *) p->dataptr;
-
-	bit = (int) (*ptr >> p->bitnum) & 0x01;
-
-	if (bit) {
-		p->on_time += (*p->simclock - p->old_clock);
-	}
-	p->old_clock = *p->simclock;
-	p->dirty = true;
-	p->state = bit;
-}
-
-static void sampleData64invert(lpLight_t *p)
-{
-	unsigned char bit;
-	uint64_t *ptr = (uint64_t *) p->dataptr;
-
-	bit = (int) ~(*ptr >> p->bitnum) & 0x01;
-
-	if (bit) {
-		p->on_time += (*p->simclock - p->old_clock);
-	}
-	p->old_clock = *p->simclock;
-	p->dirty = true;
-	p->state = bit;
+	p->dataptr = ptr;
+	p->invert = invert;
+	p->source = Lpanel_addSource(p->panel, ptr, size, p->parms->group);
 }
 
 Lpanel_t *Lpanel_new(void)
@@ -317,6 +187,18 @@ void Lpanel_init(Lpanel_t *p)		// initializer
 	p->simclock = &p->default_clock;
 	p->clock_warp = 0;
 
+	p->num_sources = 0;
+	p->sample_head = p->sample_tail = 0;
+	p->sample_gap = false;
+	p->gfx_lights = NULL;
+	p->num_gfx_lights = 0;
+	p->light_verts = p->light_colors = NULL;
+	p->light_index = NULL;
+	p->num_light_index = 0;
+	p->samples = (lp_sample_t *) calloc(LP_SAMPLE_SLOTS, sizeof(lp_sample_t));
+	if (p->samples == NULL)
+		fprintf(stderr, "Lpanel_init: can't allocate sample buffer\n");
+
 	p->default_runflag = 0;
 	p->runflag = &p->default_runflag;
 	p->default_powerflag = 0;
@@ -438,6 +320,13 @@ void Lpanel_fini(Lpanel_t *p)		// finalizer
 		p->light_groups[i].max_items = 0;
 	}
 
+	free(p->samples);
+	p->samples = NULL;
+	free(p->gfx_lights);
+	free(p->light_verts);
+	free(p->light_colors);
+	free(p->light_index);
+
 	lpTextures_fini(&p->textures);
 	lpBBox_fini(&p->bbox);
 } // end finalizer
@@ -982,6 +871,163 @@ void Lpanel_bindSimclock(Lpanel_t *p, uint64_t *addr)
 
 }
 
+// get the source sampling the data word at ptr for lights of a group,
+// returns -1 if there are too many data words bound
+
+int Lpanel_addSource(Lpanel_t *p, void *ptr, int size, int group)
+{
+	lp_source_t *src;
+	int i;
+
+	for (i = 0; i < p->num_sources; i++) {
+		src = &p->sources[i];
+		if (src->ptr == ptr && src->size == size && src->group == group)
+			return i;
+	}
+
+	if (p->num_sources == LP_MAX_SOURCES) {
+		fprintf(stderr, "addSource: more than %d data words bound to lights\n",
+			LP_MAX_SOURCES);
+		return -1;
+	}
+
+	src = &p->sources[i];
+	memset(src, 0, sizeof(lp_source_t));
+	src->ptr = ptr;
+	src->size = size;
+	src->group = group;
+
+	// the renderer may integrate samples already
+	__atomic_store_n(&p->num_sources, i + 1, __ATOMIC_RELEASE);
+
+	return i;
+}
+
+// The lights drawn as graphics are kept in vertex arrays with the inner
+// and outer circle of every light already placed on the panel, so all of
+// them are drawn with one call. Only the colors of the inner circles
+// change from frame to frame, the outer circles stay black.
+
+static void buildLightArrays(Lpanel_t *p)
+{
+	int i, j, n, k, nv;
+	lpLight_t *light;
+	GLfloat *v;
+	GLuint *idx, base;
+
+	n = cir2d_nverts - 1;	// vertices of a circle
+	nv = 2 * n;		// vertices of a light, inner and outer circle
+
+	p->num_gfx_lights = 0;
+	for (i = 0; i < p->num_lights; i++)
+		if (p->lights[i]->drawFunc == drawLightGraphics)
+			p->num_gfx_lights++;
+	if (p->num_gfx_lights == 0)
+		return;
+
+	p->gfx_lights = (lpLight_t **) malloc(sizeof(lpLight_t *) * p->num_gfx_lights);
+	p->light_verts = (GLfloat *) malloc(sizeof(GLfloat) * 3 * nv * p->num_gfx_lights);
+	p->light_colors = (GLfloat *) calloc(3 * nv * p->num_gfx_lights, sizeof(GLfloat));
+	p->num_light_index = (3 * (n - 2) + 6 * n) * p->num_gfx_lights;
+	p->light_index = (GLuint *) malloc(sizeof(GLuint) * p->num_light_index);
+	if (!p->gfx_lights || !p->light_verts || !p->light_colors || !p->light_index) {
+		fprintf(stderr, "buildLightArrays: can't allocate vertex arrays\n");
+		Lpanel_releaseGraphics(p);
+		p->num_gfx_lights = 0;
+		return;
+	}
+
+	v = p->light_verts;
+	idx = p->light_index;
+	for (i = 0, k = 0; i < p->num_lights; i++) {
+		light = p->lights[i];
+		if (light->drawFunc != drawLightGraphics)
+			continue;
+		p->gfx_lights[k] = light;
+		base = k * nv;
+
+		// vertices 0..n-1 inner circle, n..2n-1 outer circle
+
+		for (j = 0; j < nv; j++) {
+			const float *c = (j < n) ? cir2d_data2[j] : cir2d_data[j - n];
+
+			*v++ = light->parms->pos[0] + c[0] * light->parms->scale[0];
+			*v++ = light->parms->pos[1] + c[1] * light->parms->scale[1];
+			*v++ = light->parms->pos[2];
+		}
+
+		// inner circle as triangle fan
+
+		for (j = 1; j < n - 1; j++) {
+			*idx++ = base;
+			*idx++ = base + j;
+			*idx++ = base + j + 1;
+		}
+
+		// ring from the inner to the outer circle
+
+		for (j = 0; j < n; j++) {
+			*idx++ = base + j;
+			*idx++ = base + n + j;
+			*idx++ = base + (j + 1) % n;
+			*idx++ = base + (j + 1) % n;
+			*idx++ = base + n + j;
+			*idx++ = base + n + (j + 1) % n;
+		}
+		k++;
+	}
+}
+
+static void drawLightArrays(Lpanel_t *p)
+{
+	int i, j, n;
+	GLfloat *c;
+
+	if (p->light_verts == NULL)
+		buildLightArrays(p);
+	if (p->num_gfx_lights == 0)
+		return;
+
+	n = cir2d_nverts - 1;
+	for (i = 0; i < p->num_gfx_lights; i++) {
+		c = &p->light_colors[i * 2 * n * 3];
+		for (j = 0; j < n; j++) {
+			*c++ = p->gfx_lights[i]->color[0];
+			*c++ = p->gfx_lights[i]->color[1];
+			*c++ = p->gfx_lights[i]->color[2];
+		}
+	}
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, p->light_verts);
+	glColorPointer(3, GL_FLOAT, 0, p->light_colors);
+	glDrawElements(GL_TRIANGLES, p->num_light_index, GL_UNSIGNED_INT, p->light_index);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+// free the retained graphics data, display lists must be deleted
+// while the GL context still exists
+
+void Lpanel_releaseGraphics(Lpanel_t *p)
+{
+	int i;
+
+	for (i = 0; i < p->num_objects; i++)
+		if (p->objects[i])
+			lpObject_releaseList(p->objects[i]);
+
+	free(p->gfx_lights);
+	free(p->light_verts);
+	free(p->light_colors);
+	free(p->light_index);
+	p->gfx_lights = NULL;
+	p->light_verts = p->light_colors = NULL;
+	p->light_index = NULL;
+	p->num_gfx_lights = p->num_light_index = 0;
+}
+
 void Lpanel_draw(Lpanel_t *p)
 {
 	int i;
@@ -1018,8 +1064,15 @@ void Lpanel_draw(Lpanel_t *p)
 	glEnable(GL_POLYGON_OFFSET_FILL);
 	glPolygonOffset(0., -10.);
 
-	for (i = 0; i < p->num_lights; i++)
-		lpLight_draw(p->lights[i]);
+	Lpanel_integrateSamples(p);
+
+	for (i = 0; i < p->num_lights; i++) {
+		if (p->lights[i]->drawFunc == drawLightGraphics)
+			lpLight_update(p->lights[i]);
+		else
+			lpLight_draw(p->lights[i]);
+	}
+	drawLightArrays(p);
 
 	// draw switches
 
@@ -1717,10 +1770,54 @@ void Lpanel_resolveObjectInstances(Lpanel_t *p)
 	}
 }
 
-void Lpanel_sampleData(Lpanel_t *p)
+// store a snapshot of the bound data words in the sample ring, this runs
+// in the simulation thread for every sampled bus cycle, so it only copies
+// the words without any locking and leaves all the work to the renderer
+
+static void pushSample(Lpanel_t *p, int group)
 {
+	lp_sample_t *s;
+	lp_source_t *src;
+	unsigned int head;
 	int i;
 
+	if (p->samples == NULL)
+		return;
+
+	head = p->sample_head;
+	if (head - __atomic_load_n(&p->sample_tail, __ATOMIC_ACQUIRE) == LP_SAMPLE_SLOTS) {
+		p->sample_gap = true;
+		return;
+	}
+
+	s = &p->samples[head & (LP_SAMPLE_SLOTS - 1)];
+	s->clock = *p->simclock;
+	s->group = group;
+	s->gap = p->sample_gap;
+	p->sample_gap = false;
+
+	for (i = 0, src = p->sources; i < p->num_sources; i++, src++) {
+		switch (src->size) {
+		case 1:
+			s->value[i] = *(uint8_t *) src->ptr;
+			break;
+		case 2:
+			s->value[i] = *(uint16_t *) src->ptr;
+			break;
+		case 4:
+			s->value[i] = *(uint32_t *) src->ptr;
+			break;
+		default:
+			s->value[i] = *(uint64_t *) src->ptr;
+			break;
+		}
+	}
+
+	__atomic_store_n(&p->sample_head, head + 1, __ATOMIC_RELEASE);
+}
+
+void Lpanel_sampleData(Lpanel_t *p)
+{
 	if (*p->simclock < p->old_clock) {
 		fprintf(stderr, "libfrontpanel: Warning clock went backwards (current=%" PRIu64
 			" previous=%" PRIu64 ".\n", *p->simclock, p->old_clock);
@@ -1728,37 +1825,120 @@ void Lpanel_sampleData(Lpanel_t *p)
 	}
 	p->old_clock = *p->simclock;
 
-	for (i = 0; i < p->num_lights; i++)
-		lpLight_sampleData(p->lights[i]);
+	pushSample(p, -1);
 }
 
 void Lpanel_sampleDataWarp(Lpanel_t *p, int clockwarp)
 {
-	int i;
-
-	p->clock_warp = clockwarp;
+	UNUSED(clockwarp);
 
-	for (i = 0; i < p->num_lights; i++)
-		lpLight_sampleData(p->lights[i]);
-
-	p->clock_warp = 0;
+	pushSample(p, -1);
 }
 
 void Lpanel_sampleLightGroup(Lpanel_t *p, int groupnum, int clockval)
 {
-	int i;
+	UNUSED(clockval);
 
 	if (groupnum < 0 || groupnum >= LP_MAX_LIGHT_GROUPS) {
 		fprintf(stderr, "sampleLightGroup: groupnum (%d) must be in the "
 			"range of (0-%d).\n", groupnum, LP_MAX_LIGHT_GROUPS - 1);
+		return;
 	}
 
-	p->clock_warp = clockval;
+	pushSample(p, groupnum);
+}
 
-	for (i = 0; i < p->light_groups[groupnum].num_items; i++)
-		lpLight_sampleData(p->lights[p->light_groups[groupnum].list[i]]);
+static const uint64_t bitmask[64] = {
+	1ULL << 0,  1ULL << 1,  1ULL << 2,  1ULL << 3,  1ULL << 4,  1ULL << 5,  1ULL << 6,  1ULL << 7,
+	1ULL << 8,  1ULL << 9,  1ULL << 10, 1ULL << 11, 1ULL << 12, 1ULL << 13, 1ULL << 14, 1ULL << 15,
+	1ULL << 16, 1ULL << 17, 1ULL << 18, 1ULL << 19, 1ULL << 20, 1ULL << 21, 1ULL << 22, 1ULL << 23,
+	1ULL << 24, 1ULL << 25, 1ULL << 26, 1ULL << 27, 1ULL << 28, 1ULL << 29, 1ULL << 30, 1ULL << 31,
+	1ULL << 32, 1ULL << 33, 1ULL << 34, 1ULL << 35, 1ULL << 36, 1ULL << 37, 1ULL << 38, 1ULL << 39,
+	1ULL << 40, 1ULL << 41, 1ULL << 42, 1ULL << 43, 1ULL << 44, 1ULL << 45, 1ULL << 46, 1ULL << 47,
+	1ULL << 48, 1ULL << 49, 1ULL << 50, 1ULL << 51, 1ULL << 52, 1ULL << 53, 1ULL << 54, 1ULL << 55,
+	1ULL << 56, 1ULL << 57, 1ULL << 58, 1ULL << 59, 1ULL << 60, 1ULL << 61, 1ULL << 62, 1ULL << 63
+};
 
-	p->clock_warp = 0;
+// integrate the samples taken since the last frame into the on times of
+// the lights, runs in the render thread.
+// The on time of all bits of a data word is summed up by a branch free
+// loop over a table of bit masks, which the compiler vectorizes for
+// targets with 64 bit vector compares (e.g. -mavx2). If the ring was full and
+// samples were dropped, the on time measured is scaled to the whole time.
+
+void Lpanel_integrateSamples(Lpanel_t *p)
+{
+	lp_sample_t *s;
+	lp_source_t *src;
+	lpLight_t *light;
+	unsigned int head, tail;
+	uint64_t dt, v, on, *on_time;
+	int i, j, n, nbits;
+	bool sampled;
+
+	if (p->samples == NULL)
+		return;
+
+	n = __atomic_load_n(&p->num_sources, __ATOMIC_ACQUIRE);
+	head = __atomic_load_n(&p->sample_head, __ATOMIC_ACQUIRE);
+	sampled = (head != p->sample_tail);
+
+	for (tail = p->sample_tail; tail != head; tail++) {
+		s = &p->samples[tail & (LP_SAMPLE_SLOTS - 1)];
+		for (i = 0, src = p->sources; i < n; i++, src++) {
+			if (s->group >= 0 && s->group != src->group)
+				continue;
+			dt = (s->clock > src->old_clock) ? s->clock - src->old_clock : 0;
+			src->old_clock = s->clock;
+			src->value = v = s->value[i];
+			src->span += dt;
+			src->sampled = true;
+			if (s->gap)
+				continue;
+			src->measured += dt;
+			nbits = src->size * 8;
+			on_time = src->on_time;
+			for (j = 0; j < nbits; j++)
+				on_time[j] += dt & -(uint64_t) ((v & bitmask[j]) != 0);
+		}
+	}
+	__atomic_store_n(&p->sample_tail, tail, __ATOMIC_RELEASE);
+
+	for (i = 0; i < p->num_lights; i++) {
+		light = p->lights[i];
+
+		if (light->bindtype == LBINDTYPE_FLOATV) {
+			if (sampled)
+				lpLight_sampleData(light);
+			continue;
+		}
+		if (light->source < 0 || light->source >= n)
+			continue;
+		src = &p->sources[light->source];
+		if (!src->sampled)
+			continue;
+
+		light->state = ((src->value >> light->bitnum) & 1) ^ light->invert;
+		if (src->measured) {
+			on = src->on_time[light->bitnum];
+			if (light->invert)
+				on = src->measured - on;
+			if (src->span != src->measured)
+				on = (uint64_t) ((double) on * src->span / src->measured);
+		} else
+			on = light->state ? src->span : 0;
+		light->on_time += on;
+		light->old_clock = src->old_clock;
+		light->dirty = true;
+	}
+
+	for (i = 0, src = p->sources; i < n; i++, src++) {
+		if (!src->sampled)
+			continue;
+		src->sampled = false;
+		src->span = src->measured = 0;
+		memset(src->on_time, 0, sizeof(src->on_time));
+	}
 }
 
 void Lpanel_setConfigRootPath(Lpanel_t *p, const char *path)
@@ -1810,6 +1990,8 @@ void lpLight_init(lpLight_t *p)
 	p->obj_refname = NULL;
 	p->obj_ref = NULL;
 	p->sampleDataFunc = sampleData8_error;
+	p->source = -1;
+	p->invert = false;
 	p->drawFunc = drawLightGraphics;
 	p->t1 = p->t2 = p->on_time = 1;
 	p->start_clock = 0;
@@ -1852,6 +2034,23 @@ void lpLight_bindSimclock(lpLight_t *p, uint64_t *addr, int *clockwarp)
 }
 
 void lpLight_draw(lpLight_t *p)
+{
+	lpLight_update(p);
+
+	glPushMatrix();
+	glTranslatef(p->parms->pos[0], p->parms->pos[1], p->parms->pos[2]);
+	glScalef(p->parms->scale[0], p->parms->scale[1], p->parms->scale[2]);
+
+	glColor3fv(&p->color[0]);
+
+	(*p->drawFunc)(p);
+
+	glPopMatrix();
+}
+
+// calculate the color of a light from the samples
+
+void lpLight_update(lpLight_t *p)
 {
 	int i;
 	// float *fp;
@@ -1905,16 +2104,6 @@ void lpLight_draw(lpLight_t *p)
 			fprintf(stderr, "draw: %s %f\n", p->name, p->intensity);
 		}
 #endif
-
-	glPushMatrix();
-	glTranslatef(p->parms->pos[0], p->parms->pos[1], p->parms->pos[2]);
-	glScalef(p->parms->scale[0], p->parms->scale[1], p->parms->scale[2]);
-
-	glColor3fv(&p->color[0]);
-
-	(*p->drawFunc)(p);
-
-	glPopMatrix();
 }
 
 void lpLight_print(lpLight_t *p)
@@ -1935,21 +2124,17 @@ void lpLight_print(lpLight_t *p)
 
 void lpLight_bindData8(lpLight_t *p, uint8_t *ptr)
 {
-	p->sampleDataFunc = sampleData8;
-	p->dataptr = (uint8_t *) ptr;
+	bindDataBits(p, ptr, sizeof(uint8_t), false);
 }
 
 void lpLight_bindData8invert(lpLight_t *p, uint8_t *ptr)
 {
-	p->sampleDataFunc = sampleData8invert;
-	p->dataptr = (uint8_t *) ptr;
+	bindDataBits(p, ptr, sizeof(uint8_t), true);
 }
 
 void lpLight_bindData16(lpLight_t *p, uint16_t *ptr)
 {
-	// xyzzy
-	p->sampleDataFunc = sampleData16;
-	p->dataptr = (uint16_t *) ptr;
+	bindDataBits(p, ptr, sizeof(uint16_t), false);
 }
 
 void lpLight_bindDatafv(lpLight_t *p, float *ptr)
@@ -1961,32 +2146,27 @@ void lpLight_bindDatafv(lpLight_t *p, float *ptr)
 
 void lpLight_bindData16invert(lpLight_t *p, uint16_t *ptr)
 {
-	p->sampleDataFunc = sampleData16invert;
-	p->dataptr = (uint16_t *) ptr;
+	bindDataBits(p, ptr, sizeof(uint16_t), true);
 }
 
 void lpLight_bindData32(lpLight_t *p, uint32_t *ptr)
 {
-	p->sampleDataFunc = sampleData32;
-	p->dataptr = (uint32_t *) ptr;
+	bindDataBits(p, ptr, sizeof(uint32_t), false);
 }
 
 void lpLight_bindData32invert(lpLight_t *p, uint32_t *ptr)
 {
-	p->sampleDataFunc = sampleData32invert;
-	p->dataptr = (uint32_t *) ptr;
+	bindDataBits(p, ptr, sizeof(uint32_t), true);
 }
 
 void lpLight_bindData64(lpLight_t *p, uint64_t *ptr)
 {
-	p->sampleDataFunc = sampleData64;
-	p->dataptr = (uint64_t *) ptr;
+	bindDataBits(p, ptr, sizeof(uint64_t), false);
 }
 
 void lpLight_bindData64invert(lpLight_t *p, uint64_t *ptr)
 {
-	p->sampleDataFunc = sampleData64invert;
-	p->dataptr = (uint64_t *) ptr;
+	bindDataBits(p, ptr, sizeof(uint64_t), true);
 }
 
 void lpLight_calcIntensity(lpLight_t *p)
@@ -2016,7 +2196,7 @@ void lpLight_calcIntensity(lpLight_t *p)
 		}
 #endif
 
-	p->start_clock = *p->simclock;
+	p->start_clock = p->old_clock;
 	p->on_time = 0;
 	p->dirty = false;
 
@@ -39,6 +39,8 @@
 #endif /* !WANT_SDL */
 
 #define LP_MAX_LIGHT_GROUPS 10
+#define LP_MAX_SOURCES	16	// max. number of data words bound to lights
+#define LP_SAMPLE_SLOTS	8192	// samples buffered between two frames (power of 2)
 
 // forward references
 
@@ -92,6 +94,29 @@ typedef struct lp_light_group {
 		*list;
 } lp_light_group_t;
 
+// data word bound to lights, all lights of a word are integrated together
+
+typedef struct lp_source {
+	void		*ptr;		// bound data word
+	int		size,		// size of the word in bytes
+			group;		// light group of its lights, -1 if none
+	bool		sampled;	// sampled since the last frame
+	uint64_t	value,		// last sampled value
+			old_clock,	// clock of the last sample
+			span,		// clock ticks sampled since the last frame
+			measured,	// of these the ticks not after dropped samples
+			on_time[64];	// ticks each bit was set in the measured time
+} lp_source_t;
+
+// snapshot of all bound data words, written by the simulation thread
+
+typedef struct lp_sample {
+	uint64_t	clock;
+	int		group;		// light group sampled, -1 if all lights
+	bool		gap;		// samples were dropped before this one
+	uint64_t	value[LP_MAX_SOURCES];
+} lp_sample_t;
+
 #include "lp_gfx.h"
 #include "lp_switch.h"
 
@@ -109,6 +134,21 @@ typedef struct Lpanel {
 
 	lp_light_group_t light_groups[LP_MAX_LIGHT_GROUPS];
 
+	lp_source_t	sources[LP_MAX_SOURCES];
+	int		num_sources;
+
+	lp_sample_t	*samples;	// ring buffer of LP_SAMPLE_SLOTS samples
+	unsigned int	sample_head,	// next slot written by the simulation
+			sample_tail;	// next slot integrated by the renderer
+	bool		sample_gap;	// ring was full, samples dropped
+
+	struct lpLight	**gfx_lights;	// lights drawn from the vertex arrays
+	int		num_gfx_lights;
+	GLfloat		*light_verts,	// inner and outer circle of every light
+			*light_colors;
+	GLuint		*light_index;	// triangles of all lights
+	int		num_light_index;
+
 	lpSwitch_t	**switches;
 
 	int		num_switches,
@@ -233,7 +273,9 @@ extern void		Lpanel_bindPowerFlag(Lpanel_t *p, uint8_t *addr);
 extern void		Lpanel_bindSimclock(Lpanel_t *p, uint64_t *addr);
 extern void		Lpanel_bindRunFlag(Lpanel_t *p, uint8_t *addr);
 
+extern int		Lpanel_addSource(Lpanel_t *p, void *ptr, int size, int group);
 extern void		Lpanel_draw(Lpanel_t *p);
+extern void		Lpanel_releaseGraphics(Lpanel_t *p);
 extern struct lpLight	*Lpanel_findLightByName(Lpanel_t *p, char *name);
 extern lpObject_t	*Lpanel_findObjectByName(Lpanel_t *p, char *name);
 
@@ -241,6 +283,7 @@ extern void		Lpanel_framerate_set(Lpanel_t *p, float n);
 extern void		Lpanel_ignoreBindErrors(Lpanel_t *p, bool f);
 extern void		Lpanel_printLights(Lpanel_t *p);
 extern bool		Lpanel_readConfig(Lpanel_t *p, const char *fname);
+extern void		Lpanel_integrateSamples(Lpanel_t *p);
 extern void		Lpanel_sampleData(Lpanel_t *p);
 extern void		Lpanel_sampleDataWarp(Lpanel_t *p, int clockwarp);
 extern void		Lpanel_sampleLightGroup(Lpanel_t *p, int groupnum, int clockval);
@@ -329,6 +372,8 @@ typedef struct lpLight {
 	void		*dataptr;	// pointer to data to sample
 	int		datatype;	// datatype dataptr points to
 	int		bitnum;		// bit in data controlling this light
+	int		source;		// index of the panel's data word, -1 if none
+	bool		invert;		// light is on if the bit is 0
 
 	char		*obj_refname;	// name of object if this light references one.
 	lpObject_t	*obj_ref;	// pointer to object if this light references one.
@@ -379,6 +424,7 @@ extern void		lpLight_bindSimclock(lpLight_t *p, uint64_t *addr, int *clockwarp);
 
 extern void		lpLight_calcIntensity(lpLight_t *p);
 extern void		lpLight_draw(lpLight_t *p);
+extern void		lpLight_update(lpLight_t *p);
 extern void		lpLight_print(lpLight_t *p);
 
 extern void		lpLight_setupData(lpLight_t *p);
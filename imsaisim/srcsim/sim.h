@@ -55,6 +55,7 @@
 
 #define UNIX_TERMINAL	/* uses a UNIX terminal emulation */
 #define HAS_DAZZLER	/* has simulated I/O for Cromemeco Dazzler */
+#define HAS_VIDCAP	/* headless video capture (option -V) */
 /*#define HAS_CYCLOPS*/	/* has simulated I/O for Cromemeco 88 CCC/ACC Cyclops Camera */
 
 #define HAS_DISKS	/* uses disk images */
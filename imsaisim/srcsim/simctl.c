@@ -32,6 +32,8 @@
  * 14-AUG-2020 allow building machine without frontpanel
  * 29-APR-2024 added CPU execution statistics
  * 04-JAN-2025 add SDL2 support
+ * 18-OCT-2026 hold buffered stdin of the SIO HAL while ICE runs
+ * 18-OCT-2026 sample the bus for the front panel at a bounded rate
  */
 
 #include <stdio.h>
@@ -48,6 +50,7 @@
 #include "simport.h"
 #ifdef WANT_ICE
 #include "simice.h"
+#include "imsai-hal.h"
 #endif
 #include "simctl.h"
 
@@ -74,6 +77,9 @@ static const char *TAG = "system";
 #define CPUSW_STEP	2	/* single step */
 #define CPUSW_STEPCYCLE	3	/* machine cycle step */
 
+int fp_sample_count = 1;	/* memory cycles until the next bus sample */
+WORD fp_sample_seed = 0xace1;	/* LFSR for the distance of the bus samples */
+
 static BYTE fp_led_wait;
 static int cpu_switch;
 static int reset;
@@ -97,6 +103,26 @@ static win_funcs_t fp_win_funcs = {
 #endif
 #endif /* FRONTPANEL */
 
+#ifdef WANT_ICE
+/*
+ *	give the terminal to the machine
+ */
+static void ice_go(void)
+{
+	set_unix_terminal();
+	hal_stdio_hold(false);
+}
+
+/*
+ *	give the terminal back to ICE
+ */
+static void ice_break(void)
+{
+	hal_stdio_hold(true);
+	reset_unix_terminal();
+}
+#endif
+
 /*
  *	This function initializes the front panel and terminal.
  *	Then the machine waits to be operated from the front panel,
@@ -222,8 +248,8 @@ void mon(void)
 	} else {
 #endif /* FRONTPANEL */
 #ifdef WANT_ICE
-		ice_before_go = set_unix_terminal;
-		ice_after_go = reset_unix_terminal;
+		ice_before_go = ice_go;
+		ice_after_go = ice_break;
 		atexit(reset_unix_terminal);
 
 		ice_cmd_loop(0);
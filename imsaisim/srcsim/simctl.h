@@ -10,6 +10,13 @@
 #include "sim.h"
 #include "simdefs.h"
 
+#ifdef FRONTPANEL
+#define FP_SAMPLE_MASK	15	/* max. memory cycles between bus samples - 1 */
+
+extern int fp_sample_count;		/* memory cycles until the next sample */
+extern WORD fp_sample_seed;		/* LFSR for the distance of the samples */
+#endif
+
 extern void mon(void);
 
 extern bool wait_step(void);
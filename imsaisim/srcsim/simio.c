@@ -38,6 +38,8 @@
  * 05-AUG-2021 add boot config for machine without frontpanel
  * 07-AUG-2021 add APU emulation
  * 27-MAY-2024 moved io_in & io_out to simcore
+ * 18-OCT-2026 create SIO2 socket before the HAL is initialized
+ * 18-OCT-2026 close the SIO2 socket connection through the HAL on exit
  */
 
 #include <unistd.h>
@@ -298,11 +300,11 @@ void init_io(void)
 	am9511 = am_create(AM_STATUS, AM_DATA);
 #endif
 
+	/* create local socket for SIO's, the HAL accepts connections */
+	init_unix_server_socket(&ucons[0], "imsaisim.sio2");
+
 	hal_reset();
 	lpt_reset();
-
-	/* create local socket for SIO's */
-	init_unix_server_socket(&ucons[0], "imsaisim.sio2");
 }
 
 /*
@@ -311,17 +313,12 @@ void init_io(void)
  */
 void exit_io(void)
 {
-	register int i;
-
 	/* close line printer file */
 	if (printer != 0)
 		close(printer);
 
 	/* close network connections */
-	for (i = 0; i < NUMUSOC; i++) {
-		if (ucons[i].ssc)
-			close(ucons[i].ssc);
-	}
+	hal_hangup();
 
 #ifdef HAS_DAZZLER
 	/* shutdown DAZZLER */
@@ -9,6 +9,7 @@
  * History:
  * 03-JUN-2024 first version
  * 14-DEC-2024 added hardware breakpoint support
+ * 18-OCT-2026 TCPASYNC removed, the TTY socket is read by a thread
  */
 
 #ifndef SIM_INC
@@ -45,7 +46,6 @@
 #define HAS_ISBC206	/* has iSBC 206 hard disk controller */
 
 #define NUMNSOC 1	/* one TCP/IP socket for TTY */
-#define TCPASYNC	/* use async I/O if possible */
 #define SERVERPORT 4010	/* first TCP/IP server port used */
 #define NUMUSOC 1	/* one UNIX socket for PTR/PTP */
 
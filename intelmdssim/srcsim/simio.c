@@ -12,6 +12,7 @@
  * 03-JUN-2024 first version
  * 07-JUN-2024 rewrite of the monitor ports and the timing thread
  * 09-JUN-2024 add hwctl and simbdos ports
+ * 18-OCT-2026 TTY connection accepted by the hostin input thread, no SIGIO
  */
 
 #include <stdlib.h>
@@ -185,19 +186,13 @@ void init_io(void)
 	isbc206_reset();	/* reset iSBC 206 disk controller */
 #endif
 
-	/* initialize TCP/IP networking */
-#ifdef TCPASYNC
-	newact.sa_handler = sigio_tcp_server_socket;
-	sigemptyset(&newact.sa_mask);
-	newact.sa_flags = 0;
-	sigaction(SIGIO, &newact, NULL);
-#endif
-
+	/* initialize TCP/IP networking, the TTY accepts connections */
 	for (i = 0; i < NUMNSOC; i++) {
 		ncons[i].port = SERVERPORT + i;
 		ncons[i].telnet = 1;
 		init_tcp_server_socket(&ncons[i]);
 	}
+	mon_init();
 
 	/* create local socket for PTR/PTP */
 	init_unix_server_socket(&ucons[0], "intelmdssim.pt");
@@ -237,10 +232,7 @@ void exit_io(void)
 		close(lpt_fd);
 
 	/* close network connections */
-	for (i = 0; i < NUMNSOC; i++) {
-		if (ncons[i].ssc)
-			close(ncons[i].ssc);
-	}
+	mon_exit();
 	for (i = 0; i < NUMUSOC; i++) {
 		if (ucons[i].ssc)
 			close(ucons[i].ssc);
@@ -519,11 +511,6 @@ static void interrupt(int sig)
 
 	counter++;
 
-#ifndef TCPASYNC
-	/* poll TCP sockets if SIGIO not working */
-	sigio_tcp_server_socket(0);
-#endif
-
 	/* check disk image files each second */
 #ifdef HAS_ISBC201
 	if ((counter % 100) == 0)
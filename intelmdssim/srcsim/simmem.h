@@ -10,11 +10,14 @@
  * History:
  * 03-JUN-2024 first version
  * 14-DEC-2024 added hardware breakpoint support
+ * 18-OCT-2026 add block functions for direct memory access
  */
 
 #ifndef SIMMEM_INC
 #define SIMMEM_INC
 
+#include <string.h>
+
 #include "sim.h"
 #include "simdefs.h"
 #ifdef WANT_ICE
@@ -99,6 +102,44 @@ static inline BYTE dma_read(WORD addr)
 		return memory[addr];
 }
 
+/*
+ *	Block memory access for DMA devices, the transfer is split at page
+ *	boundaries and each page is copied with memcpy()
+ */
+static inline void dma_write_block(WORD addr, const BYTE *buf, int len)
+{
+	register int n;
+
+	while (len > 0) {
+		n = 256 - (addr & 0xff);
+		if (n > len)
+			n = len;
+		if (!mon_enabled || addr < 65536 - MON_SIZE)
+			memcpy(&memory[addr], buf, n);
+		addr += n;
+		buf += n;
+		len -= n;
+	}
+}
+
+static inline void dma_read_block(WORD addr, BYTE *buf, int len)
+{
+	register int n;
+
+	while (len > 0) {
+		n = 256 - (addr & 0xff);
+		if (n > len)
+			n = len;
+		if (boot_switch && addr < BOOT_SIZE)
+			memcpy(buf, &boot_rom[addr], n);
+		else
+			memcpy(buf, &memory[addr], n);
+		addr += n;
+		buf += n;
+		len -= n;
+	}
+}
+
 /*
  *	Direct memory access for simulation frame, video logic, etc.
  */
@@ -23,6 +23,7 @@
  * 15-JUL-2018 use logging
  * 24-NOV-2019 configurable baud rate for second channel
  * 19-JUL-2020 avoid problems with some third party terminal emulations
+ * 18-OCT-2026 measure character time in CPU T-states
  */
 
 #include <unistd.h>
@@ -37,9 +38,9 @@
 #include "sim.h"
 #include "simdefs.h"
 #include "simglb.h"
-#include "simport.h"
 #include "simio.h"
 
+#include "baudpace.h"
 #include "unix_terminal.h"
 #include "unix_network.h"
 #include "altair-88-2sio.h"
@@ -47,14 +48,12 @@
 #include "log.h"
 static const char *TAG = "2SIO";
 
-#define BAUDTIME 10000000
-
 bool sio1_upper_case;
 bool sio1_strip_parity;
 bool sio1_drop_nulls;
 int sio1_baud_rate = 115200;
 
-static uint64_t sio1_t1, sio1_t2;
+static Tstates_t sio1_t1;
 static BYTE sio1_stat;
 
 bool sio2_upper_case;
@@ -62,7 +61,7 @@ bool sio2_strip_parity;
 bool sio2_drop_nulls;
 int sio2_baud_rate = 115200;
 
-static uint64_t sio2_t1, sio2_t2;
+static Tstates_t sio2_t1;
 static BYTE sio2_stat;
 
 /*
@@ -70,7 +69,7 @@ static BYTE sio2_stat;
  */
 void altair_2sio_reset(void)
 {
-	sio1_t1 = sio2_t1 = get_clock_us();
+	sio1_t1 = sio2_t1 = T;
 }
 
 /*
@@ -83,9 +82,7 @@ BYTE altair_sio1_status_in(void)
 {
 	struct pollfd p[1];
 
-	sio1_t2 = get_clock_us();
-	if (sio1_baud_rate > 0 &&
-	    (int) (sio1_t2 - sio1_t1) < BAUDTIME / sio1_baud_rate)
+	if (baud_busy(sio1_t1, sio1_baud_rate))
 		return sio1_stat;
 
 	p[0].fd = fileno(stdin);
@@ -101,7 +98,7 @@ BYTE altair_sio1_status_in(void)
 	}
 	sio1_stat |= 2;
 
-	sio1_t1 = get_clock_us();
+	sio1_t1 = T;
 
 	return sio1_stat;
 }
@@ -143,7 +140,7 @@ again:
 		goto again;
 	}
 
-	sio1_t1 = get_clock_us();
+	sio1_t1 = T;
 	sio1_stat &= 0b11111110;
 
 	/* process read data */
@@ -179,7 +176,7 @@ again:
 		}
 	}
 
-	sio1_t1 = get_clock_us();
+	sio1_t1 = T;
 	sio1_stat &= 0b11111101;
 }
 
@@ -209,9 +206,7 @@ BYTE altair_sio2_status_in(void)
 		}
 	}
 
-	sio2_t2 = get_clock_us();
-	if (sio2_baud_rate > 0 &&
-	    (int) (sio2_t2 - sio2_t1) < BAUDTIME / sio2_baud_rate)
+	if (baud_busy(sio2_t1, sio2_baud_rate))
 		return sio2_stat;
 
 	/* if socket is connected check for I/O */
@@ -226,7 +221,7 @@ BYTE altair_sio2_status_in(void)
 			sio2_stat |= 2;
 	}
 
-	sio2_t1 = get_clock_us();
+	sio2_t1 = T;
 
 	return sio2_stat;
 }
@@ -270,7 +265,7 @@ BYTE altair_sio2_data_in(void)
 		return last;
 	}
 
-	sio2_t1 = get_clock_us();
+	sio2_t1 = T;
 	sio2_stat &= 0b11111110;
 
 	/* process read data */
@@ -322,6 +317,6 @@ again:
 		}
 	}
 
-	sio2_t1 = get_clock_us();
+	sio2_t1 = T;
 	sio2_stat &= 0b11111101;
 }
@@ -10,6 +10,7 @@
  * History:
  * 10-AUG-2018 first version, runs CP/M 1.4 & 2.2 & disk BASIC
  * 02-DEC-2019 use disk names different from Tarbell controller
+ * 18-OCT-2026 collect disk I/O statistics
  */
 
 #include <pthread.h>
@@ -26,6 +27,7 @@
 #include "simport.h"
 
 #include "altair-88-dcdd.h"
+#include "diskstats.h"
 
 /* #define LOG_LOCAL_LEVEL LOG_DEBUG */
 #include "log.h"
@@ -69,6 +71,24 @@ static char fn[MAX_LFN];	/* path/filename for disk image */
 static int fd;			/* fd for disk file i/o */
 static int dcnt;		/* data counter read/write */
 static BYTE buf[SEC_SZ];	/* buffer for one sector */
+static diskstats_t dstat[16] = {	/* disk I/O statistics */
+	DISKSTATS_INIT("88-DCDD", "mits_a.dsk"),
+	DISKSTATS_INIT("88-DCDD", "mits_b.dsk"),
+	DISKSTATS_INIT("88-DCDD", "mits_c.dsk"),
+	DISKSTATS_INIT("88-DCDD", "mits_d.dsk"),
+	DISKSTATS_INIT("88-DCDD", "mits_e.dsk"),
+	DISKSTATS_INIT("88-DCDD", "mits_f.dsk"),
+	DISKSTATS_INIT("88-DCDD", "mits_g.dsk"),
+	DISKSTATS_INIT("88-DCDD", "mits_h.dsk"),
+	DISKSTATS_INIT("88-DCDD", "mits_i.dsk"),
+	DISKSTATS_INIT("88-DCDD", "mits_j.dsk"),
+	DISKSTATS_INIT("88-DCDD", "mits_k.dsk"),
+	DISKSTATS_INIT("88-DCDD", "mits_l.dsk"),
+	DISKSTATS_INIT("88-DCDD", "mits_m.dsk"),
+	DISKSTATS_INIT("88-DCDD", "mits_n.dsk"),
+	DISKSTATS_INIT("88-DCDD", "mits_o.dsk"),
+	DISKSTATS_INIT("88-DCDD", "mits_p.dsk")
+};
 
 static int cnt_sec;		/* counter for sector position */
 static int cnt_head;		/* counter for loading head */
@@ -408,6 +428,8 @@ BYTE altair_dsk_sec_in(void)
 void altair_dsk_data_out(BYTE data)
 {
 	off_t pos;
+	uint64_t t0;
+	bool ok;
 
 	/* don't write past buffer */
 	if (dcnt >= SEC_SZ)
@@ -425,6 +447,8 @@ void altair_dsk_data_out(BYTE data)
 			return;
 		}
 		/* write sector */
+		t0 = diskstats_start();
+		ok = false;
 		pos = (track[disk] * SPT + rwsec) * SEC_SZ;
 		if (lseek(fd, pos, SEEK_SET) != pos) {
 			LOGE(TAG, "can't seek to sector %d track %d",
@@ -432,7 +456,10 @@ void altair_dsk_data_out(BYTE data)
 		} else if (write(fd, buf, SEC_SZ) != SEC_SZ) {
 			LOGE(TAG, "can't write sector %d track %d",
 			     rwsec, track[disk]);
-		}
+		} else
+			ok = true;
+		diskstats_io(&dstat[disk], true, track[disk], pos, SEC_SZ,
+			     t0, ok);
 		close(fd);
 		LOGD(TAG, "write sector %d track %d", rwsec, track[disk]);
 	}
@@ -445,6 +472,8 @@ BYTE altair_dsk_data_in(void)
 {
 	BYTE data;
 	off_t pos;
+	uint64_t t0;
+	bool ok;
 
 	/* first byte? */
 	if (dcnt == 0) {
@@ -454,6 +483,8 @@ BYTE altair_dsk_data_in(void)
 			memset(buf, 0xff, SEC_SZ);
 		} else {
 			/* read sector */
+			t0 = diskstats_start();
+			ok = false;
 			pos = (track[disk] * SPT + rwsec) * SEC_SZ;
 			if (lseek(fd, pos, SEEK_SET) != pos) {
 				LOGE(TAG, "can't seek to sector %d track %d",
@@ -461,7 +492,10 @@ BYTE altair_dsk_data_in(void)
 			} else if (read(fd, buf, SEC_SZ) != SEC_SZ) {
 				LOGE(TAG, "can't read sector %d track %d",
 				     rwsec, track[disk]);
-			}
+			} else
+				ok = true;
+			diskstats_io(&dstat[disk], false, track[disk], pos,
+				     SEC_SZ, t0, ok);
 			close(fd);
 			LOGD(TAG, "read sector %d track %d", rwsec, track[disk]);
 		}
@@ -20,6 +20,7 @@
  * 15-JUL-2018 use logging
  * 24-NOV-2019 configurable baud rate for tape SIO
  * 19-JUL-2020 avoid problems with some third party terminal emulations
+ * 18-OCT-2026 measure character time in CPU T-states
  */
 
 #include <unistd.h>
@@ -34,9 +35,9 @@
 #include "sim.h"
 #include "simdefs.h"
 #include "simglb.h"
-#include "simport.h"
 #include "simio.h"
 
+#include "baudpace.h"
 #include "unix_terminal.h"
 #include "unix_network.h"
 #include "altair-88-sio.h"
@@ -44,20 +45,18 @@
 #include "log.h"
 static const char *TAG = "SIO";
 
-#define BAUDTIME 10000000
-
 bool sio0_upper_case;
 bool sio0_strip_parity;
 bool sio0_drop_nulls;
 int sio0_revision;
 int sio0_baud_rate = 115200;
 
-static uint64_t sio0_t1, sio0_t2;
+static Tstates_t sio0_t1;
 static BYTE sio0_stat;
 
 int sio3_baud_rate = 1200;
 
-static uint64_t sio3_t1, sio3_t2;
+static Tstates_t sio3_t1;
 static BYTE sio3_stat = 0x81;
 
 /*
@@ -65,7 +64,7 @@ static BYTE sio3_stat = 0x81;
  */
 void altair_sio_reset(void)
 {
-	sio0_t1 = sio3_t1 = get_clock_us();
+	sio0_t1 = sio3_t1 = T;
 }
 
 /*
@@ -88,9 +87,7 @@ BYTE altair_sio0_status_in(void)
 	else
 		sio0_stat = 0x81;
 
-	sio0_t2 = get_clock_us();
-	if (sio0_baud_rate > 0 &&
-	    (int) (sio0_t2 - sio0_t1) < BAUDTIME / sio0_baud_rate)
+	if (baud_busy(sio0_t1, sio0_baud_rate))
 		return sio0_stat;
 
 	p[0].fd = fileno(stdin);
@@ -113,7 +110,7 @@ BYTE altair_sio0_status_in(void)
 	else
 		sio0_stat &= ~128;
 
-	sio0_t1 = get_clock_us();
+	sio0_t1 = T;
 
 	return sio0_stat;
 }
@@ -155,7 +152,7 @@ again:
 		goto again;
 	}
 
-	sio0_t1 = get_clock_us();
+	sio0_t1 = T;
 	if (sio0_revision == 0)
 		sio0_stat &= 0b11011111;
 	else
@@ -194,7 +191,7 @@ again:
 		}
 	}
 
-	sio0_t1 = get_clock_us();
+	sio0_t1 = T;
 	if (sio0_revision == 0)
 		sio0_stat &= 0b11111101;
 	else
@@ -229,9 +226,7 @@ BYTE altair_sio3_status_in(void)
 		}
 	}
 
-	sio3_t2 = get_clock_us();
-	if (sio3_baud_rate > 0 &&
-	    (int) (sio3_t2 - sio3_t1) < BAUDTIME / sio3_baud_rate)
+	if (baud_busy(sio3_t1, sio3_baud_rate))
 		return sio3_stat;
 
 	/* if socket is connected check for I/O */
@@ -246,7 +241,7 @@ BYTE altair_sio3_status_in(void)
 			sio3_stat &= ~128;
 	}
 
-	sio3_t1 = get_clock_us();
+	sio3_t1 = T;
 
 	return sio3_stat;
 }
@@ -287,7 +282,7 @@ BYTE altair_sio3_data_in(void)
 		return last;
 	}
 
-	sio3_t1 = get_clock_us();
+	sio3_t1 = T;
 	sio3_stat |= 0b00000001;
 
 	/* process read data */
@@ -327,6 +322,6 @@ again:
 		}
 	}
 
-	sio3_t1 = get_clock_us();
+	sio3_t1 = T;
 	sio3_stat |= 0b10000000;
 }
@@ -0,0 +1,308 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Common I/O devices used by various simulated machines
+ *
+ * This module implements a scripted console for batch jobs. The
+ * script is a text file with one command per line:
+ *
+ *	# comment
+ *	timeout <T-states>	stop the CPU after this many T-states
+ *	steptimeout <T-states>	stop the CPU if a step takes this long
+ *	expect <text>		wait until the console output contains text
+ *	send <text>		type text on the console
+ *
+ * Text starts after the blanks following the command and ends at the
+ * end of the line. It may contain the escapes \r, \n, \t, \e, \\ and
+ * \xNN, lines typed for CP/M end with \r. The commands expect and send
+ * are processed in order. The text of a send is offered to the guest
+ * as soon as it polls the console, so no time passes with waiting for
+ * a user. If the guest reads console input while the script expects
+ * output or after the last command, the job failed and the CPU stops.
+ * A guest that never reads the console, e.g. it only polls the status,
+ * is stopped when a step, or the time after the last one, takes more
+ * than steptimeout T-states, STEP_TSTATES if the script doesn't set it.
+ *
+ * History:
+ * 18-OCT-2026 first version
+ * 18-OCT-2026 check timeout values, limit the T-states of each step
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+
+#include "sim.h"
+#include "simdefs.h"
+#include "simglb.h"
+
+#include "batch.h"
+
+/* #define LOG_LOCAL_LEVEL LOG_DEBUG */
+#include "log.h"
+static const char *TAG = "batch";
+
+#define MAXTEXT	256		/* max. length of a text */
+#define STEP_TSTATES 10000000000ULL /* default T-states limit of a step */
+
+enum { EXPECT, SEND };
+
+typedef struct step {
+	int cmd;		/* EXPECT or SEND */
+	int line;		/* line number in the script */
+	size_t len;		/* length of text */
+	BYTE text[MAXTEXT];
+} step_t;
+
+static step_t *steps;		/* the script */
+static int nsteps;		/* number of steps */
+static int cur;			/* step in progress */
+static size_t sent;		/* bytes of a send taken by the guest */
+static BYTE win[MAXTEXT];	/* last console output for an expect */
+static size_t wlen;		/* bytes in win */
+static int exit_code;		/* exit status written by the guest */
+static Tstates_t job_tlimit;	/* T-states limit of the job, 0 = none */
+static Tstates_t step_tlimit = STEP_TSTATES; /* T-states limit of a step */
+
+/*
+ * decode the T-states count s, returns false unless it is a number > 0
+ */
+static bool parse_tstates(const char *s, Tstates_t *t)
+{
+	unsigned long long n;
+	char *e;
+
+	if (!isdigit((unsigned char) *s))
+		return false;
+	errno = 0;
+	n = strtoull(s, &e, 0);
+	e += strspn(e, " \t");
+	if (errno != 0 || *e != '\0' || n == 0)
+		return false;
+	*t = n;
+	return true;
+}
+
+/*
+ * let the CPU stop when the step in progress or the job ran too long
+ */
+static void set_tlimit(void)
+{
+	Tstates_t t = T + step_tlimit;
+
+	if (job_tlimit && job_tlimit < t)
+		t = job_tlimit;
+	b_tlimit = t;
+}
+
+/*
+ * decode the text s of a command into step st
+ */
+static bool parse_text(char *s, step_t *st)
+{
+	char *e;
+	int c;
+
+	st->len = 0;
+	while (*s != '\0') {
+		if (st->len == MAXTEXT)
+			return false;
+		c = *s++;
+		if (c == '\\') {
+			switch (c = *s++) {
+			case 'r':
+				c = '\r';
+				break;
+			case 'n':
+				c = '\n';
+				break;
+			case 't':
+				c = '\t';
+				break;
+			case 'e':
+				c = 0x1b;
+				break;
+			case '\\':
+				break;
+			case 'x':
+				c = (int) strtol(s, &e, 16);
+				if (e == s || e - s > 2)
+					return false;
+				s = e;
+				break;
+			default:
+				return false;
+			}
+		}
+		st->text[st->len++] = (BYTE) c;
+	}
+
+	return st->len > 0;
+}
+
+/*
+ * go on with the next step of the script
+ */
+static void next_step(void)
+{
+	cur++;
+	sent = 0;
+	wlen = 0;
+	set_tlimit();
+	if (cur < nsteps)
+		LOGD(TAG, "line %d", steps[cur].line);
+}
+
+/*
+ * read the script from file fn, returns false on errors
+ */
+bool batch_init(const char *fn)
+{
+	FILE *fp;
+	char buf[2 * MAXTEXT], *s, *t;
+	step_t *st;
+	int line = 0;
+
+	if ((fp = fopen(fn, "r")) == NULL) {
+		LOGE(TAG, "can't open batch script %s", fn);
+		return false;
+	}
+
+	while (fgets(buf, sizeof(buf), fp) != NULL) {
+		line++;
+		buf[strcspn(buf, "\r\n")] = '\0';
+		s = buf + strspn(buf, " \t");
+		if (*s == '\0' || *s == '#')
+			continue;
+		t = s + strcspn(s, " \t");
+		if (*t != '\0') {
+			*t++ = '\0';
+			t += strspn(t, " \t");
+		}
+
+		if (!strcmp(s, "timeout") || !strcmp(s, "steptimeout")) {
+			if (!parse_tstates(t, (*s == 't') ? &job_tlimit
+						       : &step_tlimit)) {
+				LOGE(TAG, "%s line %d: invalid T-states %s",
+				     fn, line, t);
+				fclose(fp);
+				return false;
+			}
+			continue;
+		}
+
+		if ((st = realloc(steps, (nsteps + 1) * sizeof(step_t)))
+		    == NULL) {
+			LOGE(TAG, "can't allocate batch script");
+			fclose(fp);
+			return false;
+		}
+		steps = st;
+		st = &steps[nsteps];
+		st->line = line;
+		if (!strcmp(s, "expect"))
+			st->cmd = EXPECT;
+		else if (!strcmp(s, "send"))
+			st->cmd = SEND;
+		else {
+			LOGE(TAG, "%s line %d: unknown command %s",
+			     fn, line, s);
+			fclose(fp);
+			return false;
+		}
+		if (!parse_text(t, st)) {
+			LOGE(TAG, "%s line %d: invalid text", fn, line);
+			fclose(fp);
+			return false;
+		}
+		nsteps++;
+	}
+	fclose(fp);
+	set_tlimit();
+
+	return true;
+}
+
+/*
+ * true if the script has input for the guest right now
+ */
+bool batch_ready(void)
+{
+	return cur < nsteps && steps[cur].cmd == SEND;
+}
+
+/*
+ * get the next byte of input for the guest, if there is none
+ * the job failed and the CPU is stopped, then -1 is returned
+ */
+int batch_get(void)
+{
+	BYTE c;
+
+	if (!batch_ready()) {
+		if (cur < nsteps)
+			LOGE(TAG, "console input wanted, but script line %d "
+			     "expects output", steps[cur].line);
+		else
+			LOGE(TAG, "console input wanted after end of script");
+		cpu_error = IOERROR;
+		cpu_state = ST_STOPPED;
+		return -1;
+	}
+
+	c = steps[cur].text[sent++];
+	if (sent == steps[cur].len)
+		next_step();
+	return c;
+}
+
+/*
+ * match console output of the guest with the expected text
+ */
+void batch_put(BYTE data)
+{
+	step_t *st;
+
+	if (cur >= nsteps || steps[cur].cmd != EXPECT)
+		return;
+
+	st = &steps[cur];
+	if (wlen == MAXTEXT) {
+		memmove(win, win + 1, MAXTEXT - 1);
+		wlen--;
+	}
+	win[wlen++] = data;
+	if (wlen >= st->len && !memcmp(win + wlen - st->len, st->text, st->len))
+		next_step();
+}
+
+/*
+ * the guest halted the machine with exit status code
+ */
+void batch_exit(int code)
+{
+	exit_code = code;
+}
+
+/*
+ * exit status of the job after the CPU stopped
+ */
+int batch_status(void)
+{
+	switch (cpu_error) {
+	case NONE:
+	case IOHALT:
+		return exit_code;
+	case TSLIMIT:
+		if (cur < nsteps)
+			LOGE(TAG, "timeout at script line %d",
+			     steps[cur].line);
+		else
+			LOGE(TAG, "timeout after end of script");
+		return BATCH_TIMEOUT;
+	default:
+		return BATCH_ERROR;
+	}
+}
@@ -0,0 +1,29 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Common I/O devices used by various simulated machines
+ *
+ * This module implements a scripted console for running a machine
+ * in batch mode without a terminal, see batch.c for details.
+ *
+ * History:
+ * 18-OCT-2026 first version
+ */
+
+#ifndef BATCH_INC
+#define BATCH_INC
+
+#include "sim.h"
+#include "simdefs.h"
+
+#define BATCH_TIMEOUT	124	/* exit status if the T-state limit hit */
+#define BATCH_ERROR	125	/* exit status if the job failed otherwise */
+
+extern bool batch_init(const char *fn);
+extern bool batch_ready(void);
+extern int batch_get(void);
+extern void batch_put(BYTE data);
+extern void batch_exit(int code);
+extern int batch_status(void);
+
+#endif /* !BATCH_INC */
@@ -0,0 +1,47 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Common I/O devices used by various simulated machines
+ *
+ * This module implements character time pacing for serial devices.
+ * The time a character needs on the line at a baud rate is measured
+ * in CPU T-states, so the guest sees the same UART timing whatever
+ * speed the host runs the CPU at. A device remembers the T-state
+ * count when a character was sent or received and reports the
+ * transmitter or receiver busy until the character time passed.
+ *
+ * History:
+ * 18-OCT-2026 first version
+ */
+
+#ifndef BAUDPACE_INC
+#define BAUDPACE_INC
+
+#include "sim.h"
+#include "simdefs.h"
+#include "simglb.h"
+
+#define BAUD_BITS	10	/* bits per character: start, 8 data, stop */
+#define BAUD_MHZ	4	/* CPU clock used if the CPU runs unlimited */
+
+/*
+ * T-states needed to transfer one character at baud, 0 if unlimited
+ */
+static inline Tstates_t baud_tstates(int baud)
+{
+	if (baud <= 0)
+		return 0;
+
+	return (Tstates_t) (f_value ? f_value : BAUD_MHZ) * 1000000 *
+	       BAUD_BITS / baud;
+}
+
+/*
+ * true while a character started at T-state t0 is on the line
+ */
+static inline bool baud_busy(Tstates_t t0, int baud)
+{
+	return baud > 0 && T - t0 < baud_tstates(baud);
+}
+
+#endif /* !BAUDPACE_INC */
@@ -25,10 +25,15 @@
  * 19-JUL-2018 integrate webfrontend
  * 04-NOV-2019 remove fake DMA bus request
  * 04-JAN-2025 add SDL2 support
+ * 18-OCT-2026 render into a frame buffer, only if the DMA window changed
+ * 18-OCT-2026 headless capture of the frames
+ * 18-OCT-2026 delta encoded frames for the web frontend
+ * 18-OCT-2026 copy to the X11 window only if the frame changed
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #ifdef WANT_SDL
 #include <SDL.h>
 #else
@@ -50,8 +55,11 @@
 #ifdef HAS_DAZZLER
 
 #ifdef HAS_NETSERVER
-#include <string.h>
 #include "netsrv.h"
+#include "wsframe.h"
+#endif
+#ifdef HAS_VIDCAP
+#include "vidcap.h"
 #endif
 
 #if !defined(WANT_SDL) || defined(HAS_NETSERVER)
@@ -71,42 +79,7 @@ static int size = WSIZE;
 static int dazzler_win_id = -1;
 static SDL_Window *window;
 static SDL_Renderer *renderer;
-static uint8_t colors[16][3] = {
-	{ 0x00, 0x00, 0x00 },
-	{ 0x80, 0x00, 0x00 },
-	{ 0x00, 0x80, 0x00 },
-	{ 0x80, 0x80, 0x00 },
-	{ 0x00, 0x00, 0x80 },
-	{ 0x80, 0x00, 0x80 },
-	{ 0x00, 0x80, 0x80 },
-	{ 0x80, 0x80, 0x80 },
-	{ 0x00, 0x00, 0x00 },
-	{ 0xFF, 0x00, 0x00 },
-	{ 0x00, 0xFF, 0x00 },
-	{ 0xFF, 0xFF, 0x00 },
-	{ 0x00, 0x00, 0xFF },
-	{ 0xFF, 0x00, 0xFF },
-	{ 0x00, 0xFF, 0xFF },
-	{ 0xFF, 0xFF, 0xFF }
-};
-static uint8_t grays[16][3] = {
-	{ 0x00, 0x00, 0x00 },
-	{ 0x11, 0x11, 0x11 },
-	{ 0x22, 0x22, 0x22 },
-	{ 0x33, 0x33, 0x33 },
-	{ 0x44, 0x44, 0x44 },
-	{ 0x55, 0x55, 0x55 },
-	{ 0x66, 0x66, 0x66 },
-	{ 0x77, 0x77, 0x77 },
-	{ 0x88, 0x88, 0x88 },
-	{ 0x99, 0x99, 0x99 },
-	{ 0xAA, 0xAA, 0xAA },
-	{ 0xBB, 0xBB, 0xBB },
-	{ 0xCC, 0xCC, 0xCC },
-	{ 0xDD, 0xDD, 0xDD },
-	{ 0xEE, 0xEE, 0xEE },
-	{ 0xFF, 0xFF, 0xFF }
-};
+static SDL_Texture *texture;
 #else /* !WANT_SDL */
 static Display *display;
 static Window window;
@@ -114,6 +87,7 @@ static int screen;
 static GC gc;
 static XWindowAttributes wa;
 static Pixmap pixmap;
+static XImage *ximage;
 static Colormap colormap;
 static XColor colors[16];
 static XColor grays[16];
@@ -151,6 +125,44 @@ static char gray14[] =  "#EEEEEE";
 static char gray15[] =  "#FFFFFF";
 #endif /* !WANT_SDL */
 
+/* RGB values of the colors and grays */
+static const uint8_t color_rgb[16][3] = {
+	{ 0x00, 0x00, 0x00 },
+	{ 0x80, 0x00, 0x00 },
+	{ 0x00, 0x80, 0x00 },
+	{ 0x80, 0x80, 0x00 },
+	{ 0x00, 0x00, 0x80 },
+	{ 0x80, 0x00, 0x80 },
+	{ 0x00, 0x80, 0x80 },
+	{ 0x80, 0x80, 0x80 },
+	{ 0x00, 0x00, 0x00 },
+	{ 0xFF, 0x00, 0x00 },
+	{ 0x00, 0xFF, 0x00 },
+	{ 0xFF, 0xFF, 0x00 },
+	{ 0x00, 0x00, 0xFF },
+	{ 0xFF, 0x00, 0xFF },
+	{ 0x00, 0xFF, 0xFF },
+	{ 0xFF, 0xFF, 0xFF }
+};
+static const uint8_t gray_rgb[16][3] = {
+	{ 0x00, 0x00, 0x00 },
+	{ 0x11, 0x11, 0x11 },
+	{ 0x22, 0x22, 0x22 },
+	{ 0x33, 0x33, 0x33 },
+	{ 0x44, 0x44, 0x44 },
+	{ 0x55, 0x55, 0x55 },
+	{ 0x66, 0x66, 0x66 },
+	{ 0x77, 0x77, 0x77 },
+	{ 0x88, 0x88, 0x88 },
+	{ 0x99, 0x99, 0x99 },
+	{ 0xAA, 0xAA, 0xAA },
+	{ 0xBB, 0xBB, 0xBB },
+	{ 0xCC, 0xCC, 0xCC },
+	{ 0xDD, 0xDD, 0xDD },
+	{ 0xEE, 0xEE, 0xEE },
+	{ 0xFF, 0xFF, 0xFF }
+};
+
 /* DAZZLER stuff */
 static bool state;
 static WORD dma_addr;
@@ -165,8 +177,48 @@ static pthread_t thread;
 #ifdef HAS_NETSERVER
 static void ws_clear(void);
 static BYTE formatBuf = 0;
+static wsframe_t wsf;			/* frames for /dazzler-frames */
 #endif
 
+/*
+ * The DMA window is expanded into a frame buffer of 128x128 pixels,
+ * lower resolutions use the upper left 64x64 or 32x32 pixels. Pixels
+ * are copied from lookup tables in blocks of 4 or 2, which compilers
+ * turn into single vector stores, and scaling to the window size is
+ * done by the renderer. Nothing is expanded if the DMA window and the
+ * format didn't change since the last frame.
+ */
+#define FBSIZE 128
+static uint32_t fb[FBSIZE * FBSIZE];	/* frame buffer */
+static int fb_size;			/* pixels per line of the frame */
+static BYTE vram[2048];			/* DMA window of the last frame */
+static int vram_format = -1;		/* format of the last frame */
+static uint32_t color_pix[16];		/* pixel values of the colors */
+static uint32_t gray_pix[16];		/* pixel values of the grays */
+static uint32_t hi_pix[16][4];		/* 4 hires pixels for a nibble */
+static uint32_t lo_pix[256][2];		/* 2 lowres pixels for a byte */
+
+/* get the pixel values of the colors and grays */
+static void init_pixels(void)
+{
+	int i;
+
+	for (i = 0; i < 16; i++) {
+#ifndef WANT_SDL
+		if (display != NULL) {
+			color_pix[i] = colors[i].pixel;
+			gray_pix[i] = grays[i].pixel;
+			continue;
+		}
+#endif
+		/* SDL texture and headless capture are XRGB8888 */
+		color_pix[i] = (color_rgb[i][0] << 16) |
+			       (color_rgb[i][1] << 8) | color_rgb[i][2];
+		gray_pix[i] = (gray_rgb[i][0] << 16) |
+			      (gray_rgb[i][1] << 8) | gray_rgb[i][2];
+	}
+}
+
 /* create the SDL2 or X11 window for DAZZLER display */
 static void open_display(void)
 {
@@ -177,6 +229,9 @@ static void open_display(void)
 				  size, size, 0);
 	renderer = SDL_CreateRenderer(window, -1, (SDL_RENDERER_ACCELERATED |
 						   SDL_RENDERER_PRESENTVSYNC));
+	texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_XRGB8888,
+				    SDL_TEXTUREACCESS_STREAMING,
+				    FBSIZE, FBSIZE);
 #else /* !WANT_SDL */
 	Window rootwindow;
 	XSizeHints *size_hints = XAllocSizeHints();
@@ -201,6 +256,7 @@ static void open_display(void)
 	XFree(size_hints);
 	wm_delete_window = XInternAtom(display, "WM_DELETE_WINDOW", False);
 	XSetWMProtocols(display, window, &wm_delete_window, 1);
+	XSelectInput(display, window, ExposureMask);
 	colormap = DefaultColormap(display, 0);
 	gc = XCreateGC(display, window, 0, NULL);
 	XSetFillStyle(display, gc, FillSolid);
@@ -273,21 +329,33 @@ static void open_display(void)
 	XParseColor(display, colormap, gray15, &grays[15]);
 	XAllocColor(display, colormap, &grays[15]);
 
+	ximage = XCreateImage(display, DefaultVisual(display, screen),
+			      wa.depth, ZPixmap, 0, NULL, size, size, 32, 0);
+	ximage->data = malloc(ximage->bytes_per_line * size);
+	/* force little-endian pixels, Xlib will convert if necessary */
+	ximage->byte_order = LSBFirst;
+
 	XMapWindow(display, window);
 	XUnlockDisplay(display);
 #endif /* !WANT_SDL */
+
+	init_pixels();
+	vram_format = -1;
 }
 
 /* close the SDL or X11 window for DAZZLER display */
 static void close_display(void)
 {
 #ifdef WANT_SDL
+	SDL_DestroyTexture(texture);
+	texture = NULL;
 	SDL_DestroyRenderer(renderer);
 	renderer = NULL;
 	SDL_DestroyWindow(window);
 	window = NULL;
 #else
 	XLockDisplay(display);
+	XDestroyImage(ximage);
 	XFreePixmap(display, pixmap);
 	XFreeGC(display, gc);
 	XUnlockDisplay(display);
@@ -339,295 +407,130 @@ void cromemco_dazzler_off(void)
 }
 
 #ifdef WANT_SDL
-
 /* process SDL event */
 static void process_event(SDL_Event *event)
 {
 	UNUSED(event);
 }
+#endif
 
-static inline void set_fg_color(int i)
-{
-	SDL_SetRenderDrawColor(renderer,
-			       colors[i][0], colors[i][1], colors[i][2],
-			       SDL_ALPHA_OPAQUE);
-}
-
-static inline void set_fg_gray(int i)
-{
-	SDL_SetRenderDrawColor(renderer,
-			       grays[i][0], grays[i][1], grays[i][2],
-			       SDL_ALPHA_OPAQUE);
-}
-
-static inline void fill_rect(int x, int y, int w, int h)
+/* build the pixel lookup tables for a graphics format */
+static void init_tables(BYTE fmt)
 {
-	SDL_Rect r = {x, y, w, h};
-
-	SDL_RenderFillRect(renderer, &r);
+	const uint32_t *pal = (fmt & 16) ? color_pix : gray_pix;
+	int i, j;
+
+	for (i = 0; i < 16; i++)
+		for (j = 0; j < 4; j++)
+			hi_pix[i][j] = (i & (1 << j)) ? pal[fmt & 0x0f]
+						      : color_pix[0];
+	for (i = 0; i < 256; i++) {
+		lo_pix[i][0] = pal[i & 0x0f];
+		lo_pix[i][1] = pal[i >> 4];
+	}
 }
 
-#else /* !WANT_SDL */
-
-static inline void set_fg_color(int i)
+/*
+ * expand 512 bytes of hires memory into the 64x64 pixels at x0, y0,
+ * a byte holds 4x2 pixels: bits 0, 1, 4, 5 upper and 2, 3, 6, 7 lower
+ */
+static void draw_hires(const BYTE *p, int x0, int y0)
 {
-	XSetForeground(display, gc, colors[i].pixel);
+	uint32_t *d;
+	int x, y;
+
+	for (y = y0; y < y0 + 64; y += 2) {
+		d = &fb[y * FBSIZE + x0];
+		for (x = 0; x < 64; x += 4, p++) {
+			memcpy(d + x, hi_pix[(*p & 3) | ((*p >> 2) & 0x0c)],
+			       sizeof(hi_pix[0]));
+			memcpy(d + FBSIZE + x,
+			       hi_pix[((*p >> 2) & 3) | ((*p >> 4) & 0x0c)],
+			       sizeof(hi_pix[0]));
+		}
+	}
 }
 
-static inline void set_fg_gray(int i)
+/*
+ * expand 512 bytes of lowres memory into the 32x32 pixels at x0, y0,
+ * a byte holds 2 pixels: lower nibble left and upper nibble right
+ */
+static void draw_lowres(const BYTE *p, int x0, int y0)
 {
-	XSetForeground(display, gc, grays[i].pixel);
-}
+	uint32_t *d;
+	int x, y;
 
-static inline void fill_rect(int x, int y, int w, int h)
-{
-	XFillRectangle(display, pixmap, gc, x, y, w, h);
+	for (y = y0; y < y0 + 32; y++) {
+		d = &fb[y * FBSIZE + x0];
+		for (x = 0; x < 32; x += 2, p++)
+			memcpy(d + x, lo_pix[*p], sizeof(lo_pix[0]));
+	}
 }
 
-#endif /* !WANT_SDL */
-
-/* draw pixels for one frame in hires */
-static void draw_hires(void)
+/*
+ * expand the DMA window into the frame buffer for one frame,
+ * returns false if nothing changed since the last frame
+ */
+static bool draw_frame(void)
 {
-	int psize, x, y, i;
-	WORD addr = dma_addr;
-
-	/* set color or grayscale from lower nibble in graphics format */
-	i = format & 0x0f;
-	if (format & 16)
-		set_fg_color(i);
-	else
-		set_fg_gray(i);
-	if (format & 32) {	/* 2048 bytes memory */
-		psize = size / 128;	/* size of one pixel for 128x128 */
-		for (y = 0; y < 64; y += 2) {
-			for (x = 0; x < 64;) {
-				i = dma_read(addr);
-				if (i & 1)
-					fill_rect(x * psize, y * psize, psize, psize);
-				if (i & 2)
-					fill_rect((x + 1) * psize, y * psize, psize, psize);
-				if (i & 4)
-					fill_rect(x * psize, (y + 1) * psize, psize, psize);
-				if (i & 8)
-					fill_rect((x + 1) * psize, (y + 1) * psize, psize, psize);
-				if (i & 16)
-					fill_rect((x + 2) * psize, y * psize, psize, psize);
-				if (i & 32)
-					fill_rect((x + 3) * psize, y * psize, psize, psize);
-				if (i & 64)
-					fill_rect((x + 2) * psize, (y + 1) * psize, psize, psize);
-				if (i & 128)
-					fill_rect((x + 3) * psize, (y + 1) * psize, psize, psize);
-				x += 4;
-				addr++;
-			}
-		}
-		for (y = 0; y < 64; y += 2) {
-			for (x = 64; x < 128;) {
-				i = dma_read(addr);
-				if (i & 1)
-					fill_rect(x * psize, y * psize, psize, psize);
-				if (i & 2)
-					fill_rect((x + 1) * psize, y * psize, psize, psize);
-				if (i & 4)
-					fill_rect(x * psize, (y + 1) * psize, psize, psize);
-				if (i & 8)
-					fill_rect((x + 1) * psize, (y + 1) * psize, psize, psize);
-				if (i & 16)
-					fill_rect((x + 2) * psize, y * psize, psize, psize);
-				if (i & 32)
-					fill_rect((x + 3) * psize, y * psize, psize, psize);
-				if (i & 64)
-					fill_rect((x + 2) * psize, (y + 1) * psize, psize, psize);
-				if (i & 128)
-					fill_rect((x + 3) * psize, (y + 1) * psize, psize, psize);
-				x += 4;
-				addr++;
-			}
+	BYTE buf[2048], fmt = format;
+	int len = (fmt & 32) ? 2048 : 512;
+	int n = (fmt & 64) ? 64 : 32;	/* size of a 512 bytes quadrant */
+
+	dma_read_block(dma_addr, buf, len);
+	if (fmt == vram_format && !memcmp(buf, vram, len))
+		return false;
+	if (fmt != vram_format)
+		init_tables(fmt);
+	memcpy(vram, buf, len);
+	vram_format = fmt;
+
+	fb_size = (fmt & 32) ? n * 2 : n;
+	if (fmt & 64) {
+		draw_hires(buf, 0, 0);
+		if (fmt & 32) {
+			draw_hires(buf + 512, 64, 0);
+			draw_hires(buf + 1024, 0, 64);
+			draw_hires(buf + 1536, 64, 64);
 		}
-		for (y = 64; y < 128; y += 2) {
-			for (x = 0; x < 64;) {
-				i = dma_read(addr);
-				if (i & 1)
-					fill_rect(x * psize, y * psize, psize, psize);
-				if (i & 2)
-					fill_rect((x + 1) * psize, y * psize, psize, psize);
-				if (i & 4)
-					fill_rect(x * psize, (y + 1) * psize, psize, psize);
-				if (i & 8)
-					fill_rect((x + 1) * psize, (y + 1) * psize, psize, psize);
-				if (i & 16)
-					fill_rect((x + 2) * psize, y * psize, psize, psize);
-				if (i & 32)
-					fill_rect((x + 3) * psize, y * psize, psize, psize);
-				if (i & 64)
-					fill_rect((x + 2) * psize, (y + 1) * psize, psize, psize);
-				if (i & 128)
-					fill_rect((x + 3) * psize, (y + 1) * psize, psize, psize);
-				x += 4;
-				addr++;
-			}
-		}
-		for (y = 64; y < 128; y += 2) {
-			for (x = 64; x < 128;) {
-				i = dma_read(addr);
-				if (i & 1)
-					fill_rect(x * psize, y * psize, psize, psize);
-				if (i & 2)
-					fill_rect((x + 1) * psize, y * psize, psize, psize);
-				if (i & 4)
-					fill_rect(x * psize, (y + 1) * psize, psize, psize);
-				if (i & 8)
-					fill_rect((x + 1) * psize, (y + 1) * psize, psize, psize);
-				if (i & 16)
-					fill_rect((x + 2) * psize, y * psize, psize, psize);
-				if (i & 32)
-					fill_rect((x + 3) * psize, y * psize, psize, psize);
-				if (i & 64)
-					fill_rect((x + 2) * psize, (y + 1) * psize, psize, psize);
-				if (i & 128)
-					fill_rect((x + 3) * psize, (y + 1) * psize, psize, psize);
-				x += 4;
-				addr++;
-			}
-		}
-	} else {		/* 512 bytes memory */
-		psize = size / 64;	/* size of one pixel for 64x64 */
-		for (y = 0; y < 64; y += 2) {
-			for (x = 0; x < 64;) {
-				i = dma_read(addr);
-				if (i & 1)
-					fill_rect(x * psize, y * psize, psize, psize);
-				if (i & 2)
-					fill_rect((x + 1) * psize, y * psize, psize, psize);
-				if (i & 4)
-					fill_rect(x * psize, (y + 1) * psize, psize, psize);
-				if (i & 8)
-					fill_rect((x + 1) * psize, (y + 1) * psize, psize, psize);
-				if (i & 16)
-					fill_rect((x + 2) * psize, y * psize, psize, psize);
-				if (i & 32)
-					fill_rect((x + 3) * psize, y * psize, psize, psize);
-				if (i & 64)
-					fill_rect((x + 2) * psize, (y + 1) * psize, psize, psize);
-				if (i & 128)
-					fill_rect((x + 3) * psize, (y + 1) * psize, psize, psize);
-				x += 4;
-				addr++;
-			}
+	} else {
+		draw_lowres(buf, 0, 0);
+		if (fmt & 32) {
+			draw_lowres(buf + 512, 32, 0);
+			draw_lowres(buf + 1024, 0, 32);
+			draw_lowres(buf + 1536, 32, 32);
 		}
 	}
+	return true;
 }
 
-/* draw pixels for one frame in lowres */
-static void draw_lowres(void)
+#ifndef WANT_SDL
+/* scale the frame buffer into the pixmap */
+static void put_frame(void)
 {
-	int psize, x, y, i;
-	WORD addr = dma_addr;
-
-	/* get size of DMA memory and draw the pixels */
-	if (format & 32) {	/* 2048 bytes memory */
-		psize = size / 64;	/* size of one pixel for 64x64 */
-		for (y = 0; y < 32; y++) {
-			for (x = 0; x < 32;) {
-				i = dma_read(addr) & 0x0f;
-				if (format & 16)
-					set_fg_color(i);
-				else
-					set_fg_gray(i);
-				fill_rect(x * psize, y * psize, psize, psize);
-				x++;
-				i = (dma_read(addr) & 0xf0) >> 4;
-				if (format & 16)
-					set_fg_color(i);
-				else
-					set_fg_gray(i);
-				fill_rect(x * psize, y * psize, psize, psize);
-				x++;
-				addr++;
-			}
-		}
-		for (y = 0; y < 32; y++) {
-			for (x = 32; x < 64;) {
-				i = dma_read(addr) & 0x0f;
-				if (format & 16)
-					set_fg_color(i);
-				else
-					set_fg_gray(i);
-				fill_rect(x * psize, y * psize, psize, psize);
-				x++;
-				i = (dma_read(addr) & 0xf0) >> 4;
-				if (format & 16)
-					set_fg_color(i);
-				else
-					set_fg_gray(i);
-				fill_rect(x * psize, y * psize, psize, psize);
-				x++;
-				addr++;
-			}
-		}
-		for (y = 32; y < 64; y++) {
-			for (x = 0; x < 32;) {
-				i = dma_read(addr) & 0x0f;
-				if (format & 16)
-					set_fg_color(i);
-				else
-					set_fg_gray(i);
-				fill_rect(x * psize, y * psize, psize, psize);
-				x++;
-				i = (dma_read(addr) & 0xf0) >> 4;
-				if (format & 16)
-					set_fg_color(i);
-				else
-					set_fg_gray(i);
-				fill_rect(x * psize, y * psize, psize, psize);
-				x++;
-				addr++;
-			}
-		}
-		for (y = 32; y < 64; y++) {
-			for (x = 32; x < 64;) {
-				i = dma_read(addr) & 0x0f;
-				if (format & 16)
-					set_fg_color(i);
-				else
-					set_fg_gray(i);
-				fill_rect(x * psize, y * psize, psize, psize);
-				x++;
-				i = (dma_read(addr) & 0xf0) >> 4;
-				if (format & 16)
-					set_fg_color(i);
-				else
-					set_fg_gray(i);
-				fill_rect(x * psize, y * psize, psize, psize);
-				x++;
-				addr++;
-			}
-		}
-	} else {		/* 512 bytes memory */
-		psize = size / 32;	/* size of one pixel for 32x32 */
-		for (y = 0; y < 32; y++) {
-			for (x = 0; x < 32;) {
-				i = dma_read(addr) & 0x0f;
-				if (format & 16)
-					set_fg_color(i);
-				else
-					set_fg_gray(i);
-				fill_rect(x * psize, y * psize, psize, psize);
-				x++;
-				i = (dma_read(addr) & 0xf0) >> 4;
-				if (format & 16)
-					set_fg_color(i);
-				else
-					set_fg_gray(i);
-				fill_rect(x * psize, y * psize, psize, psize);
-				x++;
-				addr++;
-			}
+	int psize = size / fb_size, bpl = ximage->bytes_per_line;
+	int x, y, i;
+	uint32_t *p, *q;
+	char *line;
+
+	for (y = 0; y < fb_size; y++) {
+		q = &fb[y * FBSIZE];
+		line = ximage->data + y * psize * bpl;
+		if (ximage->bits_per_pixel == 32) {
+			p = (uint32_t *) line;
+			for (x = 0; x < fb_size; x++)
+				for (i = 0; i < psize; i++)
+					*p++ = q[x];
+		} else {
+			for (x = 0; x < size; x++)
+				XPutPixel(ximage, x, y * psize, q[x / psize]);
 		}
+		for (i = 1; i < psize; i++)
+			memcpy(line + i * bpl, line, bpl);
 	}
+	XPutImage(display, pixmap, gc, ximage, 0, 0, 0, 0, size, size);
 }
+#endif
 
 #ifdef HAS_NETSERVER
 static uint8_t dblbuf[2048];
@@ -648,6 +551,20 @@ static void ws_clear(void)
 	msg.len = 0;
 	net_device_send(DEV_DZLR, (char *) &msg, msg.len + 6);
 	LOGD(TAG, "Clear the screen.");
+
+	/* an empty frame clears the screen */
+	if (wsf.buf != NULL)
+		wsframe_send(&wsf, 0, NULL, 0);
+}
+
+/* send the DMA window as delta encoded frame */
+static void ws_frame(void)
+{
+	BYTE buf[2048], fmt = format;
+	int len = (fmt & 32) ? 2048 : 512;
+
+	dma_read_block(dma_addr, buf, len);
+	wsframe_send(&wsf, fmt, buf, len);
 }
 
 static void ws_refresh(void)
@@ -713,13 +630,16 @@ static void update_display(bool tick)
 	UNUSED(tick);
 
 	/* draw one frame dependent on graphics format */
-	set_fg_color(0);
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
 	SDL_RenderClear(renderer);
 	if (state) {		/* draw frame if on */
-		if (format & 64)
-			draw_hires();
-		else
-			draw_lowres();
+		bool changed = draw_frame();
+		SDL_Rect r = {0, 0, fb_size, fb_size};
+
+		if (changed)
+			SDL_UpdateTexture(texture, &r, fb,
+					  FBSIZE * sizeof(uint32_t));
+		SDL_RenderCopy(renderer, texture, &r, NULL);
 		SDL_RenderPresent(renderer);
 
 		/* frame done, set frame flag for 4ms */
@@ -744,6 +664,10 @@ static void *update_thread(void *arg)
 {
 	uint64_t t;
 	long tleft;
+#ifndef WANT_SDL
+	XEvent event;
+	bool changed, exposed;
+#endif
 
 	UNUSED(arg);
 
@@ -758,15 +682,19 @@ static void *update_thread(void *arg)
 #endif
 #ifndef WANT_SDL
 				XLockDisplay(display);
-				set_fg_color(0);
-				fill_rect(0, 0, size, size);
-				if (format & 64)
-					draw_hires();
-				else
-					draw_lowres();
-				XCopyArea(display, pixmap, window, gc, 0, 0,
-					  size, size, 0, 0);
-				XSync(display, True);
+				/* the window needs a copy if exposed */
+				exposed = false;
+				while (XCheckTypedWindowEvent(display, window,
+							      Expose, &event))
+					exposed = true;
+				changed = draw_frame();
+				if (changed)
+					put_frame();
+				if (changed || exposed) {
+					XCopyArea(display, pixmap, window, gc,
+						  0, 0, size, size, 0, 0);
+					XSync(display, False);
+				}
 				XUnlockDisplay(display);
 #endif
 #ifdef HAS_NETSERVER
@@ -779,6 +707,8 @@ static void *update_thread(void *arg)
 						msg.format = 0;
 					}
 				}
+				if (net_device_ready(DEV_DZLRF))
+					ws_frame();
 			}
 #endif
 		}
@@ -801,11 +731,58 @@ static void *update_thread(void *arg)
 }
 #endif /* !WANT_SDL || !HAS_NETSERVER */
 
+#ifdef HAS_VIDCAP
+static uint32_t cap_fb[FBSIZE * FBSIZE]; /* frame scaled to 128x128 */
+
+/* draw a frame for the headless capture */
+static const uint32_t *capture_frame(void)
+{
+	const uint32_t *q;
+	uint32_t *p = cap_fb;
+	int psize, x, y;
+
+	if (!state) {
+		memset(cap_fb, 0, sizeof(cap_fb));
+		return cap_fb;
+	}
+
+	if (draw_frame()) {
+		psize = FBSIZE / fb_size;
+		for (y = 0; y < FBSIZE; y++) {
+			q = &fb[(y / psize) * FBSIZE];
+			for (x = 0; x < FBSIZE; x++)
+				*p++ = q[x / psize];
+		}
+	}
+
+	return cap_fb;
+}
+
+static vidcap_t dazzler_cap = { .name = "dazzler", .w = FBSIZE,
+				.h = FBSIZE, .render = capture_frame };
+#endif /* HAS_VIDCAP */
+
 void cromemco_dazzler_ctl_out(BYTE data)
 {
 	/* get DMA address for display memory */
 	dma_addr = (data & 0x7f) << 9;
 
+#ifdef HAS_VIDCAP
+	/* frames are drawn by the CPU thread in emulated time */
+	if (V_flag) {
+		if (data & 128) {
+			if (!dazzler_cap.added) {
+				init_pixels();
+				vidcap_add(&dazzler_cap);
+			}
+			vram_format = -1;
+			state = true;
+		} else
+			state = false;
+		return;
+	}
+#endif
+
 	/* switch DAZZLER on/off */
 	if (data & 128) {
 #ifdef HAS_NETSERVER
@@ -820,10 +797,13 @@ void cromemco_dazzler_ctl_out(BYTE data)
 #endif
 #ifdef HAS_NETSERVER
 		} else {
+			if (wsf.buf == NULL)
+				wsframe_init(&wsf, DEV_DZLRF, 2048);
 			if (!state)
 				ws_clear();
 		}
 #endif
+		vram_format = -1;
 		state = true;
 #if defined(WANT_SDL) && defined(HAS_NETSERVER)
 		if (n_flag) {
@@ -865,6 +845,15 @@ BYTE cromemco_dazzler_flags_in(void)
 {
 	BYTE data = 0xff;
 
+#ifdef HAS_VIDCAP
+	/* frame flag is set for 4ms after a frame of emulated time */
+	if (V_flag) {
+		if (dazzler_cap.added)
+			data = (T - vidcap_last < vidcap_tstates(4000)) ? 0 : 64;
+		return data;
+	}
+#endif
+
 #ifdef WANT_SDL
 #ifdef HAS_NETSERVER
 	if (!n_flag) {
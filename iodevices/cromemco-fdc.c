@@ -37,6 +37,8 @@
  * 29-JUL-2021 add boot config for machine without frontpanel
  * 02-SEP-2021 implement banked ROM
  * 15-MAY-2024 make disk manager standard
+ * 18-OCT-2026 read ahead whole tracks from disk images
+ * 18-OCT-2026 collect disk I/O statistics
  */
 
 #include <unistd.h>
@@ -54,6 +56,8 @@
 
 #include "diskmanager.h"
 #include "cromemco-fdc.h"
+#include "trackcache.h"
+#include "diskstats.h"
 
 #include "log.h"
 static const char *TAG = "16FDC";
@@ -94,6 +98,13 @@ static bool mflag;		/* multiple sectors flag */
 static char fn[MAX_LFN];	/* path/filename for disk image */
 static int fd;			/* fd for disk i/o */
 static BYTE buf[SEC_SZDD];	/* buffer for one sector */
+static trackcache_t tcache[4];	/* read-ahead buffers for the disks */
+static diskstats_t dstat[4] = {	/* disk I/O statistics */
+	DISKSTATS_INIT("16FDC", "A:"),
+	DISKSTATS_INIT("16FDC", "B:"),
+	DISKSTATS_INIT("16FDC", "C:"),
+	DISKSTATS_INIT("16FDC", "D:")
+};
        int index_pulse = 0;	/* disk index pulse */
 static bool autowait;		/* autowait flag */
        bool motoron;		/* motor on flag */
@@ -138,11 +149,13 @@ char *dsk_path(void)
  * configure drive and disk geometry from image file size
  * and set R/W or R/O mode for the disk
  */
-static void config_disk(int fd)
+static void config_disk(int fd, struct stat *sp)
 {
 	struct stat s;
 
 	fstat(fd, &s);
+	if (sp != NULL)
+		*sp = s;
 	if (s.st_mode & S_IWUSR)
 		disks[disk].disk_m = READWRITE;
 	else
@@ -287,6 +300,17 @@ static off_t get_pos(void)
 	return pos;
 }
 
+/*
+ * get sector size of the current track in the disk image
+ */
+static int get_trk_secsz(void)
+{
+	if ((fdc_track == 0) && (side == 0))
+		return (disks[disk].disk_d0 == SINGLE) ? SEC_SZSD : SEC_SZDD;
+	else
+		return (disks[disk].disk_d == SINGLE) ? SEC_SZSD : SEC_SZDD;
+}
+
 /*
  *	4FDC		16FDC
  * D7	DRQ		DRQ
@@ -389,6 +413,10 @@ BYTE cromemco_fdc_data_in(void)
 {
 	off_t pos;		/* seek position */
 	int lastsec;		/* last sector of a track */
+	int trksecsz;		/* sector size of the track in the image */
+	struct stat s;
+	uint64_t t0;
+	bool ok;
 
 	switch (state) {
 	case FDC_READ:		/* read data from disk sector */
@@ -414,7 +442,7 @@ BYTE cromemco_fdc_data_in(void)
 				return (BYTE) 0;
 			}
 			/* get drive and disk geometry */
-			config_disk(fd);
+			config_disk(fd, &s);
 			if (disks[disk].disk_t == UNKNOWN) {
 				state = FDC_IDLE;	/* abort command */
 				fdc_flags |= 1;		/* set EOJ */
@@ -438,18 +466,17 @@ BYTE cromemco_fdc_data_in(void)
 				close(fd);
 				return (BYTE) 0;
 			}
-			/* seek to sector */
+			/* read the sector, or the whole track if not cached */
 			pos = get_pos();
-			if (lseek(fd, pos, SEEK_SET) == -1L) {
-				state = FDC_IDLE;	/* abort command */
-				fdc_flags |= 1;		/* set EOJ */
-				fdc_flags &= ~128;	/* reset DRQ */
-				fdc_stat = 0x10;	/* sector not found */
-				close(fd);
-				return (BYTE) 0;
-			}
-			/* read the sector */
-			if (read(fd, buf, secsz) != secsz) {
+			trksecsz = get_trk_secsz();
+			t0 = diskstats_start();
+			ok = trackcache_read(&tcache[disk], fd, &s,
+					     pos - (fdc_sec - 1) * trksecsz,
+					     lastsec * trksecsz,
+					     pos, buf, secsz);
+			diskstats_io(&dstat[disk], false, fdc_track, pos,
+				     secsz, t0, ok);
+			if (!ok) {
 				state = FDC_IDLE;	/* abort command */
 				fdc_flags |= 1;		/* set EOJ */
 				fdc_flags &= ~128;	/* reset DRQ */
@@ -521,6 +548,7 @@ void cromemco_fdc_data_out(BYTE data)
 	static int wrtstat;	/* state while writing (formatting) tracks */
 	static int bcnt;	/* byte counter for sector data */
 	static int secs;	/* # of sectors written so far */
+	uint64_t t0;
 
 	switch (state) {
 	case FDC_WRITE:			/* write data to disk sector */
@@ -551,7 +579,7 @@ void cromemco_fdc_data_out(BYTE data)
 				return;
 			}
 			/* get drive and disk geometry */
-			config_disk(fd);
+			config_disk(fd, NULL);
 			if (disks[disk].disk_t == UNKNOWN) {
 				state = FDC_IDLE;	/* abort command */
 				fdc_flags |= 1;		/* set EOJ */
@@ -585,6 +613,7 @@ void cromemco_fdc_data_out(BYTE data)
 				close(fd);
 				return;
 			}
+			trackcache_inval(&tcache[disk], pos, secsz);
 		}
 		/* write data bytes into the sector buffer */
 		buf[dcnt++] = data;
@@ -593,10 +622,13 @@ void cromemco_fdc_data_out(BYTE data)
 			state = FDC_IDLE;		/* done */
 			fdc_flags |= 1;			/* set EOJ */
 			fdc_flags &= ~128;		/* reset DRQ */
+			t0 = diskstats_start();
 			if (write(fd, buf, secsz) == secsz)
 				fdc_stat = 0;
 			else
 				fdc_stat = 0x20;	/* write fault */
+			diskstats_io(&dstat[disk], true, fdc_track, get_pos(),
+				     secsz, t0, fdc_stat == 0);
 			close(fd);
 		}
 		break;
@@ -604,6 +636,7 @@ void cromemco_fdc_data_out(BYTE data)
 	case FDC_WRTTRK:		/* write (format) track */
 		if (dcnt == 0) {
 			motortimer = 800;
+			trackcache_flush(&tcache[disk]);
 			/* unlink disk image */
 			dsk_path();
 			strcat(fn, "/");
@@ -7,6 +7,8 @@
 *
 * History:
 * 9-JUL-2022	1.0	Initial Release
+* 18-OCT-2026	read stdin and sockets in an input thread, status from memory
+* 18-OCT-2026	added hal_hangup()
 *
 */
 
@@ -16,8 +18,6 @@
 #include <string.h>
 #include <ctype.h>
 #include <errno.h>
-#include <sys/poll.h>
-#include <sys/socket.h>
 
 #include "sim.h"
 #include "simdefs.h"
@@ -26,6 +26,7 @@
 
 #include "unix_terminal.h"
 #include "unix_network.h"
+#include "hostin.h"
 #ifdef HAS_NETSERVER
 #include "netsrv.h"
 #endif
@@ -119,6 +120,8 @@ static void net_tty_out(int dev, BYTE data)
 
 /* -------------------- STDIO HAL -------------------- */
 
+static hostin_t stdio_hin;		/* buffered stdin */
+
 static bool stdio_alive(int dev)
 {
 	UNUSED(dev);
@@ -128,51 +131,40 @@ static bool stdio_alive(int dev)
 
 static void stdio_status(int dev, BYTE *stat)
 {
-	struct pollfd p[1];
-
 	UNUSED(dev);
 
-	p[0].fd = fileno(stdin);
-	p[0].events = POLLIN;
-	p[0].revents = 0;
-	poll(p, 1, 0);
-	*stat &= (BYTE) (~3);
-	if (p[0].revents & POLLIN)
-		*stat |= 2;
-	if (p[0].revents & POLLNVAL) {
+	if (!hostin_alive(&stdio_hin)) {
 		LOGE(TAG, "can't use terminal, try 'screen simulation ...'");
 		exit(EXIT_FAILURE);
 		// cpu_error = IOERROR;
 		// cpu_state = STOPPED;
 	}
+	*stat &= (BYTE) (~3);
+	/* at EOF let the guest read, so that the tty gets reopened */
+	if (hostin_ready(&stdio_hin) || hostin_eof(&stdio_hin))
+		*stat |= 2;
 	*stat |= 1;
 }
 
 static int stdio_in(int dev)
 {
 	int data;
-	struct pollfd p[1];
 
 	UNUSED(dev);
 
-again:
 	/* if no input waiting return last */
-	p[0].fd = fileno(stdin);
-	p[0].events = POLLIN;
-	p[0].revents = 0;
-	poll(p, 1, 0);
-	if (!(p[0].revents & POLLIN))
-		return -1;
+	if ((data = hostin_get(&stdio_hin)) >= 0 || !hostin_eof(&stdio_hin))
+		return data;
 
-	if (read(fileno(stdin), &data, 1) == 0) {
-		/* try to reopen tty, input redirection exhausted */
-		if (freopen("/dev/tty", "r", stdin) == NULL)
-			LOGE(TAG, "can't reopen /dev/tty");
-		set_unix_terminal();
-		goto again;
-	}
+	/* try to reopen tty, input redirection exhausted */
+	if (freopen("/dev/tty", "r", stdin) == NULL) {
+		LOGE(TAG, "can't reopen /dev/tty");
+		hostin_reopen(&stdio_hin, -1);
+	} else
+		hostin_reopen(&stdio_hin, fileno(stdin));
+	set_unix_terminal();
 
-	return data;
+	return -1;
 }
 
 static void stdio_out(int dev, BYTE data)
@@ -193,27 +185,25 @@ again:
 
 /* -------------------- SOCKET SERVER HAL -------------------- */
 
+static hostin_t scktsrv_hin[NUMNSOC];	/* buffered telnet connections */
+
 static bool scktsrv_alive(int dev)
 {
-	return ncons[dev].ssc != 0; /* SCKTSRV is alive if there is an open socket */
+	/* SCKTSRV is alive if there is an open socket */
+	return hostin_alive(&scktsrv_hin[dev]);
 }
 
 static void scktsrv_status(int dev, BYTE *stat)
 {
-	struct pollfd p[1];
+	hostin_t *hi = &scktsrv_hin[dev];
 
 	/* if socket is connected check for I/O */
-	if (ncons[dev].ssc != 0) {
-		p[0].fd = ncons[dev].ssc;
-		p[0].events = POLLIN;
-		p[0].revents = 0;
-		poll(p, 1, 0);
+	if (hostin_alive(hi)) {
 		*stat &= (BYTE) (~3);
-		if (p[0].revents & POLLHUP) {
-			close(ncons[dev].ssc);
-			ncons[dev].ssc = 0;
+		if (hostin_eof(hi)) {
+			hostin_hangup(hi);
 			*stat = 0;
-		} else if (p[0].revents & POLLIN)
+		} else if (hostin_ready(hi))
 			*stat |= 2;
 		else
 			*stat |= 1;
@@ -223,52 +213,31 @@ static void scktsrv_status(int dev, BYTE *stat)
 
 static int scktsrv_in(int dev)
 {
-	BYTE data, dummy;
-	struct pollfd p[1];
+	hostin_t *hi = &scktsrv_hin[dev];
 
-	/* if not connected return last */
-	if (ncons[dev].ssc == 0)
+	/* if not connected or no input waiting return last */
+	if (!hostin_alive(hi))
 		return -1;
 
-	/* if no input waiting return last */
-	p[0].fd = ncons[dev].ssc;
-	p[0].events = POLLIN;
-	p[0].revents = 0;
-	poll(p, 1, 0);
-	if (!(p[0].revents & POLLIN))
+	/* on EOF close socket and return last */
+	if (hostin_eof(hi)) {
+		hostin_hangup(hi);
 		return -1;
-
-	if (read(ncons[dev].ssc, &data, 1) != 1) {
-		if ((errno == EAGAIN) || (errno == EINTR)) {
-			/* EOF, close socket and return last */
-			close(ncons[dev].ssc);
-			ncons[dev].ssc = 0;
-			return -1;
-		} else {
-			LOGE(TAG, "can't read tcpsocket %d data", dev);
-			cpu_error = IOERROR;
-			cpu_state = ST_STOPPED;
-			return 0;
-		}
 	}
 
-	/* process read data */
-	/* telnet client sends \r\n or \r\0, drop second character */
-	if (ncons[dev].telnet && (data == '\r'))
-		if (read(ncons[dev].ssc, &dummy, 1) != 1)
-			LOGE(TAG, "can't read tcpsocket %d data", dev);
-
-	return data;
+	return hostin_get(hi);
 }
 
 static void scktsrv_out(int dev, BYTE data)
 {
+	int fd = hostin_fd(&scktsrv_hin[dev]);
+
 	/* return if socket not connected */
-	if (ncons[dev].ssc == 0)
+	if (fd == -1)
 		return;
 
 again:
-	if (write(ncons[dev].ssc, &data, 1) != 1) {
+	if (write(fd, &data, 1) != 1) {
 		if (errno == EINTR) {
 			goto again;
 		} else {
@@ -279,6 +248,58 @@ again:
 	}
 }
 
+static bool hin_done;			/* inputs registered */
+
+/*
+ * register stdin and the server sockets with the input thread
+ */
+static void hal_hostin_init(void)
+{
+	int i;
+
+	if (hin_done)
+		return;
+	hin_done = true;
+
+	stdio_hin.fd = fileno(stdin);
+	stdio_hin.ss = -1;
+#ifdef WANT_ICE
+	/* ICE reads the terminal until the machine runs */
+	stdio_hin.hold = true;
+#endif
+	hostin_add(&stdio_hin);
+
+	for (i = 0; i < NUMNSOC; i++) {
+		scktsrv_hin[i].fd = -1;
+		scktsrv_hin[i].ss = ncons[i].ss ? ncons[i].ss : -1;
+		scktsrv_hin[i].tcp = true;
+		scktsrv_hin[i].telnet = ncons[i].telnet;
+		hostin_add(&scktsrv_hin[i]);
+	}
+}
+
+/*
+ * close the socket connections on exit
+ */
+void hal_hangup(void)
+{
+	int i;
+
+	if (!hin_done)
+		return;
+	for (i = 0; i < NUMNSOC; i++)
+		if (hostin_alive(&scktsrv_hin[i]))
+			hostin_hangup(&scktsrv_hin[i]);
+}
+
+/*
+ * stop reading stdin while ICE uses the terminal
+ */
+void hal_stdio_hold(bool hold)
+{
+	hostin_hold(&stdio_hin, hold);
+}
+
 /* -------------------- MODEM HAL -------------------- */
 
 #ifdef HAS_MODEM
@@ -444,6 +465,7 @@ static void hal_init(void)
 
 void hal_reset(void)
 {
+	hal_hostin_init();
 	hal_init();
 	hal_report();
 }
@@ -7,6 +7,8 @@
  *
  * History:
  * 9-JUL-2022	1.0	Initial Release
+ * 18-OCT-2026	added hal_stdio_hold()
+ * 18-OCT-2026	added hal_hangup()
  *
  */
 
@@ -52,6 +54,8 @@ extern void hal_status_in(tuart_port_t dev, BYTE *stat);
 extern int hal_data_in(tuart_port_t dev);
 extern void hal_data_out(tuart_port_t dev, BYTE data);
 extern bool hal_alive(tuart_port_t dev);
+extern void hal_stdio_hold(bool hold);
+extern void hal_hangup(void);
 
 extern const char *tuart_port_name[MAX_TUART_PORT];
 extern hal_device_t tuart[MAX_TUART_PORT][MAX_HAL_DEV];
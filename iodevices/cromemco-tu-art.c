@@ -20,6 +20,7 @@
  * 03-MAY-2018 improved accuracy
  * 15-JUL-2018 use logging
  * 06-SEP-2021 implement reset
+ * 18-OCT-2026 optional pacing at the programmed baud rates
  */
 
 #include <unistd.h>
@@ -45,6 +46,43 @@
 #include "log.h"
 static const char *TAG = "TU-ART";
 
+bool tuart_pacing;		/* pace characters at the programmed baud rate */
+
+static const int tuart_rates[7] = { 110, 150, 300, 1200, 2400, 4800, 9600 };
+
+/*
+ * get the baud rate selected by the baud rate register and the
+ * high baud bit of the command register, 0 if the serial transmitter
+ * and receiver are disabled
+ */
+static int tuart_baud(BYTE baud, bool high)
+{
+	int i;
+
+	for (i = 6; i >= 0; i--)
+		if (baud & (1 << i))
+			return high ? tuart_rates[i] * 8 : tuart_rates[i];
+
+	return 0;
+}
+
+/*
+ * with pacing the CPU sees new receive data when the character
+ * time after the last read passed, without waiting for the timer
+ */
+static void tuart_pace_rda(tuart_port_t dev, bool *rda, Tstates_t rx_t,
+			   int baud)
+{
+	BYTE status = 0;
+
+	if (*rda || baud_busy(rx_t, baud))
+		return;
+
+	hal_status_in(dev, &status);
+	if (status & 2)
+		*rda = true;
+}
+
 void lpt_reset(void)
 {
 	if (lpt1) {
@@ -67,6 +105,10 @@ bool uart0a_int_pending, uart0a_rst7;
 int uart0a_timer1, uart0a_timer2, uart0a_timer3, uart0a_timer4, uart0a_timer5;
 int uart0a_tbe;
 bool uart0a_rda;
+int uart0a_baud;
+Tstates_t uart0a_tx_t, uart0a_rx_t;
+static BYTE uart0a_baud_reg;
+static bool uart0a_high_baud;
 
 /*
  * D7	Transmit Buffer Empty
@@ -82,7 +124,10 @@ BYTE cromemco_tuart_0a_status_in(void)
 {
 	BYTE status = 4;
 
-	if (uart0a_tbe)
+	if (tuart_pacing)
+		tuart_pace_rda(TUART0A, &uart0a_rda, uart0a_rx_t, uart0a_baud);
+
+	if (uart0a_tbe || (tuart_pacing && !baud_busy(uart0a_tx_t, uart0a_baud)))
 		status |= 128;
 
 	if (uart0a_rda)
@@ -106,7 +151,8 @@ BYTE cromemco_tuart_0a_status_in(void)
  */
 void cromemco_tuart_0a_baud_out(BYTE data)
 {
-	UNUSED(data);
+	uart0a_baud_reg = data;
+	uart0a_baud = tuart_baud(data, uart0a_high_baud);
 }
 
 BYTE cromemco_tuart_0a_data_in(void)
@@ -115,6 +161,7 @@ BYTE cromemco_tuart_0a_data_in(void)
 	static BYTE last;
 
 	uart0a_rda = false;
+	uart0a_rx_t = T;
 
 	data = hal_data_in(TUART0A);
 	/* if no new data available return last */
@@ -131,6 +178,7 @@ void cromemco_tuart_0a_data_out(BYTE data)
 {
 	data &= 0x7f;
 	uart0a_tbe = 0;
+	uart0a_tx_t = T;
 	if (data == 0x00)
 		return;
 
@@ -150,6 +198,8 @@ void cromemco_tuart_0a_data_out(BYTE data)
 void cromemco_tuart_0a_command_out(BYTE data)
 {
 	uart0a_rst7 = (data & 4) ? true : false;
+	uart0a_high_baud = (data & 16) ? true : false;
+	uart0a_baud = tuart_baud(uart0a_baud_reg, uart0a_high_baud);
 
 	if (data & 1) {
 		uart0a_rda = false;
@@ -242,6 +292,10 @@ int uart1a_int_mask, uart1a_int;
 bool uart1a_int_pending;
 bool uart1a_sense, uart1a_lpt_busy;
 bool uart1a_tbe, uart1a_rda;
+int uart1a_baud;
+Tstates_t uart1a_tx_t, uart1a_rx_t;
+static BYTE uart1a_baud_reg;
+static bool uart1a_high_baud;
 
 BYTE cromemco_tuart_1a_status_in(void)
 {
@@ -249,7 +303,10 @@ BYTE cromemco_tuart_1a_status_in(void)
 
 	status = (hal_alive(TUART1A)) ? 4 : 0;
 
-	if (uart1a_tbe)
+	if (tuart_pacing)
+		tuart_pace_rda(TUART1A, &uart1a_rda, uart1a_rx_t, uart1a_baud);
+
+	if (uart1a_tbe || (tuart_pacing && !baud_busy(uart1a_tx_t, uart1a_baud)))
 		status |= 128;
 
 	if (uart1a_rda)
@@ -263,7 +320,8 @@ BYTE cromemco_tuart_1a_status_in(void)
 
 void cromemco_tuart_1a_baud_out(BYTE data)
 {
-	UNUSED(data);
+	uart1a_baud_reg = data;
+	uart1a_baud = tuart_baud(data, uart1a_high_baud);
 }
 
 BYTE cromemco_tuart_1a_data_in(void)
@@ -272,6 +330,7 @@ BYTE cromemco_tuart_1a_data_in(void)
 	static BYTE last;
 
 	uart1a_rda = false;
+	uart1a_rx_t = T;
 
 	data = hal_data_in(TUART1A);
 	/* if no new data available return last */
@@ -286,6 +345,7 @@ BYTE cromemco_tuart_1a_data_in(void)
 void cromemco_tuart_1a_data_out(BYTE data)
 {
 	uart1a_tbe = false;
+	uart1a_tx_t = T;
 	data &= 0x7f;
 	if (data == 0x00)
 		return;
@@ -295,6 +355,9 @@ void cromemco_tuart_1a_data_out(BYTE data)
 
 void cromemco_tuart_1a_command_out(BYTE data)
 {
+	uart1a_high_baud = (data & 16) ? true : false;
+	uart1a_baud = tuart_baud(uart1a_baud_reg, uart1a_high_baud);
+
 	if (data & 1) {
 		uart1a_rda = false;
 		uart1a_tbe = true;
@@ -361,6 +424,10 @@ int uart1b_int_mask, uart1b_int;
 bool uart1b_int_pending;
 bool uart1b_sense, uart1b_lpt_busy;
 bool uart1b_tbe, uart1b_rda;
+int uart1b_baud;
+Tstates_t uart1b_tx_t, uart1b_rx_t;
+static BYTE uart1b_baud_reg;
+static bool uart1b_high_baud;
 
 BYTE cromemco_tuart_1b_status_in(void)
 {
@@ -368,7 +435,10 @@ BYTE cromemco_tuart_1b_status_in(void)
 
 	status = (hal_alive(TUART1B)) ? 4 : 0;
 
-	if (uart1b_tbe)
+	if (tuart_pacing)
+		tuart_pace_rda(TUART1B, &uart1b_rda, uart1b_rx_t, uart1b_baud);
+
+	if (uart1b_tbe || (tuart_pacing && !baud_busy(uart1b_tx_t, uart1b_baud)))
 		status |= 128;
 
 	if (uart1b_rda)
@@ -382,7 +452,8 @@ BYTE cromemco_tuart_1b_status_in(void)
 
 void cromemco_tuart_1b_baud_out(BYTE data)
 {
-	UNUSED(data);
+	uart1b_baud_reg = data;
+	uart1b_baud = tuart_baud(data, uart1b_high_baud);
 }
 
 BYTE cromemco_tuart_1b_data_in(void)
@@ -391,6 +462,7 @@ BYTE cromemco_tuart_1b_data_in(void)
 	static BYTE last;
 
 	uart1b_rda = false;
+	uart1b_rx_t = T;
 
 	data = hal_data_in(TUART1B);
 	/* if no new data available return last */
@@ -405,6 +477,7 @@ BYTE cromemco_tuart_1b_data_in(void)
 void cromemco_tuart_1b_data_out(BYTE data)
 {
 	uart1b_tbe = false;
+	uart1b_tx_t = T;
 	data &= 0x7f;
 	if (data == 0x00)
 		return;
@@ -414,6 +487,9 @@ void cromemco_tuart_1b_data_out(BYTE data)
 
 void cromemco_tuart_1b_command_out(BYTE data)
 {
+	uart1b_high_baud = (data & 16) ? true : false;
+	uart1b_baud = tuart_baud(uart1b_baud_reg, uart1b_high_baud);
+
 	if (data & 1) {
 		uart1b_rda = false;
 		uart1b_tbe = true;
@@ -490,16 +566,25 @@ void cromemco_tuart_reset(void)
 	uart0a_timer1 = uart0a_timer2 = uart0a_timer3 = 0;
 	uart0a_timer4 = uart0a_timer5 = 0;
 	uart0a_rst7 = false;
+	uart0a_baud_reg = 0;
+	uart0a_high_baud = false;
+	uart0a_baud = 0;
 
 	uart1a_int = 0xff;
 	uart1a_int_mask = 0;
 	uart1a_int_pending = false;
 	uart1a_rda = false;
 	uart1a_tbe = true;
+	uart1a_baud_reg = 0;
+	uart1a_high_baud = false;
+	uart1a_baud = 0;
 
 	uart1b_int = 0xff;
 	uart1b_int_mask = 0;
 	uart1b_int_pending = false;
 	uart1b_rda = false;
 	uart1b_tbe = true;
+	uart1b_baud_reg = 0;
+	uart1b_high_baud = false;
+	uart1b_baud = 0;
 }
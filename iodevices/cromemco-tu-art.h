@@ -20,6 +20,7 @@
  * 03-MAY-2018 improved accuracy
  * 15-JUL-2018 use logging
  * 06-SEP-2021 implement reset
+ * 18-OCT-2026 optional pacing at the programmed baud rates
  */
 
 #ifndef CROMEMCO_TU_ART_INC
@@ -28,8 +29,21 @@
 #include "sim.h"
 #include "simdefs.h"
 
+#include "baudpace.h"
+
 extern void lpt_reset(void);
 
+extern bool tuart_pacing;
+
+/*
+ * true while a paced transmitter or receiver is busy with a character
+ * started at T-state t0
+ */
+static inline bool tuart_busy(Tstates_t t0, int baud)
+{
+	return tuart_pacing && baud_busy(t0, baud);
+}
+
 extern BYTE cromemco_tuart_0a_status_in(void);
 extern void cromemco_tuart_0a_baud_out(BYTE data);
 
@@ -58,6 +72,8 @@ extern int uart0a_timer1, uart0a_timer2, uart0a_timer3;
 extern int uart0a_timer4, uart0a_timer5;
 extern int uart0a_tbe;
 extern bool uart0a_rda;
+extern int uart0a_baud;
+extern Tstates_t uart0a_tx_t, uart0a_rx_t;
 
 /* <><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><> */
 
@@ -79,6 +95,8 @@ extern int uart1a_int_mask, uart1a_int;
 extern bool uart1a_int_pending;
 extern bool uart1a_sense, uart1a_lpt_busy;
 extern bool uart1a_tbe, uart1a_rda;
+extern int uart1a_baud;
+extern Tstates_t uart1a_tx_t, uart1a_rx_t;
 
 /* <><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><> */
 
@@ -100,5 +118,7 @@ extern int uart1b_int_mask, uart1b_int;
 extern bool uart1b_int_pending;
 extern bool uart1b_sense, uart1b_lpt_busy;
 extern bool uart1b_tbe, uart1b_rda;
+extern int uart1b_baud;
+extern Tstates_t uart1b_tx_t, uart1b_rx_t;
 
 #endif /* !CROMEMCO_TU_ART_INC */
@@ -7,6 +7,8 @@
  *
  * History:
  * 23-JUL-2022	1.0	Initial Release
+ * 18-OCT-2026		read ahead whole tracks from disk images
+ * 18-OCT-2026		collect disk I/O statistics
  *
  */
 
@@ -29,6 +31,8 @@
 #include "netsrv.h"
 #endif
 #include "cromemco-wdi.h"
+#include "trackcache.h"
+#include "diskstats.h"
 
 #define LOG_LOCAL_LEVEL LOG_ERROR
 #include "log.h"
@@ -45,6 +49,12 @@ static BYTE buffer[WDI_MAX_BUFFER];
 static const char *images[WDI_UNITS] =
 	{ "hd0.hdd", "hd1.hdd", "hd2.hdd" }; //, "hd3.hdd" };
 
+static diskstats_t dstat[WDI_UNITS] = {	/* disk I/O statistics */
+	DISKSTATS_INIT("WDI", "hd0.hdd"),
+	DISKSTATS_INIT("WDI", "hd1.hdd"),
+	DISKSTATS_INIT("WDI", "hd2.hdd")
+};
+
 #define MAX_DISK_PARAM	3
 
 static struct {
@@ -177,6 +187,7 @@ static struct {
 		BYTE sector;
 
 		int fd;
+		trackcache_t tc;	/* read-ahead buffer */
 		BYTE online;
 		BYTE _crc_error;
 		BYTE _fault;
@@ -218,6 +229,7 @@ void wdi_exit(void)
 			close(wdi.hd[unit].fd);
 			wdi.hd[unit].fd = 0;
 		}
+		trackcache_free(&wdi.hd[unit].tc);
 		wdi.hd[unit].online = 0;
 	}
 }
@@ -366,8 +378,6 @@ static off_t wdi_pos(BYTE *buf)
 
 static Tstates_t wdi_dma_write(BYTE bus_ack)
 {
-	int i;
-
 	if (!bus_ack)
 		return 0;
 
@@ -382,8 +392,8 @@ static Tstates_t wdi_dma_write(BYTE bus_ack)
 		return 0;
 	}
 
-	for (i = 0; i <= wdi.dma.wr0.len; i++)
-		buffer[i] = dma_read(wdi.dma.wr4.b_addr_counter++);
+	dma_read_block(wdi.dma.wr4.b_addr_counter, buffer, wdi.dma.wr0.len + 1);
+	wdi.dma.wr4.b_addr_counter += wdi.dma.wr0.len + 1;
 
 	LOGI(TAG, "            SYNC: %02x, HEAD: %02x, CYL: %02x%02x, SEC: %02x",
 	     buffer[0], buffer[1], buffer[3], buffer[2], buffer[4]);
@@ -417,12 +427,17 @@ static Tstates_t wdi_dma_write(BYTE bus_ack)
 		wdi.hd[wdi.unit]._fault = 0; /* write fault */
 		return 0;
 	}
+	trackcache_inval(&wdi.hd[wdi.unit].tc, pos, WDI_BLOCK_SIZE);
 
 	/* write the sector */
+	uint64_t t0 = diskstats_start();
+
 	if (write(wdi.hd[wdi.unit].fd, &buffer[5], WDI_BLOCK_SIZE) == WDI_BLOCK_SIZE)
 		wdi.hd[wdi.unit]._fault = 1;
 	else
 		wdi.hd[wdi.unit]._fault = 0; /* write fault */
+	diskstats_io(&dstat[wdi.unit], true, cyl, pos, WDI_BLOCK_SIZE, t0,
+		     wdi.hd[wdi.unit]._fault);
 
 	// if (fsync(wdi.hd[wdi.unit].fd) == -1) {
 	// 	LOGW(TAG, "WRITE: SYNC FAILED - %s [%d]", strerror(errno), errno);
@@ -433,9 +448,6 @@ static Tstates_t wdi_dma_write(BYTE bus_ack)
 
 static Tstates_t wdi_dma_read(BYTE bus_ack)
 {
-	register int v;
-	int i;
-
 	if (!bus_ack)
 		return 0;
 
@@ -464,25 +476,24 @@ static Tstates_t wdi_dma_read(BYTE bus_ack)
 
 	off_t pos = wdi_pos(buffer);
 
-	if (lseek(wdi.hd[wdi.unit].fd, pos, SEEK_SET) == -1L) {
-		wdi.hd[wdi.unit]._fault = 0; /* read fault */
-		return 0;
-	}
+	/* read the sector, or the whole track if not cached */
+	uint64_t t0 = diskstats_start();
+	bool ok = trackcache_read(&wdi.hd[wdi.unit].tc, wdi.hd[wdi.unit].fd, &s,
+				  pos - buffer[3] * WDI_BLOCK_SIZE,
+				  WDI_SECTORS * WDI_BLOCK_SIZE,
+				  pos, &buffer[4], WDI_BLOCK_SIZE);
 
-	/* read the sector */
-	if (read(wdi.hd[wdi.unit].fd, &buffer[4], WDI_BLOCK_SIZE) == WDI_BLOCK_SIZE)
+	diskstats_io(&dstat[wdi.unit], false, wdi.hd[wdi.unit].status.cav, pos,
+		     WDI_BLOCK_SIZE, t0, ok);
+	if (ok)
 		wdi.hd[wdi.unit]._fault = 1;
 	else {
 		wdi.hd[wdi.unit]._fault = 0; /* read fault */
 		return 0;
 	}
 
-	for (i = 0; i < wdi.dma.wr0.len; i++) {
-		v = buffer[i];
-
-		dma_write(wdi.dma.wr4.b_addr_counter, v);
-		wdi.dma.wr4.b_addr_counter++;
-	}
+	dma_write_block(wdi.dma.wr4.b_addr_counter, buffer, wdi.dma.wr0.len);
+	wdi.dma.wr4.b_addr_counter += wdi.dma.wr0.len;
 
 	return wdi.dma.wr0.len * 3;  /* 3 t-states per byte of DMA */
 }
@@ -0,0 +1,166 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Common I/O devices used by various simulated machines
+ *
+ * This module collects disk I/O statistics of the emulated disk
+ * controllers. A controller keeps a diskstats_t for each drive,
+ * initialized with DISKSTATS_INIT(), and reports each transfer with
+ * diskstats_io(). A drive shows up in the statistics after its first
+ * transfer.
+ *
+ * For each drive the number of reads, writes, transferred bytes,
+ * track changes (seeks) and errors is counted. A transfer is counted
+ * as sequential if it starts where the previous one ended in the disk
+ * image, otherwise as random. The time the host needed for the
+ * transfer is collected in a histogram with power of two buckets.
+ *
+ * The statistics are updated by the CPU thread and read or cleared by
+ * the ICE and the web server thread, so the list and the counters are
+ * protected by a mutex. Readers take a copy with diskstats_copy().
+ *
+ * History:
+ * 18-OCT-2026 first version
+ * 18-OCT-2026 protect the statistics with a mutex
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+
+#include "sim.h"
+#include "simdefs.h"
+#include "simport.h"
+
+#include "diskstats.h"
+
+static diskstats_t *active;	/* list of active drives */
+static pthread_mutex_t ds_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * get start time of a transfer
+ */
+uint64_t diskstats_start(void)
+{
+	return get_clock_us();
+}
+
+/*
+ * count a transfer of len bytes at image offset pos on track,
+ * started at time t0
+ */
+void diskstats_io(diskstats_t *ds, bool write, int track,
+		  off_t pos, size_t len, uint64_t t0, bool ok)
+{
+	uint64_t t = get_clock_us() - t0;
+	int i;
+
+	pthread_mutex_lock(&ds_mutex);
+	if (!ds->active) {
+		ds->track = track;
+		ds->next = pos;
+		ds->link = active;
+		ds->active = true;
+		active = ds;
+	}
+
+	if (write) {
+		ds->writes++;
+		if (ok)
+			ds->wbytes += len;
+	} else {
+		ds->reads++;
+		if (ok)
+			ds->rbytes += len;
+	}
+	if (!ok)
+		ds->errors++;
+
+	if (track != ds->track)
+		ds->seeks++;
+	if (pos == ds->next)
+		ds->seq++;
+	else
+		ds->rnd++;
+	ds->track = track;
+	ds->next = pos + len;
+
+	for (i = 0; i < DS_BUCKETS - 1; i++)
+		if (t < (1ULL << i))
+			break;
+	ds->lat[i]++;
+	pthread_mutex_unlock(&ds_mutex);
+}
+
+/*
+ * copy the statistics of up to max active drives into buf,
+ * returns the number of drives copied
+ */
+int diskstats_copy(diskstats_t *buf, int max)
+{
+	diskstats_t *ds;
+	int n = 0;
+
+	pthread_mutex_lock(&ds_mutex);
+	for (ds = active; ds != NULL && n < max; ds = ds->link)
+		buf[n++] = *ds;
+	pthread_mutex_unlock(&ds_mutex);
+
+	return n;
+}
+
+/*
+ * reset the statistics of all drives
+ */
+void diskstats_clear(void)
+{
+	diskstats_t *ds;
+
+	pthread_mutex_lock(&ds_mutex);
+	for (ds = active; ds != NULL; ds = ds->link) {
+		ds->reads = ds->writes = 0;
+		ds->rbytes = ds->wbytes = 0;
+		ds->seeks = ds->errors = 0;
+		ds->seq = ds->rnd = 0;
+		memset(ds->lat, 0, sizeof(ds->lat));
+	}
+	pthread_mutex_unlock(&ds_mutex);
+}
+
+/*
+ * print the statistics of all drives
+ */
+void diskstats_print(void)
+{
+	diskstats_t dss[DS_MAXDRIVES], *ds;
+	uint64_t n;
+	int i, j, ndrives;
+
+	if ((ndrives = diskstats_copy(dss, DS_MAXDRIVES)) == 0) {
+		puts("No disk I/O");
+		return;
+	}
+
+	printf("%-24s %10s %10s %10s %10s %8s %6s %4s\n", "Drive", "Reads",
+	       "Writes", "KB read", "KB written", "Seeks", "Errors", "Seq%");
+	for (j = 0, ds = dss; j < ndrives; j++, ds++) {
+		n = ds->seq + ds->rnd;
+		printf("%-10s %-13s %10" PRIu64 " %10" PRIu64 " %10" PRIu64
+		       " %10" PRIu64 " %8" PRIu64 " %6" PRIu64 " %4d\n",
+		       ds->ctrl, ds->drive, ds->reads, ds->writes,
+		       ds->rbytes >> 10, ds->wbytes >> 10, ds->seeks,
+		       ds->errors, n ? (int) (ds->seq * 100 / n) : 0);
+		printf("  latency:");
+		for (i = 0; i < DS_BUCKETS; i++) {
+			if (ds->lat[i] == 0)
+				continue;
+			if (i < DS_BUCKETS - 1)
+				printf(" <%" PRIu64 "us:%" PRIu64,
+				       (uint64_t) 1 << i, ds->lat[i]);
+			else
+				printf(" more:%" PRIu64, ds->lat[i]);
+		}
+		putchar('\n');
+	}
+}
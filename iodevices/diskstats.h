@@ -0,0 +1,54 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Common I/O devices used by various simulated machines
+ *
+ * This module collects disk I/O statistics of the emulated disk
+ * controllers, see diskstats.c for details.
+ *
+ * History:
+ * 18-OCT-2026 first version
+ * 18-OCT-2026 protect the statistics with a mutex
+ */
+
+#ifndef DISKSTATS_INC
+#define DISKSTATS_INC
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "sim.h"
+#include "simdefs.h"
+
+#define DS_BUCKETS	16	/* latency histogram buckets */
+#define DS_MAXDRIVES	64	/* max. drives copied by readers */
+
+typedef struct diskstats {
+	const char *ctrl;		/* name of controller */
+	const char *drive;		/* name of drive */
+	uint64_t reads;			/* number of read transfers */
+	uint64_t writes;		/* number of write transfers */
+	uint64_t rbytes;		/* bytes read */
+	uint64_t wbytes;		/* bytes written */
+	uint64_t seeks;			/* number of track changes */
+	uint64_t errors;		/* number of failed transfers */
+	uint64_t seq;			/* transfers following the previous */
+	uint64_t rnd;			/* other transfers */
+	uint64_t lat[DS_BUCKETS];	/* host latency histogram, bucket i */
+					/* counts latencies < 2^i us */
+	int track;			/* track of last transfer */
+	off_t next;			/* image offset after last transfer */
+	bool active;			/* in list of active drives */
+	struct diskstats *link;		/* next active drive */
+} diskstats_t;
+
+#define DISKSTATS_INIT(c, d)	{ .ctrl = (c), .drive = (d) }
+
+extern uint64_t diskstats_start(void);
+extern void diskstats_io(diskstats_t *ds, bool write, int track,
+			 off_t pos, size_t len, uint64_t t0, bool ok);
+extern int diskstats_copy(diskstats_t *buf, int max);
+extern void diskstats_clear(void);
+extern void diskstats_print(void);
+
+#endif /* !DISKSTATS_INC */
@@ -12,6 +12,7 @@
  * 23-OCT-2019	1.3	Put Telnet protocol under modem register control
  * 16-JUL-2020	1.4	fix bug/warning detected with gcc 9
  * 17-JUL-2020	1.5	Added/Update AT$ help, ATE, ATQ, AT&A1 cmds, MODEM.init string
+ * 18-OCT-2026	1.6	Buffered socket I/O in a pump thread, RING driven by events
  */
 
 #include <unistd.h>
@@ -19,6 +20,9 @@
 #include <ctype.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <pthread.h>
 
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -33,6 +37,8 @@
 #include "simport.h"
 
 #include "libtelnet.h"
+#include "ringbuf.h"
+#include "outbuf.h"
 
 #include "generic-at-modem.h"
 
@@ -118,6 +124,31 @@ static telnet_telopt_t telnet_opts[10];
 
 static bool carrier_detect;
 
+/**
+ * Socket I/O is done by a pump thread, which waits with poll() for the
+ * connected socket and the answer socket. It reads what arrives, runs
+ * it through libtelnet if enabled and puts the data into rx_rb, so that
+ * the guest polls only test memory. Output is collected in tx_buf and
+ * sent by the pump after TX_DELAY_US. A connection arriving on the
+ * answer socket sets ring_pending for the AT command state machine.
+ *
+ * The CPU thread opens and closes the sockets. The pump reads, flushes
+ * and calls libtelnet with pump_mutex locked, the CPU thread holds it
+ * while changing pump_fd or calling libtelnet.
+ */
+#define TX_DELAY_US	1000	/* delay before collected output is sent */
+#define RX_RETRY_MS	10	/* poll timeout while rx_rb is full */
+
+static pthread_mutex_t pump_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int pump_fd = -1;	/* connected socket served by the pump */
+static int pump_wake[2] = { -1, -1 };	/* pipe to wake up the pump */
+static ringbuf_t rx_rb;		/* received data */
+static outbuf_t tx_buf;		/* data to send */
+static bool ring_pending;	/* connection waiting on answer socket */
+
+static void pump_start(void);
+static void pump_wakeup(void);
+
 static void init_telnet_opts(void)
 {
 	int i = 0;
@@ -150,8 +181,21 @@ static void init_telnet_opts(void)
 #define TELNET_TTYPE	"ansi"
 
 static telnet_t *telnet =  NULL;
-static unsigned char tn_recv;
-static int tn_len = 0;
+
+/*
+ * collect output for the pump
+ */
+static void tx_put(const char *data, size_t len)
+{
+	bool wake = !outbuf_pending(&tx_buf);
+
+	while (len--) {
+		if (!outbuf_put(&tx_buf, pump_fd, (BYTE) *data++))
+			LOGE(TAG, "can't send data to socket");
+	}
+	if (wake)
+		pump_wakeup();
+}
 
 static void telnet_hdlr(telnet_t *telnet, telnet_event_t *ev, void *user_data)
 {
@@ -163,15 +207,10 @@ static void telnet_hdlr(telnet_t *telnet, telnet_event_t *ev, void *user_data)
 
 	switch (ev->type) {
 	case TELNET_EV_DATA:
-		if (ev->data.size) {
-			if (ev->data.size != 1) {
-				LOGW(TAG, "LONGER THAN EXPECTED [%zd]", ev->data.size);
-			} else {
-				tn_recv = *(ev->data.buffer);
-				tn_len = ev->data.size;
-			}
-			LOGD(TAG, "Telnet IN: %c[%zd]", tn_recv, ev->data.size);
-		}
+		/* called by the pump, rx_rb has room for all data */
+		for (i = 0; i < (int) ev->data.size; i++)
+			rb_put(&rx_rb, (BYTE) ev->data.buffer[i]);
+		LOGD(TAG, "Telnet IN: [%zd]", ev->data.size);
 		break;
 	case TELNET_EV_SEND:
 		if (ev->data.size) {
@@ -180,8 +219,7 @@ static void telnet_hdlr(telnet_t *telnet, telnet_event_t *ev, void *user_data)
 				p += sprintf(p, "%d ", *(ev->data.buffer + i));
 			LOGD(TAG, "Telnet OUT: %s[%zd]", buf, ev->data.size);
 		}
-		if (write(*active_sfd, ev->data.buffer, ev->data.size) != (ssize_t) ev->data.size)
-			LOGE(TAG, "Telnet OUT: can't send data");
+		tx_put(ev->data.buffer, ev->data.size);
 		break;
 	case TELNET_EV_WILL:
 		if (ev->neg.telopt == TELNET_TELOPT_SGA) {
@@ -245,12 +283,20 @@ static void telnet_hdlr(telnet_t *telnet, telnet_event_t *ev, void *user_data)
 
 static void close_socket(void)
 {
+	pthread_mutex_lock(&pump_mutex);
 	if (telnet != NULL) {
 		telnet_free(telnet);
 		telnet = NULL;
 		LOGI(TAG, "Telnet session ended");
 	}
 
+	if (*active_sfd == pump_fd) {
+		/* send what is left, then stop the pump using it */
+		outbuf_flush(&tx_buf, pump_fd, true);
+		__atomic_store_n(&pump_fd, -1, __ATOMIC_RELEASE);
+		rb_reset(&rx_rb);
+	}
+
 	if (shutdown(*active_sfd, SHUT_RDWR) == 0) {
 		LOGI(TAG, "Socket shutdown");
 	}
@@ -259,6 +305,18 @@ static void close_socket(void)
 		*active_sfd = 0;
 	}
 	carrier_detect = false;
+	pthread_mutex_unlock(&pump_mutex);
+	pump_wakeup();
+}
+
+/*
+ * let the pump serve a connected socket
+ */
+static void pump_connect(int fd)
+{
+	outbuf_discard(&tx_buf);
+	rb_reset(&rx_rb);
+	__atomic_store_n(&pump_fd, fd, __ATOMIC_RELEASE);
 }
 
 static int open_socket(void)
@@ -330,17 +388,23 @@ static int open_socket(void)
 			return 1;
 		}
 
+		pthread_mutex_lock(&pump_mutex);
+		pump_connect(sfd);
+
 		/* Initialize Telnet session */
 		if (s_reg[SREG_TELNET]) {
 			init_telnet_opts();
 			if ((telnet = telnet_init(telnet_opts, telnet_hdlr, 0, NULL)) == 0) {
 				LOGE(TAG, "can't initialize telnet session");
+				pthread_mutex_unlock(&pump_mutex);
 				close_socket();
 				return 1;
 			} else {
 				LOGI(TAG, "Telnet session started");
 			};
 		};
+		pthread_mutex_unlock(&pump_mutex);
+		pump_wakeup();
 
 		return 0;
 	}
@@ -410,6 +474,7 @@ static int answer_init(void)
 	listen(answer_sfd, 1);
 	inet_ntop(AF_INET, &serv_addr.sin_addr, addr, 100);
 	LOGI(TAG, "Listening on %s:%d", addr, ntohs(serv_addr.sin_port));
+	pump_wakeup();
 	return 0;
 }
 
@@ -421,8 +486,12 @@ static int answer(void)
 
 	clilen = sizeof(cli_addr);
 	newsockfd = accept(answer_sfd, (struct sockaddr *) &cli_addr, &clilen);
+	/* let the pump watch the answer socket again */
+	__atomic_store_n(&ring_pending, false, __ATOMIC_RELEASE);
+	pump_wakeup();
 	if (newsockfd < 0) {
 		LOGE(TAG, "ERROR on accept");
+		newsockfd = 0;
 		return 1;
 	}
 
@@ -437,11 +506,15 @@ static int answer(void)
 		return 1;
 	}
 
+	pthread_mutex_lock(&pump_mutex);
+	pump_connect(newsockfd);
+
 	/* Initialize Telnet session */
 	if (s_reg[SREG_TELNET]) {
 		init_telnet_opts();
 		if ((telnet = telnet_init(telnet_opts, telnet_hdlr, 0, NULL)) == 0) {
 			LOGE(TAG, "can't initialize telnet server session");
+			pthread_mutex_unlock(&pump_mutex);
 			close_socket();
 			return 1;
 		} else {
@@ -452,42 +525,181 @@ static int answer(void)
 		telnet_negotiate(telnet, (s_reg[SREG_TN_ECHO] & 1) ? TELNET_WILL : TELNET_WONT,
 				 TELNET_TELOPT_ECHO);
 	};
+	pthread_mutex_unlock(&pump_mutex);
+	pump_wakeup();
 
 	return 0;
 }
 
+/*
+ * RING every 3 seconds while the pump reports a waiting connection
+ */
 static int answer_check_ring(void)
 {
-	struct pollfd p[1];
 	static int ringing = 0;
 	static uint64_t ring_t1, ring_t2;
 	int tdiff;
 
-	if (answer_sfd) {
+	if (answer_sfd && __atomic_load_n(&ring_pending, __ATOMIC_ACQUIRE)) {
 		if (ringing) {
 			ring_t2 = get_clock_us();
 			tdiff = (ring_t2 - ring_t1) / 1000000;
 			if (tdiff < 3)
 				return 0;
-			else
-				ringing = 0;
 		}
 
-		p[0].fd = answer_sfd;
-		p[0].events = POLLIN;
-		p[0].revents = 0;
-		poll(p, 1, 0);
-
-		if (p[0].revents == POLLIN) {
-			if (!ringing) {
-				ring_t1 = get_clock_us();
-				ringing = 1;
-				LOGI(TAG, "Ringing");
+		ring_t1 = get_clock_us();
+		ringing = 1;
+		LOGI(TAG, "Ringing");
+		return 1;
+	}
+	return 0;
+}
+
+/*************************************************************************************************/
+
+/*
+ * wake up the pump, so that it sees new output or changed sockets
+ */
+static void pump_wakeup(void)
+{
+	char c = 0;
+
+	if (pump_wake[1] != -1 && write(pump_wake[1], &c, 1) == -1 && errno != EAGAIN)
+		LOGW(TAG, "can't wake socket pump");
+}
+
+/*
+ * read what arrived on the connected socket into rx_rb,
+ * must be called with pump_mutex locked
+ */
+static void pump_read(int fd)
+{
+	char buf[RB_SIZE];
+	size_t space;
+	ssize_t n, i;
+
+	if (fd != pump_fd || rb_closed(&rx_rb) || (space = rb_space(&rx_rb)) == 0)
+		return;
+
+	n = read(fd, buf, space);
+	if (n == 0 || (n == -1 && errno != EINTR && errno != EAGAIN)) {
+		/* disconnected, the AT state machine reports it */
+		rb_close(&rx_rb);
+	} else if (n > 0) {
+		if (telnet != NULL)
+			telnet_recv(telnet, buf, n);
+		else
+			for (i = 0; i < n; i++)
+				rb_put(&rx_rb, (BYTE) buf[i]);
+	}
+}
+
+/*
+ * thread moving data between the sockets and the buffers
+ */
+static void *pump_thread(void *arg)
+{
+	struct pollfd p[3];
+	int n, fd, afd, timeout;
+	uint64_t now, tx_due = 0;
+	char c;
+
+	UNUSED(arg);
+
+	while (true) {
+		pthread_mutex_lock(&pump_mutex);
+		fd = pump_fd;
+		afd = answer_sfd;
+		timeout = -1;
+
+		/* send collected output TX_DELAY_US after the first byte */
+		if (fd != -1 && outbuf_pending(&tx_buf)) {
+			now = get_clock_us();
+			if (tx_due == 0)
+				tx_due = now + TX_DELAY_US;
+			if (now >= tx_due) {
+				outbuf_flush(&tx_buf, fd, false);
+				tx_due = 0;
 			}
-			return 1;
+			if (outbuf_pending(&tx_buf)) {
+				if (tx_due == 0)
+					tx_due = now + TX_DELAY_US;
+				timeout = (tx_due - now + 999) / 1000;
+			}
+		} else
+			tx_due = 0;
+
+		p[0].fd = pump_wake[0];
+		p[0].events = POLLIN;
+		n = 1;
+		if (fd != -1 && !rb_closed(&rx_rb)) {
+			if (rb_space(&rx_rb) > 0) {
+				p[n].fd = fd;
+				p[n++].events = POLLIN;
+			} else if (timeout == -1 || timeout > RX_RETRY_MS)
+				timeout = RX_RETRY_MS;
+		}
+		if (afd && !__atomic_load_n(&ring_pending, __ATOMIC_ACQUIRE)) {
+			p[n].fd = afd;
+			p[n++].events = POLLIN;
+		}
+		pthread_mutex_unlock(&pump_mutex);
+
+		p[0].revents = p[1].revents = p[2].revents = 0;
+		if (poll(p, n, timeout) == -1) {
+			if (errno != EINTR)
+				LOGW(TAG, "can't poll sockets");
+			continue;
+		}
+
+		if (p[0].revents)
+			while (read(pump_wake[0], &c, 1) == 1)
+				;
+
+		pthread_mutex_lock(&pump_mutex);
+		for (n = n - 1; n > 0; n--) {
+			if (p[n].revents == 0)
+				continue;
+			if (p[n].fd == afd && afd == answer_sfd)
+				__atomic_store_n(&ring_pending, true, __ATOMIC_RELEASE);
+			else
+				pump_read(p[n].fd);
 		}
+		pthread_mutex_unlock(&pump_mutex);
 	}
-	return 0;
+
+	return NULL;
+}
+
+/*
+ * start the pump thread, once
+ */
+static void pump_start(void)
+{
+	pthread_t thread;
+	sigset_t set, oset;
+	int i;
+
+	if (pump_wake[0] != -1)
+		return;
+
+	outbuf_init(&tx_buf, true);
+	if (pipe(pump_wake) == -1) {
+		LOGE(TAG, "can't create pipe for socket pump");
+		exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < 2; i++)
+		fcntl(pump_wake[i], F_SETFL, fcntl(pump_wake[i], F_GETFL, 0) | O_NONBLOCK);
+	/* signals are handled by the CPU thread */
+	sigfillset(&set);
+	pthread_sigmask(SIG_BLOCK, &set, &oset);
+	if (pthread_create(&thread, NULL, pump_thread, NULL) != 0) {
+		LOGE(TAG, "can't create socket pump thread");
+		exit(EXIT_FAILURE);
+	}
+	pthread_detach(thread);
+	pthread_sigmask(SIG_SETMASK, &oset, NULL);
 }
 
 /*************************************************************************************************/
@@ -1061,32 +1273,31 @@ bool modem_device_alive(int i)
 	return false;
 }
 
-static int _read(void)
+/*
+ * check for a disconnect reported by the pump, once all received
+ * data is read
+ */
+static bool disconnected(void)
 {
-	unsigned char data;
-
-	if (read(*active_sfd, &data, 1) == 0) {
-		/* this will occur if the socket is disconnected */
-		LOGI(TAG, "Socket disconnected");
-		at_buf[0] = 0;
-		at_cat_s(CRLF AT_NO_CARRIER);
-		hangup_timeout(true);
-		at_cmd[0] = 0;
-		at_state = cmd;
-		carrier_detect = false;
-
-		return -1;
-	}
+	if (!rb_closed(&rx_rb) || !rb_empty(&rx_rb))
+		return false;
+
+	/* this will occur if the socket is disconnected */
+	LOGI(TAG, "Socket disconnected");
+	at_buf[0] = 0;
+	at_cat_s(CRLF AT_NO_CARRIER);
+	hangup_timeout(true);
+	at_cmd[0] = 0;
+	at_state = cmd;
+	carrier_detect = false;
 
-	return data;
+	return true;
 }
 
 int modem_device_poll(int i)
 {
 	UNUSED(i);
 
-	struct pollfd p[1];
-
 	if (at_state == help) {
 		if (strlen(at_buf) == 0) {
 			at_cat_s(*msg);
@@ -1108,34 +1319,11 @@ int modem_device_poll(int i)
 		}
 		return 0;
 	} else if (at_state == dat  && strlen(at_out) == 0) {
-		/**
-		 * In telnet mode this "clocks" the inbound connection into telnet_recv()
-		 * and lets the event handler buffer the input (1 character)
-		 * then it can check the buffer and report on available data in the buffer
-		 */
-
-		if ((telnet != NULL) && tn_len)
+		/* the pump did the socket I/O and telnet processing */
+		if (!rb_empty(&rx_rb))
 			return POLLIN;
-
-		p[0].fd = *active_sfd;
-		p[0].events = POLLIN | POLLOUT;
-		p[0].revents = 0;
-		poll(p, 1, 0);
-
-		if (telnet == NULL)
-			return p[0].revents & POLLIN;
-
-		if (p[0].revents & POLLIN) {
-			int res;
-			char data;
-			res = _read();
-			if (res != -1) {
-				data = res;
-				telnet_recv(telnet, (char *) &data, 1);
-			}
-			if (tn_len)
-				return POLLIN;
-		}
+		if (disconnected())
+			return strlen(at_out) > 0;
 
 		return 0;
 	} else {
@@ -1157,27 +1345,13 @@ int modem_device_get(int i)
 {
 	UNUSED(i);
 
-	struct pollfd p[1];
-	unsigned char data;
+	BYTE data;
 
 	if (at_state == dat && strlen(at_out) == 0) {
-		if (telnet != NULL) {
-			if (tn_len) {
-				tn_len = 0;
-				return tn_recv;
-			} else
-				return -1;
-		} else {
-			p[0].fd = *active_sfd;
-			p[0].events = POLLIN;
-			p[0].revents = 0;
-			poll(p, 1, 0);
-
-			if (!(p[0].revents & POLLIN))
-				return -1;
-
-			return _read();
-		}
+		if (rb_get(&rx_rb, &data))
+			return data;
+		disconnected();
+		return -1;
 	} else {
 		if (strlen(at_out) > 0) {
 			data = *at_out;
@@ -1208,13 +1382,12 @@ void modem_device_send(int i, char data)
 			at_t1 = get_clock_us();
 			return;
 		} else {
+			pthread_mutex_lock(&pump_mutex);
 			if (telnet != NULL)
 				telnet_send(telnet, at_buf, strlen(at_buf));
-			else {
-				if (write(*active_sfd, at_buf, strlen(at_buf))
-				    != (ssize_t) strlen(at_buf))
-					LOGE(TAG, "can't send at_buf to active_sfd");
-			}
+			else
+				tx_put(at_buf, strlen(at_buf));
+			pthread_mutex_unlock(&pump_mutex);
 
 			at_state = dat;
 		}
@@ -1234,12 +1407,12 @@ void modem_device_send(int i, char data)
 			at_state = intr;
 			return;
 		}
+		pthread_mutex_lock(&pump_mutex);
 		if (telnet != NULL)
-			telnet_send(telnet, (char *) &data, 1);
-		else {
-			if (write(*active_sfd, (char *) &data, 1) != 1)
-				LOGE(TAG, "can't send data to active_sfd");
-		}
+			telnet_send(telnet, &data, 1);
+		else
+			tx_put(&data, 1);
+		pthread_mutex_unlock(&pump_mutex);
 		break;
 	/***
 	 * AT command mode
@@ -1304,13 +1477,15 @@ bool modem_device_carrier(int i)
 
 void modem_device_init(void)
 {
+	pump_start();
+
 	if (*active_sfd)
 		close_socket();
 	if (answer_sfd) {
 		active_sfd = &answer_sfd;
 		close_socket();
 		active_sfd = &sfd;
-
+		__atomic_store_n(&ring_pending, false, __ATOMIC_RELEASE);
 	}
 	at_state = cmd;
 
@@ -0,0 +1,784 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Common I/O devices used by various simulated machines
+ *
+ * This module emulates a CP/M 2.2 disk from the files in a host
+ * directory. The CP/M directory and allocation map are synthesized
+ * from the host files, data sectors are read straight from the host
+ * files and data written by the guest is written back to them.
+ *
+ * Host files with valid CP/M 8.3 names are shown in user area 0,
+ * other files and subdirectories are ignored. New host files get
+ * the highest free blocks, so that they are unlikely to collide with
+ * an allocation vector the guest built before the change.
+ *
+ * Whenever the guest writes a directory sector, the files whose
+ * directory entries changed or whose blocks were written are written
+ * back to the host directory. Files erased by the guest are removed
+ * from the host directory. Only user area 0 is written back.
+ *
+ * Changes made on the host are picked up when the guest reads the
+ * first directory sector again, which happens after a disk reset
+ * (^C) or when searching for a file, unless the guest has written
+ * data which isn't in the directory yet.
+ *
+ * The system tracks are kept in memory only, so a host directory
+ * disk can't be used as boot disk.
+ *
+ * History:
+ * 18-OCT-2026 first version
+ */
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "sim.h"
+#include "simdefs.h"
+
+#include "hostdisk.h"
+
+/* #define LOG_LOCAL_LEVEL LOG_DEBUG */
+#include "log.h"
+static const char *TAG = "hostdisk";
+
+#define SECLEN		128	/* CP/M record length */
+#define DIRLEN		32	/* length of a directory entry */
+#define NAMELEN		11	/* file name and type in a directory entry */
+#define EMPTY		0xe5	/* unused directory entry, formatted data */
+#define CTRL_Z		0x1a	/* CP/M EOF character */
+#define RESCAN_SECS	1	/* min. seconds between host directory scans */
+
+#define B_LOADED	1	/* block data is in the image */
+#define B_DIRTY		2	/* block written since last write back */
+
+/*
+ *	Disk formats which can be synthesized, the parameters must
+ *	match the disk parameter blocks in the BIOS's
+ */
+typedef struct hdfmt {
+	unsigned int tracks;	/* number of tracks */
+	unsigned int spt;	/* sectors per track */
+	unsigned int bls;	/* allocation block size */
+	unsigned int dsm;	/* number of blocks - 1 */
+	unsigned int drm;	/* number of directory entries - 1 */
+	unsigned int off;	/* number of system tracks */
+	const BYTE *xlt;	/* sector translation table or NULL */
+} hdfmt_t;
+
+static const BYTE xlt_ibm8sd[26] = {
+	1, 7, 13, 19, 25, 5, 11, 17, 23, 3, 9, 15, 21,
+	2, 8, 14, 20, 26, 6, 12, 18, 24, 4, 10, 16, 22
+};
+
+static const hdfmt_t formats[] = {
+	{ 77, 26, 1024, 242, 63, 2, xlt_ibm8sd },	/* IBM 8" SS SD */
+	{ 255, 128, 2048, 2039, 1023, 0, NULL }		/* 4 MB harddisk */
+};
+
+/*
+ *	Host file shown in the CP/M directory
+ */
+typedef struct hdfile {
+	BYTE name[NAMELEN];	/* CP/M file name and type, 0 if unused */
+	char host[16];		/* host file name */
+	off_t size;		/* size and modification time of the */
+	time_t mtime;		/* host file when last seen */
+} hdfile_t;
+
+struct hostdisk {
+	char path[MAX_LFN];	/* host directory */
+	const hdfmt_t *fmt;	/* disk format */
+	unsigned int rpb;	/* records per block */
+	unsigned int dirblks;	/* blocks used by the directory */
+	unsigned int nptr;	/* block pointers per directory entry */
+	unsigned int exm;	/* extent mask */
+	BYTE p2l[256];		/* physical to logical sector */
+	BYTE *sys;		/* system tracks */
+	BYTE *image;		/* directory and data blocks */
+	BYTE *bstate;		/* block state B_xxx */
+	int *owner;		/* host file holding a not loaded block */
+	unsigned int *boff;	/* block number within that host file */
+	BYTE *used;		/* scratch map of allocated blocks */
+	hdfile_t *files;	/* host files, at most one per dir entry */
+	int fd;			/* cached fd for reading a host file */
+	int fd_file;		/* host file of the cached fd */
+	bool pending;		/* data written, directory not yet */
+	time_t scanned;		/* time of last host directory scan */
+};
+
+/*
+ *	Convert a host file name into a CP/M file name and type,
+ *	returns false if it isn't a valid CP/M name
+ */
+static bool cpm_name(const char *host, BYTE *name)
+{
+	register int i, n;
+	const char *s = host;
+
+	memset(name, ' ', NAMELEN);
+	for (i = 0, n = 8; *s != '\0'; s++) {
+		if (*s == '.') {
+			if (i == 0 || n == NAMELEN || s[1] == '\0')
+				return false;
+			i = 8;
+			n = NAMELEN;
+			continue;
+		}
+		if (i == n || (!isalnum((unsigned char) *s)
+			       && strchr("!#$%&'()-@^_{}~", *s) == NULL))
+			return false;
+		name[i++] = toupper((unsigned char) *s);
+	}
+	return i > 0;
+}
+
+/*
+ *	Convert a CP/M file name and type into a host file name,
+ *	returns false if it can't be used on the host
+ */
+static bool host_name(const BYTE *name, char *host)
+{
+	register int i;
+	register char c;
+	char *d = host;
+
+	for (i = 0; i < NAMELEN; i++) {
+		c = name[i] & 0x7f;
+		if (i == 8 && c != ' ')
+			*d++ = '.';
+		if (c == ' ')
+			continue;
+		if (c == '/' || c == '.' || !isprint((unsigned char) c))
+			return false;
+		*d++ = tolower((unsigned char) c);
+	}
+	*d = '\0';
+	return d != host && *host != '.';
+}
+
+static int find_file(hostdisk_t *hd, const BYTE *name)
+{
+	register unsigned int f;
+
+	for (f = 0; f <= hd->fmt->drm; f++)
+		if (memcmp(hd->files[f].name, name, NAMELEN) == 0)
+			return f;
+	return -1;
+}
+
+/*
+ *	Return the fd for reading host file f
+ */
+static int file_fd(hostdisk_t *hd, int f)
+{
+	char fn[MAX_LFN + 256];
+
+	if (hd->fd_file == f)
+		return hd->fd;
+
+	if (hd->fd != -1)
+		close(hd->fd);
+	snprintf(fn, sizeof(fn), "%s/%s", hd->path, hd->files[f].host);
+	hd->fd = open(fn, O_RDONLY);
+	hd->fd_file = (hd->fd != -1) ? f : -1;
+	return hd->fd;
+}
+
+static void file_fd_close(hostdisk_t *hd)
+{
+	if (hd->fd != -1)
+		close(hd->fd);
+	hd->fd = -1;
+	hd->fd_file = -1;
+}
+
+/*
+ *	Read part of block b from the host file owning it,
+ *	the data beyond the end of the file reads as CP/M EOF
+ */
+static void read_host(hostdisk_t *hd, unsigned int b, unsigned int pos,
+		      BYTE *buf, unsigned int len)
+{
+	register int fd;
+	ssize_t n = 0;
+
+	if ((fd = file_fd(hd, hd->owner[b])) != -1)
+		n = pread(fd, buf, len,
+			  (off_t) hd->boff[b] * hd->fmt->bls + pos);
+	if (n < 0) {
+		LOGW(TAG, "can't read %s", hd->files[hd->owner[b]].host);
+		n = 0;
+	}
+	memset(buf + n, CTRL_Z, len - n);
+}
+
+/*
+ *	Bring the data of block b into the image
+ */
+static void load_block(hostdisk_t *hd, unsigned int b)
+{
+	BYTE *p = hd->image + b * hd->fmt->bls;
+
+	if (hd->bstate[b] & B_LOADED)
+		return;
+
+	if (hd->owner[b] != -1)
+		read_host(hd, b, 0, p, hd->fmt->bls);
+	else
+		memset(p, EMPTY, hd->fmt->bls);
+	hd->bstate[b] |= B_LOADED;
+}
+
+/*
+ *	Directory entry helpers
+ */
+static inline BYTE *dir_entry(hostdisk_t *hd, unsigned int i)
+{
+	return hd->image + i * DIRLEN;
+}
+
+static inline unsigned int entry_block(hostdisk_t *hd, const BYTE *e,
+				       unsigned int k)
+{
+	unsigned int b;
+
+	if (hd->nptr == 16)
+		b = e[16 + k];
+	else
+		b = e[16 + 2 * k] | (e[17 + 2 * k] << 8);
+	return (b < hd->dirblks || b > hd->fmt->dsm) ? 0 : b;
+}
+
+static inline unsigned int entry_extent(const BYTE *e)
+{
+	return ((e[14] & 0x3f) << 5) | (e[12] & 0x1f);
+}
+
+static inline bool entry_is(const BYTE *e, const BYTE *name)
+{
+	register int i;
+
+	if (e[0] != 0)
+		return false;
+	for (i = 0; i < NAMELEN; i++)
+		if ((e[1 + i] & 0x7f) != name[i])
+			return false;
+	return true;
+}
+
+static inline void entry_name(const BYTE *e, BYTE *name)
+{
+	register int i;
+
+	for (i = 0; i < NAMELEN; i++)
+		name[i] = e[1 + i] & 0x7f;
+}
+
+/*
+ *	Build the map of the blocks allocated in the directory
+ */
+static void build_used(hostdisk_t *hd)
+{
+	register unsigned int i, k, b;
+	BYTE *e;
+
+	memset(hd->used, 0, hd->fmt->dsm + 1);
+	memset(hd->used, 1, hd->dirblks);
+	for (i = 0; i <= hd->fmt->drm; i++) {
+		e = dir_entry(hd, i);
+		if (e[0] > 0x1f)	/* unused, label or time stamps */
+			continue;
+		for (k = 0; k < hd->nptr; k++)
+			if ((b = entry_block(hd, e, k)) != 0)
+				hd->used[b] = 1;
+	}
+}
+
+/*
+ *	Add host file "host" to the directory
+ */
+static void add_file(hostdisk_t *hd, const char *host, const BYTE *name,
+		     struct stat *st, bool top)
+{
+	const hdfmt_t *fmt = hd->fmt;
+	unsigned int nblks, nents, recs, r, i, j, k, b, nfree;
+	unsigned int ext, lx, epr = (hd->exm + 1) * 128;
+	int f;
+	BYTE *e;
+
+	if (st->st_size > (off_t) (fmt->dsm + 1 - hd->dirblks) * fmt->bls) {
+		LOGW(TAG, "%s/%s doesn't fit on the disk", hd->path, host);
+		return;
+	}
+	nblks = (st->st_size + fmt->bls - 1) / fmt->bls;
+	recs = (st->st_size + SECLEN - 1) / SECLEN;
+	nents = (nblks + hd->nptr - 1) / hd->nptr;
+	if (nents == 0)
+		nents = 1;
+
+	/* check for enough free directory entries and blocks */
+	for (i = 0, j = 0; i <= fmt->drm; i++)
+		if (*dir_entry(hd, i) == EMPTY)
+			j++;
+	build_used(hd);
+	for (b = hd->dirblks, nfree = 0; b <= fmt->dsm; b++)
+		if (!hd->used[b])
+			nfree++;
+	for (f = 0; f <= (int) fmt->drm && hd->files[f].name[0] != 0; f++)
+		;
+	if (j < nents || nfree < nblks || f > (int) fmt->drm) {
+		LOGW(TAG, "no space left for %s/%s", hd->path, host);
+		return;
+	}
+
+	memcpy(hd->files[f].name, name, NAMELEN);
+	strcpy(hd->files[f].host, host);
+	hd->files[f].size = st->st_size;
+	hd->files[f].mtime = st->st_mtime;
+
+	b = top ? fmt->dsm : hd->dirblks;
+	for (i = 0, j = 0; j < nents; j++) {
+		while (*(e = dir_entry(hd, i)) != EMPTY)
+			i++;
+		memset(e, 0, DIRLEN);
+		memcpy(e + 1, name, NAMELEN);
+		r = recs - j * epr;
+		if (r > epr)
+			r = epr;
+		lx = (r > 0) ? (r - 1) / 128 : 0;
+		ext = j * (hd->exm + 1) + lx;
+		e[12] = ext & 0x1f;
+		e[14] = ext >> 5;
+		e[15] = r - lx * 128;
+		for (k = 0; k < hd->nptr && j * hd->nptr + k < nblks; k++) {
+			while (hd->used[b])
+				b = top ? b - 1 : b + 1;
+			hd->used[b] = 1;
+			hd->owner[b] = f;
+			hd->boff[b] = j * hd->nptr + k;
+			hd->bstate[b] = 0;
+			if (hd->nptr == 16)
+				e[16 + k] = b;
+			else {
+				e[16 + 2 * k] = b & 0xff;
+				e[17 + 2 * k] = b >> 8;
+			}
+		}
+	}
+
+	LOGD(TAG, "added %s/%s", hd->path, host);
+}
+
+/*
+ *	Remove host file f from the directory and free its blocks
+ */
+static void remove_file(hostdisk_t *hd, int f)
+{
+	register unsigned int i, k, b;
+	BYTE *e;
+
+	for (i = 0; i <= hd->fmt->drm; i++) {
+		e = dir_entry(hd, i);
+		if (!entry_is(e, hd->files[f].name))
+			continue;
+		for (k = 0; k < hd->nptr; k++)
+			if ((b = entry_block(hd, e, k)) != 0)
+				hd->bstate[b] = 0;
+		memset(e, EMPTY, DIRLEN);
+	}
+	for (b = hd->dirblks; b <= hd->fmt->dsm; b++)
+		if (hd->owner[b] == f)
+			hd->owner[b] = -1;
+	if (hd->fd_file == f)
+		file_fd_close(hd);
+
+	LOGD(TAG, "removed %s/%s", hd->path, hd->files[f].host);
+	memset(&hd->files[f], 0, sizeof(hdfile_t));
+}
+
+/*
+ *	Synchronize the directory with the host directory
+ */
+static void scan_host(hostdisk_t *hd, bool top)
+{
+	DIR *dir;
+	struct dirent *de;
+	struct stat st;
+	char fn[MAX_LFN + 256];
+	BYTE name[NAMELEN];
+	BYTE *seen;
+	register unsigned int f;
+	int i;
+
+	hd->scanned = time(NULL);
+
+	if ((dir = opendir(hd->path)) == NULL) {
+		LOGE(TAG, "can't open directory %s", hd->path);
+		return;
+	}
+	seen = calloc(hd->fmt->drm + 1, 1);
+
+	/* drop host files which changed or were removed */
+	while ((de = readdir(dir)) != NULL) {
+		if (!cpm_name(de->d_name, name))
+			continue;
+		if ((i = find_file(hd, name)) == -1
+		    || strcmp(hd->files[i].host, de->d_name) != 0)
+			continue;
+		snprintf(fn, sizeof(fn), "%s/%s", hd->path, de->d_name);
+		if (stat(fn, &st) == 0 && S_ISREG(st.st_mode)
+		    && st.st_size == hd->files[i].size
+		    && st.st_mtime == hd->files[i].mtime)
+			seen[i] = 1;
+	}
+	for (f = 0; f <= hd->fmt->drm; f++)
+		if (hd->files[f].name[0] != 0 && !seen[f])
+			remove_file(hd, f);
+	free(seen);
+
+	/* and add the new ones */
+	rewinddir(dir);
+	while ((de = readdir(dir)) != NULL) {
+		if (!cpm_name(de->d_name, name) || find_file(hd, name) != -1)
+			continue;
+		snprintf(fn, sizeof(fn), "%s/%s", hd->path, de->d_name);
+		if (stat(fn, &st) == 0 && S_ISREG(st.st_mode))
+			add_file(hd, de->d_name, name, &st, top);
+	}
+	closedir(dir);
+}
+
+/*
+ *	Write the CP/M file "name" back to the host directory,
+ *	or remove the host file if the CP/M file was erased.
+ *	Erased files are handled in a second pass, so that renamed
+ *	files still find their data in the old host file.
+ */
+static void write_back(hostdisk_t *hd, const BYTE *name, bool erased)
+{
+	const hdfmt_t *fmt = hd->fmt;
+	unsigned int i, k, b, n, npos = 0, ext, *map;
+	off_t size = 0, tail;
+	char fn[MAX_LFN + 256];
+	struct stat st;
+	int f, fd;
+	BYTE *e;
+
+	/* collect the blocks of the file in file order */
+	map = calloc((fmt->dsm + 1), sizeof(unsigned int));
+	for (i = 0; i <= fmt->drm; i++) {
+		e = dir_entry(hd, i);
+		if (!entry_is(e, name))
+			continue;
+		ext = entry_extent(e);
+		n = ext / (hd->exm + 1) * hd->nptr;
+		for (k = 0; k < hd->nptr && n + k <= fmt->dsm; k++)
+			map[n + k] = entry_block(hd, e, k);
+		if (n + hd->nptr > npos)
+			npos = n + hd->nptr;
+		if ((off_t) (ext * 128 + e[15]) * SECLEN > size)
+			size = (off_t) (ext * 128 + e[15]) * SECLEN;
+	}
+	if (npos > fmt->dsm + 1)
+		npos = fmt->dsm + 1;
+	if ((npos == 0) != erased) {
+		free(map);
+		return;
+	}
+
+	/* an unchanged last block of a host file keeps its exact length */
+	if (size > 0 && (b = map[(size - 1) / fmt->bls]) != 0
+	    && !(hd->bstate[b] & B_DIRTY) && hd->owner[b] != -1) {
+		tail = (hd->files[hd->owner[b]].size + SECLEN - 1)
+		       / SECLEN * SECLEN;
+		if (tail - (off_t) hd->boff[b] * fmt->bls
+		    == size - (off_t) ((size - 1) / fmt->bls) * fmt->bls)
+			size -= tail - hd->files[hd->owner[b]].size;
+	}
+
+	/* blocks still in the host file which move or go away must be
+	   loaded before the host file is changed */
+	f = find_file(hd, name);
+	build_used(hd);
+	if (f != -1) {
+		for (b = hd->dirblks; b <= fmt->dsm; b++)
+			if (hd->owner[b] == f && hd->used[b]
+			    && !(hd->boff[b] < npos && map[hd->boff[b]] == b))
+				load_block(hd, b);
+		file_fd_close(hd);
+	}
+
+	if (npos == 0) {		/* erased */
+		if (f != -1) {
+			snprintf(fn, sizeof(fn), "%s/%s", hd->path,
+				 hd->files[f].host);
+			if (unlink(fn) == -1)
+				LOGW(TAG, "can't remove %s", fn);
+			for (b = hd->dirblks; b <= fmt->dsm; b++)
+				if (hd->owner[b] == f)
+					hd->owner[b] = -1;
+			memset(&hd->files[f], 0, sizeof(hdfile_t));
+		}
+		free(map);
+		return;
+	}
+
+	if (f == -1) {			/* new file */
+		for (f = 0; f <= (int) fmt->drm && hd->files[f].name[0] != 0;
+		     f++)
+			;
+		if (f > (int) fmt->drm || !host_name(name, hd->files[f].host)) {
+			LOGW(TAG, "can't write back %.11s", name);
+			free(map);
+			return;
+		}
+		memcpy(hd->files[f].name, name, NAMELEN);
+	}
+
+	snprintf(fn, sizeof(fn), "%s/%s", hd->path, hd->files[f].host);
+	if ((fd = open(fn, O_WRONLY | O_CREAT, 0644)) == -1) {
+		LOGE(TAG, "can't write %s", fn);
+		free(map);
+		return;
+	}
+	for (i = 0; i < npos; i++) {
+		if ((b = map[i]) == 0 || (off_t) i * fmt->bls >= size)
+			continue;
+		if (hd->owner[b] == f && hd->boff[b] == i
+		    && !(hd->bstate[b] & B_DIRTY))
+			continue;	/* already in place */
+		load_block(hd, b);
+		n = fmt->bls;
+		if ((off_t) (i + 1) * fmt->bls > size)
+			n = size - (off_t) i * fmt->bls;
+		if (pwrite(fd, hd->image + b * fmt->bls, n,
+			   (off_t) i * fmt->bls) != (ssize_t) n)
+			LOGE(TAG, "can't write %s", fn);
+		hd->owner[b] = f;
+		hd->boff[b] = i;
+		hd->bstate[b] &= ~B_DIRTY;
+	}
+	if (ftruncate(fd, size) == -1)
+		LOGE(TAG, "can't truncate %s", fn);
+	if (fstat(fd, &st) == 0) {
+		hd->files[f].size = st.st_size;
+		hd->files[f].mtime = st.st_mtime;
+	}
+	close(fd);
+	free(map);
+
+	LOGD(TAG, "wrote back %s", fn);
+}
+
+/*
+ *	The guest writes directory record rec
+ */
+static void write_dir(hostdisk_t *hd, unsigned int rec, const BYTE *buf)
+{
+	BYTE names[(SECLEN / DIRLEN) * 2 + 64][NAMELEN];
+	register unsigned int i, k, b;
+	unsigned int n = 0, m;
+	BYTE *p = hd->image + rec * SECLEN, *e;
+
+	/* files whose entries in this record change */
+	for (i = 0; i < SECLEN; i += DIRLEN) {
+		if (memcmp(p + i, buf + i, DIRLEN) == 0)
+			continue;
+		if (p[i] == 0)
+			entry_name(p + i, names[n++]);
+		if (buf[i] == 0)
+			entry_name(buf + i, names[n++]);
+	}
+	memcpy(p, buf, SECLEN);
+
+	/* files with blocks written since the last write back */
+	for (i = 0; i <= hd->fmt->drm && n < sizeof(names) / NAMELEN; i++) {
+		e = dir_entry(hd, i);
+		if (e[0] != 0)
+			continue;
+		for (k = 0; k < hd->nptr; k++) {
+			b = entry_block(hd, e, k);
+			if (b != 0 && (hd->bstate[b] & B_DIRTY)) {
+				entry_name(e, names[n++]);
+				break;
+			}
+		}
+	}
+
+	for (i = 0; i < 2 * n; i++) {
+		for (m = 0; m < i % n; m++)
+			if (memcmp(names[m], names[i % n], NAMELEN) == 0)
+				break;
+		if (m == i % n)
+			write_back(hd, names[i % n], i >= n);
+	}
+
+	hd->pending = false;
+}
+
+/*
+ *	Map track/sector to the logical record in the data area,
+ *	returns false for the system tracks
+ */
+static bool map_record(hostdisk_t *hd, unsigned int track,
+		       unsigned int sector, unsigned int *rec)
+{
+	if (track < hd->fmt->off) {
+		*rec = track * hd->fmt->spt + sector - 1;
+		return false;
+	}
+	*rec = (track - hd->fmt->off) * hd->fmt->spt + hd->p2l[sector - 1];
+	return true;
+}
+
+/*
+ *	Read a sector, returns false on error
+ */
+bool hostdisk_read(hostdisk_t *hd, unsigned int track, unsigned int sector,
+		   BYTE *buf)
+{
+	unsigned int rec, b, pos;
+
+	if (sector == 0 || sector > hd->fmt->spt
+	    || track >= hd->fmt->tracks)
+		return false;
+
+	if (!map_record(hd, track, sector, &rec)) {
+		memcpy(buf, hd->sys + rec * SECLEN, SECLEN);
+		return true;
+	}
+
+	b = rec / hd->rpb;
+	pos = (rec % hd->rpb) * SECLEN;
+	if (b > hd->fmt->dsm) {
+		memset(buf, EMPTY, SECLEN);
+		return true;
+	}
+
+	if (rec == 0 && !hd->pending
+	    && time(NULL) - hd->scanned >= RESCAN_SECS)
+		scan_host(hd, true);
+
+	if (hd->bstate[b] & B_LOADED)
+		memcpy(buf, hd->image + b * hd->fmt->bls + pos, SECLEN);
+	else if (hd->owner[b] != -1)
+		read_host(hd, b, pos, buf, SECLEN);
+	else
+		memset(buf, EMPTY, SECLEN);
+	return true;
+}
+
+/*
+ *	Write a sector, returns false on error
+ */
+bool hostdisk_write(hostdisk_t *hd, unsigned int track, unsigned int sector,
+		    const BYTE *buf)
+{
+	unsigned int rec, b;
+
+	if (sector == 0 || sector > hd->fmt->spt
+	    || track >= hd->fmt->tracks)
+		return false;
+
+	if (!map_record(hd, track, sector, &rec)) {
+		memcpy(hd->sys + rec * SECLEN, buf, SECLEN);
+		return true;
+	}
+
+	b = rec / hd->rpb;
+	if (b > hd->fmt->dsm)
+		return true;
+
+	if (b < hd->dirblks) {
+		write_dir(hd, rec, buf);
+	} else {
+		load_block(hd, b);
+		memcpy(hd->image + rec * SECLEN, buf, SECLEN);
+		hd->bstate[b] |= B_DIRTY;
+		hd->pending = true;
+	}
+	return true;
+}
+
+/*
+ *	Create a disk for host directory path with the format
+ *	given by number of tracks and sectors
+ */
+hostdisk_t *hostdisk_open(const char *path, unsigned int tracks,
+			  unsigned int sectors)
+{
+	const hdfmt_t *fmt = NULL;
+	hostdisk_t *hd;
+	register unsigned int i;
+
+	for (i = 0; i < sizeof(formats) / sizeof(hdfmt_t); i++)
+		if (formats[i].tracks == tracks && formats[i].spt == sectors)
+			fmt = &formats[i];
+	if (fmt == NULL) {
+		LOGE(TAG, "no CP/M format for %s with %d tracks, %d sectors",
+		     path, tracks, sectors);
+		return NULL;
+	}
+
+	if ((hd = calloc(1, sizeof(hostdisk_t))) == NULL) {
+		LOGE(TAG, "can't allocate memory for %s", path);
+		return NULL;
+	}
+	strncpy(hd->path, path, MAX_LFN - 1);
+	hd->fmt = fmt;
+	hd->rpb = fmt->bls / SECLEN;
+	hd->dirblks = ((fmt->drm + 1) * DIRLEN + fmt->bls - 1) / fmt->bls;
+	hd->nptr = (fmt->dsm < 256) ? 16 : 8;
+	hd->exm = fmt->bls / ((fmt->dsm < 256) ? 1024 : 2048) - 1;
+	for (i = 0; i < fmt->spt; i++)
+		hd->p2l[(fmt->xlt != NULL) ? fmt->xlt[i] - 1u : i] = i;
+	hd->fd = -1;
+	hd->fd_file = -1;
+
+	hd->sys = malloc(fmt->off * fmt->spt * SECLEN + 1);
+	hd->image = malloc((fmt->dsm + 1) * fmt->bls);
+	hd->bstate = calloc(fmt->dsm + 1, 1);
+	hd->owner = malloc((fmt->dsm + 1) * sizeof(int));
+	hd->boff = calloc(fmt->dsm + 1, sizeof(unsigned int));
+	hd->used = malloc(fmt->dsm + 1);
+	hd->files = calloc(fmt->drm + 1, sizeof(hdfile_t));
+	if (hd->sys == NULL || hd->image == NULL || hd->bstate == NULL
+	    || hd->owner == NULL || hd->boff == NULL || hd->used == NULL
+	    || hd->files == NULL) {
+		LOGE(TAG, "can't allocate memory for %s", path);
+		hostdisk_close(hd);
+		return NULL;
+	}
+
+	memset(hd->sys, EMPTY, fmt->off * fmt->spt * SECLEN);
+	memset(hd->image, EMPTY, hd->dirblks * fmt->bls);
+	for (i = 0; i <= fmt->dsm; i++) {
+		hd->owner[i] = -1;
+		if (i < hd->dirblks)
+			hd->bstate[i] = B_LOADED;
+	}
+
+	scan_host(hd, false);
+	return hd;
+}
+
+void hostdisk_close(hostdisk_t *hd)
+{
+	file_fd_close(hd);
+	free(hd->sys);
+	free(hd->image);
+	free(hd->bstate);
+	free(hd->owner);
+	free(hd->boff);
+	free(hd->used);
+	free(hd->files);
+	free(hd);
+}
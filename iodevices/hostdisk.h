@@ -0,0 +1,29 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Common I/O devices used by various simulated machines
+ *
+ * This module emulates a CP/M 2.2 disk from the files in a host
+ * directory, see hostdisk.c for details.
+ *
+ * History:
+ * 18-OCT-2026 first version
+ */
+
+#ifndef HOSTDISK_INC
+#define HOSTDISK_INC
+
+#include "sim.h"
+#include "simdefs.h"
+
+typedef struct hostdisk hostdisk_t;
+
+extern hostdisk_t *hostdisk_open(const char *path, unsigned int tracks,
+				 unsigned int sectors);
+extern void hostdisk_close(hostdisk_t *hd);
+extern bool hostdisk_read(hostdisk_t *hd, unsigned int track,
+			  unsigned int sector, BYTE *buf);
+extern bool hostdisk_write(hostdisk_t *hd, unsigned int track,
+			   unsigned int sector, const BYTE *buf);
+
+#endif /* !HOSTDISK_INC */
@@ -0,0 +1,356 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Common I/O devices used by various simulated machines
+ *
+ * This module implements buffered host input for the serial devices
+ * of a hardware abstraction layer. One input thread waits with poll()
+ * on the descriptors of all registered inputs, reads what arrives into
+ * the ring buffer of the input and accepts connections on server
+ * sockets. Status reads of the CPU thread are then bit tests in memory,
+ * without a system call for every poll of the guest.
+ *
+ * Only the CPU thread closes or replaces the descriptor of an input,
+ * the input thread reads with the mutex locked and checks that the
+ * descriptor didn't change meanwhile.
+ *
+ * Telnet options are negotiated by the input thread too, it answers
+ * and strips the options the client sends after a connection was
+ * accepted, until none arrived for TELNET_TIMEOUT milliseconds.
+ *
+ * History:
+ * 18-OCT-2026 first version
+ * 18-OCT-2026 telnet negotiation without blocking the input thread
+ */
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <pthread.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include "sim.h"
+#include "simdefs.h"
+#include "simport.h"
+
+#include "unix_network.h"
+#include "hostin.h"
+
+/* #define LOG_LOCAL_LEVEL LOG_DEBUG */
+#include "log.h"
+static const char *TAG = "hostin";
+
+#define RETRY_MS	10	/* poll timeout while a ring is full */
+
+/* telnet protocol states */
+enum { TN_DATA, TN_IAC, TN_OPT, TN_SB, TN_SB_IAC };
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static hostin_t *inputs;	/* list of registered inputs */
+static int ninputs;		/* number of registered inputs */
+static int wake[2] = { -1, -1 };	/* pipe to wake up the input thread */
+
+/*
+ * let the input thread rebuild its poll set
+ */
+static void wake_thread(void)
+{
+	char c = 0;
+
+	if (wake[1] != -1 && write(wake[1], &c, 1) == -1 && errno != EAGAIN)
+		LOGW(TAG, "can't wake input thread");
+}
+
+/*
+ * telnet option negotiation for byte c received on fd, options
+ * offered by the client are rejected, returns true if c is data
+ */
+static bool telnet_filter(hostin_t *hi, int fd, BYTE c)
+{
+	BYTE opt[3];
+
+	switch (hi->tn_state) {
+	case TN_IAC:
+		if (c == 255) {		/* quoted 255 is data */
+			hi->tn_state = TN_DATA;
+			return true;
+		}
+		if (c >= 251) {		/* WILL, WONT, DO, DONT */
+			hi->tn_cmd = c;
+			hi->tn_state = TN_OPT;
+		} else if (c == 250)	/* SB */
+			hi->tn_state = TN_SB;
+		else
+			hi->tn_state = TN_DATA;
+		return false;
+
+	case TN_OPT:
+		hi->tn_state = TN_DATA;
+		hi->tn_until = get_clock_us() + TELNET_TIMEOUT * 1000ULL;
+		LOGD(TAG, "telnet: %d %d %d", 255, hi->tn_cmd, c);
+		if (c == 1 || c == 3)
+			return false;	/* ignore answers to our requests */
+		opt[0] = 255;		/* and reject other options */
+		if (hi->tn_cmd == 251)
+			opt[1] = 254;
+		else if (hi->tn_cmd == 253)
+			opt[1] = 252;
+		else
+			return false;
+		opt[2] = c;
+		if (send(fd, opt, 3, MSG_DONTWAIT) != 3)
+			LOGW(TAG, "can't write telnet option");
+		return false;
+
+	case TN_SB:			/* skip subnegotiation up to IAC SE */
+		if (c == 255)
+			hi->tn_state = TN_SB_IAC;
+		return false;
+
+	case TN_SB_IAC:
+		hi->tn_state = (c == 240) ? TN_DATA : TN_SB;
+		return false;
+
+	default:
+		if (get_clock_us() >= hi->tn_until) {
+			hi->tn_until = 0;	/* negotiation done */
+			return true;
+		}
+		if (c == 255) {
+			hi->tn_state = TN_IAC;
+			return false;
+		}
+		return true;
+	}
+}
+
+/*
+ * read what is waiting on fd into the ring of an input
+ */
+static void read_input(hostin_t *hi, int fd)
+{
+	BYTE buf[RB_SIZE];
+	size_t space;
+	ssize_t n, i;
+
+	pthread_mutex_lock(&mutex);
+	if ((hi->fd != fd) || hi->hold || rb_closed(&hi->rb) ||
+	    (space = rb_space(&hi->rb)) == 0) {
+		pthread_mutex_unlock(&mutex);
+		return;
+	}
+
+	n = read(fd, buf, space);
+	if (n == 0 || (n == -1 && errno != EINTR && errno != EAGAIN)) {
+		/* EOF or error, the CPU thread closes the descriptor */
+		rb_close(&hi->rb);
+	} else {
+		for (i = 0; i < n; i++) {
+			if (hi->tn_until && !telnet_filter(hi, fd, buf[i]))
+				continue;
+			/* telnet client sends \r\n or \r\0, drop second */
+			if (hi->skip) {
+				hi->skip = false;
+				if (buf[i] == '\n' || buf[i] == '\0')
+					continue;
+			}
+			if (hi->telnet && buf[i] == '\r')
+				hi->skip = true;
+			rb_put(&hi->rb, buf[i]);
+		}
+	}
+	pthread_mutex_unlock(&mutex);
+}
+
+/*
+ * accept a connection on the server socket of an input,
+ * a second connection is closed right away
+ */
+static void accept_input(hostin_t *hi)
+{
+	static BYTE will_echo[3] = {255, 251, 1};
+	static BYTE char_mode[3] = {255, 251, 3};
+	int s, on = 1;
+
+	if ((s = accept(hi->ss, NULL, NULL)) == -1) {
+		LOGW(TAG, "can't accept on server socket");
+		return;
+	}
+
+	if (hostin_alive(hi)) {
+		close(s);
+		return;
+	}
+
+	if (hi->tcp && setsockopt(s, IPPROTO_TCP, TCP_NODELAY,
+				  (void *) &on, sizeof(on)) == -1)
+		LOGW(TAG, "can't set sockopt TCP_NODELAY on server socket");
+	/* send the telnet options we need, the replies are read later */
+	if (hi->telnet) {
+		if (write(s, &char_mode, 3) != 3)
+			LOGE(TAG, "can't send char_mode telnet option");
+		if (write(s, &will_echo, 3) != 3)
+			LOGE(TAG, "can't send will_echo telnet option");
+	}
+
+	pthread_mutex_lock(&mutex);
+	hi->skip = false;
+	hi->tn_state = TN_DATA;
+	hi->tn_until = hi->telnet ?
+		       get_clock_us() + TELNET_TIMEOUT * 1000ULL : 0;
+	__atomic_store_n(&hi->fd, s, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&mutex);
+}
+
+/*
+ * thread waiting for input on all registered inputs
+ */
+static void *input_thread(void *arg)
+{
+	hostin_t *hi;
+	int i, n, timeout;
+	char c;
+
+	UNUSED(arg);
+
+	while (true) {
+		/* the list only grows, size the poll set for all inputs */
+		pthread_mutex_lock(&mutex);
+		struct pollfd p[2 * ninputs + 1];
+		hostin_t *h[2 * ninputs + 1];
+		bool acc[2 * ninputs + 1];
+
+		p[0].fd = wake[0];
+		p[0].events = POLLIN;
+		n = 1;
+		timeout = -1;
+		for (hi = inputs; hi != NULL; hi = hi->next) {
+			if (hi->fd != -1 && !hi->hold && !rb_closed(&hi->rb)) {
+				if (rb_space(&hi->rb) > 0) {
+					p[n].fd = hi->fd;
+					p[n].events = POLLIN;
+					h[n] = hi;
+					acc[n++] = false;
+				} else
+					timeout = RETRY_MS;
+			}
+			if (hi->ss != -1) {
+				p[n].fd = hi->ss;
+				p[n].events = POLLIN;
+				h[n] = hi;
+				acc[n++] = true;
+			}
+		}
+		pthread_mutex_unlock(&mutex);
+
+		for (i = 0; i < n; i++)
+			p[i].revents = 0;
+		if (poll(p, n, timeout) == -1) {
+			if (errno != EINTR)
+				LOGW(TAG, "can't poll input descriptors");
+			continue;
+		}
+
+		if (p[0].revents)
+			while (read(wake[0], &c, 1) == 1)
+				;
+
+		for (i = 1; i < n; i++) {
+			if (p[i].revents == 0)
+				continue;
+			if (acc[i])
+				accept_input(h[i]);
+			else
+				read_input(h[i], p[i].fd);
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * register an input, the first one starts the input thread
+ */
+void hostin_add(hostin_t *hi)
+{
+	pthread_t thread;
+	sigset_t set, oset;
+	int i;
+
+	pthread_mutex_lock(&mutex);
+	hi->next = inputs;
+	inputs = hi;
+	ninputs++;
+	pthread_mutex_unlock(&mutex);
+
+	if (wake[0] != -1) {
+		wake_thread();
+		return;
+	}
+
+	if (pipe(wake) == -1) {
+		LOGE(TAG, "can't create pipe for input thread");
+		exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < 2; i++)
+		fcntl(wake[i], F_SETFL, fcntl(wake[i], F_GETFL, 0) | O_NONBLOCK);
+	/* signals are handled by the CPU thread */
+	sigfillset(&set);
+	pthread_sigmask(SIG_BLOCK, &set, &oset);
+	if (pthread_create(&thread, NULL, input_thread, NULL) != 0) {
+		LOGE(TAG, "can't create input thread");
+		exit(EXIT_FAILURE);
+	}
+	pthread_detach(thread);
+	pthread_sigmask(SIG_SETMASK, &oset, NULL);
+}
+
+/*
+ * close the descriptor of an input and drop what was received,
+ * a server socket input accepts the next connection then
+ */
+void hostin_hangup(hostin_t *hi)
+{
+	pthread_mutex_lock(&mutex);
+	if (hi->fd != -1)
+		close(hi->fd);
+	__atomic_store_n(&hi->fd, -1, __ATOMIC_RELEASE);
+	rb_reset(&hi->rb);
+	hi->skip = false;
+	hi->tn_until = 0;
+	pthread_mutex_unlock(&mutex);
+	wake_thread();
+}
+
+/*
+ * continue reading from a new descriptor, e.g. after stdin
+ * reached EOF and was reopened, fd -1 stops reading
+ */
+void hostin_reopen(hostin_t *hi, int fd)
+{
+	pthread_mutex_lock(&mutex);
+	__atomic_store_n(&hi->fd, fd, __ATOMIC_RELEASE);
+	rb_reset(&hi->rb);
+	hi->skip = false;
+	hi->tn_until = 0;
+	pthread_mutex_unlock(&mutex);
+	wake_thread();
+}
+
+/*
+ * stop or continue reading, e.g. while another part of the
+ * program reads from the descriptor
+ */
+void hostin_hold(hostin_t *hi, bool hold)
+{
+	pthread_mutex_lock(&mutex);
+	hi->hold = hold;
+	pthread_mutex_unlock(&mutex);
+	wake_thread();
+}
@@ -0,0 +1,83 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Common I/O devices used by various simulated machines
+ *
+ * This module implements buffered host input for serial devices,
+ * see hostin.c for details.
+ *
+ * History:
+ * 18-OCT-2026 first version
+ * 18-OCT-2026 telnet negotiation without blocking the input thread
+ */
+
+#ifndef HOSTIN_INC
+#define HOSTIN_INC
+
+#include "sim.h"
+#include "simdefs.h"
+
+#include "ringbuf.h"
+
+typedef struct hostin {
+	int fd;			/* input descriptor, -1 if none */
+	int ss;			/* server socket to accept from, -1 if none */
+	bool tcp;		/* accepted connections are TCP/IP */
+	bool telnet;		/* accepted connections talk telnet */
+	bool hold;		/* don't read from fd for now */
+	bool skip;		/* telnet: drop \n or \0 after \r */
+	int tn_state;		/* telnet: protocol state */
+	BYTE tn_cmd;		/* telnet: option command received */
+	uint64_t tn_until;	/* telnet: end of negotiation, 0 if done */
+	ringbuf_t rb;		/* received bytes */
+	struct hostin *next;	/* next registered input */
+} hostin_t;
+
+/*
+ * true if the input has a descriptor, e.g. a connected socket
+ */
+static inline bool hostin_alive(hostin_t *hi)
+{
+	return __atomic_load_n(&hi->fd, __ATOMIC_ACQUIRE) != -1;
+}
+
+static inline int hostin_fd(hostin_t *hi)
+{
+	return __atomic_load_n(&hi->fd, __ATOMIC_ACQUIRE);
+}
+
+/*
+ * true if received bytes are waiting
+ */
+static inline bool hostin_ready(hostin_t *hi)
+{
+	return !rb_empty(&hi->rb);
+}
+
+/*
+ * true if the descriptor reached EOF and all bytes were read
+ */
+static inline bool hostin_eof(hostin_t *hi)
+{
+	return rb_closed(&hi->rb) && rb_empty(&hi->rb);
+}
+
+/*
+ * get a received byte, -1 if none is waiting
+ */
+static inline int hostin_get(hostin_t *hi)
+{
+	BYTE data;
+
+	if (rb_get(&hi->rb, &data))
+		return data;
+	else
+		return -1;
+}
+
+extern void hostin_add(hostin_t *hi);
+extern void hostin_hangup(hostin_t *hi);
+extern void hostin_reopen(hostin_t *hi, int fd);
+extern void hostin_hold(hostin_t *hi, bool hold);
+
+#endif /* !HOSTIN_INC */
@@ -29,6 +29,7 @@
  * 18-NOV-2019 initialize command string address array
  * 14-May-2024 remove large disk from disks[] for disk manager, show it as HDD
  * 15-MAY-2024 make disk manager standard
+ * 18-OCT-2026 collect disk I/O statistics
  */
 
 #include <unistd.h>
@@ -48,6 +49,7 @@
 #include "netsrv.h"
 #endif
 #include "imsai-fif.h"
+#include "diskstats.h"
 
 /* #define LOG_LOCAL_LEVEL LOG_DEBUG */
 #include "log.h"
@@ -86,6 +88,13 @@ static const char *hddisk = "drivei.dsk";
 static int fdaddr[16];		/* address of disk descriptors */
 static char fn[MAX_LFN];	/* path/filename for disk image */
 static int fdstate = 0;		/* state of the fd */
+static diskstats_t dstat[5] = {	/* disk I/O statistics */
+	DISKSTATS_INIT("FIF", "A:"),
+	DISKSTATS_INIT("FIF", "B:"),
+	DISKSTATS_INIT("FIF", "C:"),
+	DISKSTATS_INIT("FIF", "D:"),
+	DISKSTATS_INIT("FIF", "HD")
+};
 
 static void disk_io(int addr);
 
@@ -236,7 +245,10 @@ static void disk_io(int addr)
 	static int maxtrk;		/* max tracks of disk */
 	static int disk;		/* internal disk no */
 	static struct stat s;
-	static char blksec[SEC_SZ];
+	static BYTE blksec[SEC_SZ];
+	diskstats_t *ds;
+	uint64_t t0;
+	bool ok;
 
 	LOGD(TAG, "disk descriptor at %04x", addr);
 	LOGD(TAG, "unit: %02x", getmem(addr + DD_UNIT));
@@ -371,6 +383,7 @@ static void disk_io(int addr)
 	}
 
 do_format:
+	ds = &dstat[(disk <= 3) ? disk : 4];
 
 	/* try wanted disk operation */
 	switch (cmd) {
@@ -388,9 +401,11 @@ do_format:
 			dma_write(addr + DD_RESULT, 0x92);
 			goto done;
 		}
-		for (i = 0; i < SEC_SZ; i++)
-			blksec[i] = dma_read(dma_addr + i);
-		if (write(fd, blksec, SEC_SZ) != SEC_SZ) {
+		dma_read_block(dma_addr, blksec, SEC_SZ);
+		t0 = diskstats_start();
+		ok = write(fd, blksec, SEC_SZ) == SEC_SZ;
+		diskstats_io(ds, true, track, pos, SEC_SZ, t0, ok);
+		if (!ok) {
 			dma_write(addr + DD_RESULT, 0x93);
 			goto done;
 		}
@@ -411,12 +426,14 @@ do_format:
 			dma_write(addr + DD_RESULT, 0x92);
 			goto done;
 		}
-		if (read(fd, blksec, SEC_SZ) != SEC_SZ) {
+		t0 = diskstats_start();
+		ok = read(fd, blksec, SEC_SZ) == SEC_SZ;
+		diskstats_io(ds, false, track, pos, SEC_SZ, t0, ok);
+		if (!ok) {
 			dma_write(addr + DD_RESULT, 0x93);
 			goto done;
 		}
-		for (i = 0; i < SEC_SZ; i++)
-			dma_write(dma_addr + i, blksec[i]);
+		dma_write_block(dma_addr, blksec, SEC_SZ);
 		dma_write(addr + DD_RESULT, 1);
 		break;
 
@@ -7,6 +7,8 @@
 *
 * History:
 * 1-JUL-2021	1.0	Initial Release
+* 18-OCT-2026	read stdin and socket in an input thread, status from memory
+* 18-OCT-2026	added hal_hangup()
 *
 */
 
@@ -17,7 +19,6 @@
 #include <ctype.h>
 #include <errno.h>
 #include <sys/poll.h>
-#include <sys/socket.h>
 
 #include "sim.h"
 #include "simdefs.h"
@@ -26,6 +27,7 @@
 
 #include "unix_terminal.h"
 #include "unix_network.h"
+#include "hostin.h"
 #include "imsai-vio.h"
 #ifdef HAS_NETSERVER
 #include "netsrv.h"
@@ -188,6 +190,8 @@ static void net_ptr_out(BYTE data)
 
 /* -------------------- STDIO HAL -------------------- */
 
+static hostin_t stdio_hin;		/* buffered stdin */
+
 static bool stdio_alive(void)
 {
 	return true; /* STDIO is always alive */
@@ -195,16 +199,11 @@ static bool stdio_alive(void)
 
 static void stdio_status(BYTE *stat)
 {
-	struct pollfd p[1];
-
-	p[0].fd = fileno(stdin);
-	p[0].events = POLLIN;
-	p[0].revents = 0;
-	poll(p, 1, 0);
 	*stat &= (BYTE) (~3);
-	if (p[0].revents & POLLIN)
+	/* at EOF let the guest read, so that the tty gets reopened */
+	if (hostin_ready(&stdio_hin) || hostin_eof(&stdio_hin))
 		*stat |= 2;
-	if (p[0].revents & POLLNVAL) {
+	if (!hostin_alive(&stdio_hin)) {
 		LOGE(TAG, "can't use terminal, try 'screen simulation ...'");
 		cpu_error = IOERROR;
 		cpu_state = ST_STOPPED;
@@ -215,26 +214,20 @@ static void stdio_status(BYTE *stat)
 static int stdio_in(void)
 {
 	int data;
-	struct pollfd p[1];
 
-again:
 	/* if no input waiting return last */
-	p[0].fd = fileno(stdin);
-	p[0].events = POLLIN;
-	p[0].revents = 0;
-	poll(p, 1, 0);
-	if (!(p[0].revents & POLLIN))
-		return -1;
+	if ((data = hostin_get(&stdio_hin)) >= 0 || !hostin_eof(&stdio_hin))
+		return data;
 
-	if (read(fileno(stdin), &data, 1) == 0) {
-		/* try to reopen tty, input redirection exhausted */
-		if (freopen("/dev/tty", "r", stdin) == NULL)
-			LOGE(TAG, "can't reopen /dev/tty");
-		set_unix_terminal();
-		goto again;
-	}
+	/* try to reopen tty, input redirection exhausted */
+	if (freopen("/dev/tty", "r", stdin) == NULL) {
+		LOGE(TAG, "can't reopen /dev/tty");
+		hostin_reopen(&stdio_hin, -1);
+	} else
+		hostin_reopen(&stdio_hin, fileno(stdin));
+	set_unix_terminal();
 
-	return data;
+	return -1;
 }
 
 static void stdio_out(BYTE data)
@@ -253,104 +246,115 @@ again:
 
 /* -------------------- SOCKET SERVER HAL -------------------- */
 
+static hostin_t scktsrv_hin;		/* buffered UNIX socket connection */
+
 static bool scktsrv_alive(void)
 {
-	struct pollfd p[1];
-
-	/* if socket not connected check for a new connection */
-	if (ucons[0].ssc == 0) {
-		p[0].fd = ucons[0].ss;
-		p[0].events = POLLIN;
-		p[0].revents = 0;
-		poll(p, 1, 0);
-		/* accept a new connection */
-		if (p[0].revents) {
-			if ((ucons[0].ssc = accept(ucons[0].ss, NULL, NULL)) == -1) {
-				LOGW(TAG, "can't accept server socket");
-				ucons[0].ssc = 0;
-			}
-		}
-	}
-
-	return ucons[0].ssc != 0; /* SCKTSRV is alive if there is an open socket */
+	/* SCKTSRV is alive if there is an open socket */
+	return hostin_alive(&scktsrv_hin);
 }
 
 static void scktsrv_status(BYTE *stat)
 {
-	struct pollfd p[1];
-
 	/* if socket is connected check for I/O */
-	if (ucons[0].ssc != 0) {
-		p[0].fd = ucons[0].ssc;
-		p[0].events = POLLIN | POLLOUT;
-		p[0].revents = 0;
-		poll(p, 1, 0);
+	if (hostin_alive(&scktsrv_hin)) {
 		*stat &= (BYTE) (~3);
-		if (p[0].revents & POLLIN)
+		if (hostin_eof(&scktsrv_hin)) {
+			hostin_hangup(&scktsrv_hin);
+			*stat = 0;
+			return;
+		}
+		if (hostin_ready(&scktsrv_hin))
 			*stat |= 2;
-		if (p[0].revents & POLLOUT)
-			*stat |= 1;
+		*stat |= 1;
 	} else
 		*stat = 0;
 }
 
 static int scktsrv_in(void)
 {
-	BYTE data;
-	struct pollfd p[1];
-
 	/* if not connected return last */
-	if (ucons[0].ssc == 0)
+	if (!hostin_alive(&scktsrv_hin))
 		return -1;
 
-	/* if no input waiting return last */
-	p[0].fd = ucons[0].ssc;
-	p[0].events = POLLIN;
-	p[0].revents = 0;
-	poll(p, 1, 0);
-	if (!(p[0].revents & POLLIN))
-		return -1;
-
-	if (read(ucons[0].ssc, &data, 1) != 1) {
-		/* EOF, close socket and return last */
-		close(ucons[0].ssc);
-		ucons[0].ssc = 0;
+	/* on EOF close socket and return last */
+	if (hostin_eof(&scktsrv_hin)) {
+		hostin_hangup(&scktsrv_hin);
 		return -1;
 	}
 
-	return data;
+	return hostin_get(&scktsrv_hin);
 }
 
 static void scktsrv_out(BYTE data)
 {
 	struct pollfd p[1];
+	int fd = hostin_fd(&scktsrv_hin);
 
 	/* return if socket not connected */
-	if (ucons[0].ssc == 0)
+	if (fd == -1)
 		return;
 
 	/* if output not possible close socket and return */
-	p[0].fd = ucons[0].ssc;
+	p[0].fd = fd;
 	p[0].events = POLLOUT;
 	p[0].revents = 0;
 	poll(p, 1, 0);
 	if (!(p[0].revents & POLLOUT)) {
-		close(ucons[0].ssc);
-		ucons[0].ssc = 0;
+		hostin_hangup(&scktsrv_hin);
 		return;
 	}
 
 again:
-	if (write(ucons[0].ssc, &data, 1) != 1) {
+	if (write(fd, &data, 1) != 1) {
 		if (errno == EINTR)
 			goto again;
-		else {
-			close(ucons[0].ssc);
-			ucons[0].ssc = 0;
-		}
+		else
+			hostin_hangup(&scktsrv_hin);
 	}
 }
 
+static bool hin_done;			/* inputs registered */
+
+/*
+ * register stdin and the server socket with the input thread
+ */
+static void hal_hostin_init(void)
+{
+	if (hin_done)
+		return;
+	hin_done = true;
+
+	stdio_hin.fd = fileno(stdin);
+	stdio_hin.ss = -1;
+#ifdef WANT_ICE
+	/* ICE reads the terminal until the machine runs */
+	stdio_hin.hold = true;
+#endif
+	hostin_add(&stdio_hin);
+
+	scktsrv_hin.fd = -1;
+	scktsrv_hin.ss = ucons[0].ss ? ucons[0].ss : -1;
+	hostin_add(&scktsrv_hin);
+}
+
+/*
+ * close the socket connection on exit
+ */
+void hal_hangup(void)
+{
+	if (hin_done && hostin_alive(&scktsrv_hin))
+		hostin_hangup(&scktsrv_hin);
+}
+
+/*
+ * stop reading stdin while ICE uses the terminal
+ */
+void hal_stdio_hold(bool hold)
+{
+	hostin_hold(&stdio_hin, hold);
+}
+
 /* -------------------- MODEM HAL -------------------- */
 
 #ifdef HAS_MODEM
@@ -513,6 +517,7 @@ static void hal_init(void)
 
 void hal_reset(void)
 {
+	hal_hostin_init();
 	hal_init();
 	hal_report();
 }
@@ -7,6 +7,8 @@
  *
  * History:
  * 1-JUL-2021	1.0	Initial Release
+ * 18-OCT-2026	added hal_stdio_hold()
+ * 18-OCT-2026	added hal_hangup()
  *
  */
 
@@ -51,6 +53,8 @@ extern void hal_status_in(sio_port_t sio, BYTE *stat);
 extern int hal_data_in(sio_port_t sio);
 extern void hal_data_out(sio_port_t sio, BYTE data);
 extern bool hal_carrier_detect(sio_port_t sio);
+extern void hal_stdio_hold(bool hold);
+extern void hal_hangup(void);
 
 extern const char *sio_port_name[MAX_SIO_PORT];
 extern hal_device_t sio[MAX_SIO_PORT][MAX_HAL_DEV];
@@ -32,6 +32,7 @@
  * 15-JUL-2021 refactor serial keyboard
  * 16-JUL-2021 added all options for SIO 1B
  * 01-AUG-2021 integrated HAL
+ * 18-OCT-2026 measure character time in CPU T-states
  */
 
 #include <unistd.h>
@@ -41,8 +42,8 @@
 #include "sim.h"
 #include "simdefs.h"
 #include "simglb.h"
-#include "simport.h"
 
+#include "baudpace.h"
 #include "imsai-hal.h"
 #include "imsai-sio2.h"
 
@@ -51,8 +52,6 @@
 #include "log.h"
 static const char *TAG = "SIO";
 
-#define BAUDTIME 10000000
-
 static BYTE sio1_ctl, sio2_ctl;
 
 bool sio1a_upper_case;
@@ -60,7 +59,7 @@ bool sio1a_strip_parity;
 bool sio1a_drop_nulls;
 int sio1a_baud_rate = 115200;
 
-static uint64_t sio1a_t1, sio1a_t2;
+static Tstates_t sio1a_t1;
 static BYTE sio1a_stat = 0;
 
 bool sio1b_upper_case;
@@ -68,7 +67,7 @@ bool sio1b_strip_parity;
 bool sio1b_drop_nulls;
 int sio1b_baud_rate = 110;
 
-static uint64_t sio1b_t1, sio1b_t2;
+static Tstates_t sio1b_t1;
 static BYTE sio1b_stat = 0;
 
 bool sio2a_upper_case;
@@ -76,7 +75,7 @@ bool sio2a_strip_parity;
 bool sio2a_drop_nulls;
 int sio2a_baud_rate = 115200;
 
-static uint64_t sio2a_t1, sio2a_t2;
+static Tstates_t sio2a_t1;
 static BYTE sio2a_stat = 0;
 
 bool sio2b_upper_case;
@@ -84,7 +83,7 @@ bool sio2b_strip_parity;
 bool sio2b_drop_nulls;
 int sio2b_baud_rate = 2400;
 
-static uint64_t sio2b_t1, sio2b_t2;
+static Tstates_t sio2b_t1;
 static BYTE sio2b_stat = 0;
 
 /*
@@ -92,7 +91,7 @@ static BYTE sio2b_stat = 0;
  */
 void imsai_sio_reset(void)
 {
-	sio1a_t1 = sio1b_t1 = sio2a_t1 = sio2b_t1 = get_clock_us();
+	sio1a_t1 = sio1b_t1 = sio2a_t1 = sio2b_t1 = T;
 }
 
 /*
@@ -126,14 +125,12 @@ void imsai_sio_nofun_out(BYTE data)
  */
 BYTE imsai_sio1a_status_in(void)
 {
-	sio1a_t2 = get_clock_us();
-	if (sio1a_baud_rate > 0 &&
-	    (int) (sio1a_t2 - sio1a_t1) < BAUDTIME / sio1a_baud_rate)
+	if (baud_busy(sio1a_t1, sio1a_baud_rate))
 		return sio1a_stat;
 
 	hal_status_in(SIO1A, &sio1a_stat);
 
-	sio1a_t1 = get_clock_us();
+	sio1a_t1 = T;
 
 	return sio1a_stat;
 }
@@ -163,7 +160,7 @@ BYTE imsai_sio1a_data_in(void)
 		return last;
 	}
 
-	sio1a_t1 = get_clock_us();
+	sio1a_t1 = T;
 	sio1a_stat &= 0b11111101;
 
 	/* process read data */
@@ -190,7 +187,7 @@ void imsai_sio1a_data_out(BYTE data)
 
 	hal_data_out(SIO1A, data);
 
-	sio1a_t1 = get_clock_us();
+	sio1a_t1 = T;
 	sio1a_stat &= 0b11111110;
 }
 
@@ -201,14 +198,12 @@ void imsai_sio1a_data_out(BYTE data)
  */
 BYTE imsai_sio1b_status_in(void)
 {
-	sio1b_t2 = get_clock_us();
-	if (sio1b_baud_rate > 0 &&
-	    (int) (sio1b_t2 - sio1b_t1) < BAUDTIME / sio1b_baud_rate)
+	if (baud_busy(sio1b_t1, sio1b_baud_rate))
 		return sio1b_stat;
 
 	hal_status_in(SIO1B, &sio1b_stat);
 
-	sio1b_t1 = get_clock_us();
+	sio1b_t1 = T;
 
 	return sio1b_stat;
 }
@@ -235,7 +230,7 @@ BYTE imsai_sio1b_data_in(void)
 		return last;
 	}
 
-	sio1b_t1 = get_clock_us();
+	sio1b_t1 = T;
 	sio1b_stat &= 0b11111101;
 
 	/* process read data */
@@ -259,7 +254,7 @@ void imsai_sio1b_data_out(BYTE data)
 
 	hal_data_out(SIO1B, data);
 
-	sio1b_t1 = get_clock_us();
+	sio1b_t1 = T;
 	sio1b_stat &= 0b11111110;
 }
 
@@ -273,14 +268,12 @@ void imsai_sio1b_data_out(BYTE data)
  */
 BYTE imsai_sio2a_status_in(void)
 {
-	sio2a_t2 = get_clock_us();
-	if (sio2a_baud_rate > 0 &&
-	    (int) (sio2a_t2 - sio2a_t1) < BAUDTIME / sio2a_baud_rate)
+	if (baud_busy(sio2a_t1, sio2a_baud_rate))
 		return sio2a_stat;
 
 	hal_status_in(SIO2A, &sio2a_stat);
 
-	sio2a_t1 = get_clock_us();
+	sio2a_t1 = T;
 
 	return sio2a_stat;
 }
@@ -310,7 +303,7 @@ BYTE imsai_sio2a_data_in(void)
 		return last;
 	}
 
-	sio2a_t1 = get_clock_us();
+	sio2a_t1 = T;
 	sio2a_stat &= 0b11111101;
 
 	/* process read data */
@@ -337,7 +330,7 @@ void imsai_sio2a_data_out(BYTE data)
 
 	hal_data_out(SIO2A, data);
 
-	sio2a_t1 = get_clock_us();
+	sio2a_t1 = T;
 	sio2a_stat &= 0b11111110;
 }
 
@@ -351,14 +344,12 @@ void imsai_sio2a_data_out(BYTE data)
  */
 BYTE imsai_sio2b_status_in(void)
 {
-	sio2b_t2 = get_clock_us();
-	if (sio2b_baud_rate > 0 &&
-	    (int) (sio2b_t2 - sio2b_t1) < BAUDTIME / sio2b_baud_rate)
+	if (baud_busy(sio2b_t1, sio2b_baud_rate))
 		return sio2b_stat;
 
 	hal_status_in(SIO2B, &sio2b_stat);
 
-	sio2b_t1 = get_clock_us();
+	sio2b_t1 = T;
 
 	return sio2b_stat;
 }
@@ -388,7 +379,7 @@ BYTE imsai_sio2b_data_in(void)
 		return last;
 	}
 
-	sio2b_t1 = get_clock_us();
+	sio2b_t1 = T;
 	sio2b_stat &= 0b11111101;
 
 	/* process read data */
@@ -415,7 +406,7 @@ void imsai_sio2b_data_out(BYTE data)
 
 	hal_data_out(SIO2B, data);
 
-	sio2b_t1 = get_clock_us();
+	sio2b_t1 = T;
 	sio2b_stat &= 0b11111110;
 }
 
@@ -21,10 +21,14 @@
  * 14-JUL-2018 integrate webfrontend
  * 05-NOV-2019 use correct memory access function
  * 04-JAN-2025 add SDL2 support
+ * 18-OCT-2026 draw characters from a glyph atlas, only changed cells
+ * 18-OCT-2026 headless capture of the frames
+ * 18-OCT-2026 copy to the X11 window only if the screen changed
  */
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #ifdef WANT_SDL
 #include <SDL.h>
 #else
@@ -43,7 +47,6 @@
 #endif
 
 #ifdef HAS_NETSERVER
-#include <string.h>
 #include "netsrv.h"
 #endif
 
@@ -55,6 +58,10 @@ static const char *TAG = "VIO";
 
 #include "imsai-vio-charset.h"
 #include "imsai-vio.h"
+#include "textmode.h"
+#ifdef HAS_VIDCAP
+#include "vidcap.h"
+#endif
 
 #define XOFF		10		/* use some offset inside the window */
 #define YOFF		15		/* for the drawing area */
@@ -67,16 +74,14 @@ int slf = 1;				/* scanlines factor, default no lines */
 uint8_t bg_color[3] = {48, 48, 48};	/* default background color */
 uint8_t fg_color[3] = {255, 255, 255};	/* default foreground color */
 static int xsize, ysize;		/* window size */
-static int xscale, yscale;
-static int sx, sy;
+static uint32_t pix_black, pix_bg, pix_fg; /* pixels of the colors */
+static tm_screen_t tscreen;		/* text screen */
+static tm_atlas_t atlas[4];		/* glyphs for the resolutions */
 #ifdef WANT_SDL
 static int vio_win_id = -1;
 static SDL_Window *window;
 static SDL_Renderer *renderer;
 static SDL_Texture *texture;
-static uint8_t *pixels;
-static int pitch;
-static uint8_t color[3];
 static char keybuf[KEYBUF_LEN];		/* typeahead buffer */
 static int keyn, keyin, keyout;
 static SDL_mutex *keybuf_mutex;
@@ -87,10 +92,12 @@ static int screen;
 static GC gc;
 static XWindowAttributes wa;
 static Pixmap pixmap;
+static XImage *ximage;
 static Colormap colormap;
 static XColor black, bg, fg;
 static char black_color[] = "#000000";	/* black */
 static XEvent event;
+static bool exposed;			/* window needs a copy of the pixmap */
 static KeySym key;
 static char text[10];
 #endif /* !WANT_SDL */
@@ -101,6 +108,7 @@ static int mode;		/* video mode written to command port memory */
 static int modebuf;			/* and double buffer for it */
 static int vmode, res;			/* video mode, resolution */
 static bool inv;			/* inverse */
+static int gmap[256];			/* glyph of a character code */
 #if !defined(WANT_SDL) || defined(HAS_NETSERVER)
 static bool kbd_status;			/* keyboard status */
 static int kbd_data;			/* keyboard data */
@@ -129,6 +137,10 @@ static void open_display(void)
 	SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
 	SDL_RenderClear(renderer);
 	SDL_RenderPresent(renderer);
+
+	pix_black = tm_rgba((uint8_t [3]) {0, 0, 0});
+	pix_bg = tm_rgba(bg_color);
+	pix_fg = tm_rgba(fg_color);
 #else /* !WANT_SDL */
 	Window rootwindow;
 	XSizeHints *size_hints = XAllocSizeHints();
@@ -154,7 +166,7 @@ static void open_display(void)
 	XFree(size_hints);
 	wm_delete_window = XInternAtom(display, "WM_DELETE_WINDOW", False);
 	XSetWMProtocols(display, window, &wm_delete_window, 1);
-	XSelectInput(display, window, KeyPressMask);
+	XSelectInput(display, window, KeyPressMask | ExposureMask);
 	colormap = DefaultColormap(display, 0);
 	gc = XCreateGC(display, window, 0, NULL);
 	pixmap = XCreatePixmap(display, rootwindow, xsize, ysize, wa.depth);
@@ -167,16 +179,33 @@ static void open_display(void)
 	sprintf(buf, "#%02X%02X%02X", fg_color[0], fg_color[1], fg_color[2]);
 	XParseColor(display, colormap, buf, &fg);
 	XAllocColor(display, colormap, &fg);
+	pix_black = black.pixel;
+	pix_bg = bg.pixel;
+	pix_fg = fg.pixel;
+
+	ximage = XCreateImage(display, DefaultVisual(display, screen),
+			      wa.depth, ZPixmap, 0, NULL, xsize, ysize, 32, 0);
+	ximage->data = malloc(ximage->bytes_per_line * ysize);
+	/* force little-endian pixels, Xlib will convert if necessary */
+	ximage->byte_order = LSBFirst;
 
 	XMapWindow(display, window);
 	XSync(display, True);
 	XUnlockDisplay(display);
 #endif /* !WANT_SDL */
+
+	tm_screen_init(&tscreen, xsize, ysize, 80 * 24, pix_black);
 }
 
 /* close the SDL2 or X11 window for VIO display */
 static void close_display(void)
 {
+	int i;
+
+	tm_screen_free(&tscreen);
+	for (i = 0; i < 4; i++)
+		tm_atlas_free(&atlas[i]);
+
 #ifdef WANT_SDL
 	SDL_DestroyMutex(keybuf_mutex);
 	SDL_DestroyTexture(texture);
@@ -184,6 +213,7 @@ static void close_display(void)
 	SDL_DestroyWindow(window);
 #else
 	XLockDisplay(display);
+	XDestroyImage(ximage);
 	XFreePixmap(display, pixmap);
 	XFreeGC(display, gc);
 	XUnlockDisplay(display);
@@ -229,149 +259,6 @@ void imsai_vio_off(void)
 
 #ifdef WANT_SDL
 
-static inline void set_fg_color(void)
-{
-	color[0] = fg_color[0];
-	color[1] = fg_color[1];
-	color[2] = fg_color[2];
-}
-
-static inline void set_bg_color(void)
-{
-	color[0] = bg_color[0];
-	color[1] = bg_color[1];
-	color[2] = bg_color[2];
-}
-
-static inline void draw_point(int x, int y)
-{
-	uint8_t *p = pixels + y * pitch + x * 4;
-
-	p[3] = color[0];
-	p[2] = color[1];
-	p[1] = color[2];
-	p[0] = SDL_ALPHA_OPAQUE;
-}
-
-#else /* !WANT_SDL */
-
-static inline void set_fg_color(void)
-{
-	XSetForeground(display, gc, fg.pixel);
-}
-
-static inline void set_bg_color(void)
-{
-	XSetForeground(display, gc, bg.pixel);
-}
-
-static inline void draw_point(int x, int y)
-{
-	XDrawPoint(display, pixmap, gc, x, y);
-}
-
-#endif /* !WANT_SDL */
-
-/* display characters 80-FF from bits 0-6, bit 7 = inverse video */
-static void dc1(BYTE c)
-{
-	register int x, y;
-	bool cinv = (c & 128) ? true : false;
-
-	for (x = 0; x < 7; x++) {
-		for (y = 0; y < 10; y++) {
-			if (charset[(c << 1) & 0xff][y][x] == 1) {
-				if (cinv == inv)
-					set_fg_color();
-				else
-					set_bg_color();
-			} else {
-				if (cinv == inv)
-					set_bg_color();
-				else
-					set_fg_color();
-			}
-			draw_point(sx + (x * xscale), sy + (y * yscale * slf));
-			if (res & 1)
-				draw_point(sx + (x * xscale) + 1,
-					   sy + (y * yscale * slf));
-			if (res & 2)
-				draw_point(sx + (x * xscale),
-					   sy + (y * yscale * slf) + (1 * slf));
-			if ((res & 3) == 3)
-				draw_point(sx + (x * xscale) + 1,
-					   sy + (y * yscale * slf) + (1 * slf));
-		}
-	}
-}
-
-/* display characters 00-7F from bits 0-6, bit 7 = inverse video */
-static void dc2(BYTE c)
-{
-	register int x, y;
-	bool cinv = (c & 128) ? true : false;
-
-	for (x = 0; x < 7; x++) {
-		for (y = 0; y < 10; y++) {
-			if (charset[c & 0x7f][y][x] == 1) {
-				if (cinv == inv)
-					set_fg_color();
-				else
-					set_bg_color();
-			} else {
-				if (cinv == inv)
-					set_bg_color();
-				else
-					set_fg_color();
-			}
-			draw_point(sx + (x * xscale), sy + (y * yscale * slf));
-			if (res & 1)
-				draw_point(sx + (x * xscale) + 1,
-					   sy + (y * yscale * slf));
-			if (res & 2)
-				draw_point(sx + (x * xscale),
-					   sy + (y * yscale * slf) + (1 * slf));
-			if ((res & 3) == 3)
-				draw_point(sx + (x * xscale) + 1,
-					   sy + (y * yscale * slf) + (1 * slf));
-		}
-	}
-}
-
-/* display characters 00-FF from bits 0-7, inverse video from command word */
-static void dc3(BYTE c)
-{
-	register int x, y;
-
-	for (x = 0; x < 7; x++) {
-		for (y = 0; y < 10; y++) {
-			if (charset[c][y][x] == 1) {
-				if (!inv)
-					set_fg_color();
-				else
-					set_bg_color();
-			} else {
-				if (!inv)
-					set_bg_color();
-				else
-					set_fg_color();
-			}
-			draw_point(sx + (x * xscale), sy + (y * yscale * slf));
-			if (res & 1)
-				draw_point(sx + (x * xscale) + 1,
-					   sy + (y * yscale * slf));
-			if (res & 2)
-				draw_point(sx + (x * xscale),
-					   sy + (y * yscale * slf) + (1 * slf));
-			if ((res & 3) == 3)
-				draw_point(sx + (x * xscale) + 1,
-					   sy + (y * yscale * slf) + (1 * slf));
-		}
-	}
-}
-
-#ifdef WANT_SDL
-
 /*
  * Enqueue a keyboard character
  */
@@ -463,7 +350,8 @@ static inline void event_handler(void)
 		    XLookupString(&event.xkey, text, 1, &key, 0) == 1) {
 			kbd_data = text[0];
 			kbd_status = true;
-		}
+		} else if (event.type == Expose)
+			exposed = true;
 	}
 #ifdef HAS_NETSERVER
 	if (n_flag) {
@@ -478,15 +366,36 @@ static inline void event_handler(void)
 
 #endif /* !WANT_SDL */
 
+/* glyph of every character code for the video mode */
+static void init_gmap(void)
+{
+	int c, g;
+	bool cinv;
+
+	for (c = 0; c < 256; c++) {
+		cinv = (c & 128) ? true : false;
+		switch (vmode) {
+		case 1:	/* character codes 80-FF from bits 0-6 */
+			g = (c << 1) & 0xff;
+			break;
+		case 2:	/* character codes 00-7F from bits 0-6 */
+			g = c & 0x7f;
+			break;
+		default: /* character codes 00-FF, inverse from command word */
+			g = c;
+			cinv = false;
+			break;
+		}
+		gmap[c] = (cinv != inv) ? g + 256 : g;
+	}
+}
+
 /* refresh the display buffer dependent on video mode */
 static void refresh(void)
 {
 	static int cols, rows;
-	static BYTE c;
-	register int x, y;
-
-	sx = XOFF;
-	sy = YOFF;
+	int x, y, xscale, yscale;
+	WORD addr;
 
 	mode = getmem(0xf7ff);
 	if (mode != modebuf) {
@@ -511,68 +420,60 @@ static void refresh(void)
 			rows = 24;
 			yscale = 1;
 		}
+
+		if (atlas[res].pix == NULL)
+			tm_atlas_build(&atlas[res], &charset[0][0][0], 256,
+				       7, 10, xscale, yscale, slf,
+				       pix_fg, pix_bg, pix_black);
+		tm_layout(&tscreen, &atlas[res], cols, rows, XOFF, YOFF);
+		init_gmap();
 	}
 
-	switch (vmode) {
-	case 0:	/* Video mode 0: video off, screen blanked */
+	if (vmode == 0) { /* Video mode 0: video off, screen blanked */
 #if !defined(WANT_SDL) || defined(HAS_NETSERVER)
 		event_handler();
 #endif
-#ifdef WANT_SDL
-		SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
-		SDL_RenderClear(renderer);
-#else
-		XSetForeground(display, gc, black.pixel);
-		XFillRectangle(display, pixmap, gc, 0, 0, xsize, ysize);
-#endif
-		break;
-
-	case 1: /* Video mode 1: display character codes 80-FF */
-		for (y = 0; y < rows; y++) {
-			sx = XOFF;
-#if !defined(WANT_SDL) || defined(HAS_NETSERVER)
-			event_handler();
-#endif
-			for (x = 0; x < cols; x++) {
-				c = getmem(0xf000 + (y * cols) + x);
-				dc1(c);
-				sx += (res & 1) ? 14 : 7;
-			}
-			sy += (res & 2) ? 20 * slf : 10 * slf;
-		}
-		break;
+		tm_clear(&tscreen, pix_black);
+		return;
+	}
 
-	case 2:	/* Video mode 2: display character codes 00-7F */
-		for (y = 0; y < rows; y++) {
-			sx = XOFF;
+	/* Video modes 1-3: only draw cells with another glyph */
+	addr = 0xf000;
+	for (y = 0; y < rows; y++) {
 #if !defined(WANT_SDL) || defined(HAS_NETSERVER)
-			event_handler();
+		event_handler();
 #endif
-			for (x = 0; x < cols; x++) {
-				c = getmem(0xf000 + (y * cols) + x);
-				dc2(c);
-				sx += (res & 1) ? 14 : 7;
-			}
-			sy += (res & 2) ? 20 * slf : 10 * slf;
-		}
-		break;
+		for (x = 0; x < cols; x++)
+			tm_put(&tscreen, x, y, gmap[getmem(addr++)]);
+	}
+}
 
-	case 3:	/* Video mode 3: display character codes 00-FF */
-		for (y = 0; y < rows; y++) {
-			sx = XOFF;
-#if !defined(WANT_SDL) || defined(HAS_NETSERVER)
-			event_handler();
-#endif
-			for (x = 0; x < cols; x++) {
-				c = getmem(0xf000 + (y * cols) + x);
-				dc3(c);
-				sx += (res & 1) ? 14 : 7;
-			}
-			sy += (res & 2) ? 20 * slf : 10 * slf;
-		}
-		break;
+#ifndef WANT_SDL
+/*
+ * copy the changed part of the frame buffer into the pixmap,
+ * returns false if nothing changed
+ */
+static bool put_screen(void)
+{
+	int x, y, w, h, i, j;
+	uint32_t *q;
+
+	if (!tm_dirty(&tscreen, &x, &y, &w, &h))
+		return false;
+
+	for (j = y; j < y + h; j++) {
+		q = tscreen.fb + j * tscreen.w;
+		if (ximage->bits_per_pixel == 32)
+			memcpy(ximage->data + j * ximage->bytes_per_line +
+			       x * 4, q + x, w * 4);
+		else
+			for (i = x; i < x + w; i++)
+				XPutPixel(ximage, i, j, q[i]);
 	}
+	XPutImage(display, pixmap, gc, ximage, x, y, x, y, w, h);
+	return true;
 }
+#endif
 
 #ifdef HAS_NETSERVER
 static uint8_t dblbuf[2048];
@@ -668,12 +569,16 @@ static void ws_refresh(void)
 /* function for updating the display */
 static void update_display(bool tick)
 {
+	SDL_Rect r;
+
 	UNUSED(tick);
 
-	/* update display window */
-	SDL_LockTexture(texture, NULL, (void **) &pixels, &pitch);
+	/* update display window, upload only the changed pixels */
 	refresh();
-	SDL_UnlockTexture(texture);
+	if (tm_dirty(&tscreen, &r.x, &r.y, &r.w, &r.h))
+		SDL_UpdateTexture(texture, &r,
+				  tscreen.fb + r.y * tscreen.w + r.x,
+				  tscreen.w * sizeof(uint32_t));
 	SDL_RenderCopy(renderer, texture, NULL, NULL);
 	SDL_RenderPresent(renderer);
 }
@@ -706,11 +611,19 @@ static void *update_thread(void *arg)
 			pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
 			XLockDisplay(display);
 
-			/* update display window */
+			/* read events, the window needs a copy if exposed */
+			exposed = false;
+			while (XCheckTypedWindowEvent(display, window, Expose,
+						      &event))
+				exposed = true;
+
+			/* update display window, only if something changed */
 			refresh();
-			XCopyArea(display, pixmap, window, gc, 0, 0,
-				  xsize, ysize, 0, 0);
-			XSync(display, False);
+			if (put_screen() || exposed) {
+				XCopyArea(display, pixmap, window, gc, 0, 0,
+					  xsize, ysize, 0, 0);
+				XSync(display, False);
+			}
 
 			/* unlock display, thread can be canceled again */
 			XUnlockDisplay(display);
@@ -733,9 +646,52 @@ static void *update_thread(void *arg)
 }
 #endif /* !WANT_SDL || HAS_NETSERVER */
 
+#ifdef HAS_VIDCAP
+/* draw a frame for the headless capture */
+static const uint32_t *capture_frame(void)
+{
+	if (state)
+		refresh();
+	else
+		tm_clear(&tscreen, pix_black);
+
+	return tscreen.fb;
+}
+
+static vidcap_t vio_cap = { .name = "vio", .render = capture_frame };
+
+/* create the text screen for the headless capture instead of a window */
+static void open_capture(void)
+{
+	xsize = 560 + (XOFF * 2);
+	ysize = (240 * slf) + (YOFF * 2);
+
+	pix_black = vidcap_rgb((uint8_t [3]) {0, 0, 0});
+	pix_bg = vidcap_rgb(bg_color);
+	pix_fg = vidcap_rgb(fg_color);
+	tm_screen_init(&tscreen, xsize, ysize, 80 * 24, pix_black);
+
+	vio_cap.w = xsize;
+	vio_cap.h = ysize;
+	vidcap_add(&vio_cap);
+}
+#endif /* HAS_VIDCAP */
+
 /* create the SDL window and start display refresh thread */
 void imsai_vio_init(void)
 {
+#ifdef HAS_VIDCAP
+	/* frames are drawn by the CPU thread in emulated time */
+	if (V_flag) {
+		if (tscreen.fb == NULL)
+			open_capture();
+		state = true;
+		modebuf = -1;
+		putmem(0xf7ff, 0x00);
+		return;
+	}
+#endif
+
 #ifdef HAS_NETSERVER
 	if (!n_flag) {
 #endif
@@ -10,6 +10,8 @@
  *
  * History:
  * 04-JUN-2024 first version
+ * 18-OCT-2026 read ahead whole tracks from disk images
+ * 18-OCT-2026 collect disk I/O statistics
  */
 
 #include <stdio.h>
@@ -29,6 +31,8 @@
 #ifdef HAS_ISBC202
 
 #include "mds-isbc202.h"
+#include "trackcache.h"
+#include "diskstats.h"
 
 #include "log.h"
 static const char *TAG = "ISBC202";
@@ -106,6 +110,7 @@ static char fndir[MAX_LFN];	/* directory path for disk image */
 static char fn[MAX_LFN];	/* path/filename for disk image */
 static int fd;			/* fd for disk file i/o */
 static BYTE buf[SEC_SZ];	/* buffer for one sector */
+static trackcache_t tcache[4];	/* read-ahead buffers for the disks */
 static pthread_mutex_t status_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 /* these are our disk drives */
@@ -116,6 +121,13 @@ static const char *disks[4] = {
 	"drived.dsk"
 };
 
+static diskstats_t dstat[4] = {	/* disk I/O statistics */
+	DISKSTATS_INIT("iSBC 202", "drivea.dsk"),
+	DISKSTATS_INIT("iSBC 202", "driveb.dsk"),
+	DISKSTATS_INIT("iSBC 202", "drivec.dsk"),
+	DISKSTATS_INIT("iSBC 202", "drived.dsk")
+};
+
 /* unit ready status bits */
 static BYTE uready[4] = { ST_U0RDY, ST_U1RDY, ST_U2RDY, ST_U3RDY };
 
@@ -188,6 +200,8 @@ void isbc202_iopbh_out(BYTE data)
 	int i, drive, op;
 	off_t pos;
 	struct stat s;
+	uint64_t t0;
+	bool ok;
 
 	iopb_addr |= data << 8;
 
@@ -244,6 +258,7 @@ void isbc202_iopbh_out(BYTE data)
 		/* unlink disk image */
 		if (taddr == 0)
 			unlink(fn);
+		trackcache_flush(&tcache[drive]);
 
 		/* try to create new disk image */
 		if ((fd = open(fn, O_RDWR | O_CREAT, 0644)) == -1) {
@@ -348,22 +363,22 @@ void isbc202_iopbh_out(BYTE data)
 			goto rdone;
 		}
 
-		/* seek to sector */
+		/* read the sectors, the whole track is read ahead */
 		pos = (taddr * SPT + saddr - 1) * SEC_SZ;
-		if (lseek(fd, pos, SEEK_SET) == (off_t) -1) {
-			ioerr = IO_SEEK;
-			goto rdone;
-		}
-
-		/* read the sectors */
-		for (; nsec > 0; nsec--) {
-			if (read(fd, buf, SEC_SZ) != SEC_SZ) {
+		for (; nsec > 0; nsec--, pos += SEC_SZ) {
+			t0 = diskstats_start();
+			ok = trackcache_read(&tcache[drive], fd, &s,
+					     taddr * SPT * SEC_SZ, SPT * SEC_SZ,
+					     pos, buf, SEC_SZ);
+			diskstats_io(&dstat[drive], false, taddr, pos, SEC_SZ,
+				     t0, ok);
+			if (!ok) {
 				ioerr = IO_OURUN;
 				goto rdone;
 			}
 			if (op == OP_READ) {
-				for (i = 0; i < SEC_SZ; i++)
-					dma_write(addr++, buf[i]);
+				dma_write_block(addr, buf, SEC_SZ);
+				addr += SEC_SZ;
 			}
 		}
 
@@ -405,12 +420,17 @@ void isbc202_iopbh_out(BYTE data)
 			ioerr = IO_SEEK;
 			goto wdone;
 		}
+		trackcache_inval(&tcache[drive], pos, nsec * SEC_SZ);
 
 		/* write sectors */
-		for (; nsec > 0; nsec--) {
-			for (i = 0; i < SEC_SZ; i++)
-				buf[i] = dma_read(addr++);
-			if (write(fd, buf, SEC_SZ) != SEC_SZ) {
+		for (; nsec > 0; nsec--, pos += SEC_SZ) {
+			dma_read_block(addr, buf, SEC_SZ);
+			addr += SEC_SZ;
+			t0 = diskstats_start();
+			ok = write(fd, buf, SEC_SZ) == SEC_SZ;
+			diskstats_io(&dstat[drive], true, taddr, pos, SEC_SZ,
+				     t0, ok);
+			if (!ok) {
 				ioerr = IO_OURUN;
 				goto wdone;
 			}
@@ -13,6 +13,7 @@
  * History:
  * 03-JUN-2024 first version
  * 07-JUN-2024 rewrite of the monitor ports and the timing thread
+ * 18-OCT-2026 TTY socket read by the hostin input thread, no SIGIO
  */
 
 #include <stdio.h>
@@ -31,6 +32,7 @@
 #include "simio.h"
 
 #include "mds-monitor.h"
+#include "hostin.h"
 #include "unix_network.h"
 #include "unix_terminal.h"
 
@@ -90,6 +92,8 @@ static bool tty_init;	/* TTY initialized flag */
 static BYTE tty_cmd;	/* TTY command byte */
 static bool tty_trdy;	/* TTY transmit ready */
 static bool tty_rbr;	/* TTY receiver buffer ready */
+static hostin_t tty_hin;	/* TTY buffered telnet connection */
+static bool tty_hin_done;	/* TTY connection registered */
 
 bool crt_upper_case;
 bool crt_strip_parity;
@@ -197,26 +201,18 @@ BYTE mon_int_status_in(void)
  */
 void mon_tty_periodic(void)
 {
-	struct pollfd p[1];
 	BYTE iset;
 
 	iset = 0;
-	/* if socket is connected and receiver is enabled check for input */
-	if (ncons[0].ssc != 0 && (tty_cmd & RXEN) && !tty_rbr) {
-		p[0].fd = ncons[0].ssc;
-		p[0].events = POLLIN;
-		p[0].revents = 0;
-		poll(p, 1, 0);
-		if (p[0].revents & POLLHUP) {
-			close(ncons[0].ssc);
-			ncons[0].ssc = 0;
-		} else if (p[0].revents & POLLIN) {
-			tty_rbr = true;
-			iset |= ITTYI;
-		}
+	/* if socket is connected and receiver is enabled check for input,
+	   the CPU thread closes it on EOF */
+	if (hostin_alive(&tty_hin) && (tty_cmd & RXEN) && !tty_rbr &&
+	    hostin_ready(&tty_hin)) {
+		tty_rbr = true;
+		iset |= ITTYI;
 	}
 	/* if socket is connected and transceiver is enabled output is ready */
-	if (ncons[0].ssc != 0 && (tty_cmd & TXEN) && !tty_trdy) {
+	if (hostin_alive(&tty_hin) && (tty_cmd & TXEN) && !tty_trdy) {
 		tty_trdy = true;
 		iset |= ITTYO;
 	}
@@ -229,38 +225,28 @@ void mon_tty_periodic(void)
  */
 BYTE mon_tty_data_in(void)
 {
-	BYTE data, dummy;
+	BYTE data;
+	int c;
 	static BYTE last;
 
 	if (!(tty_cmd & RXEN) || !tty_rbr)
 		return last;
 
-	if (ncons[0].ssc == 0) {
+	/* on EOF close socket and return last */
+	if (hostin_eof(&tty_hin)) {
+		hostin_hangup(&tty_hin);
 		data = last;
 		goto done;
 	}
 
-	if (read(ncons[0].ssc, &data, 1) != 1) {
-		if ((errno == EAGAIN) || (errno == EINTR)) {
-			/* EOF, close socket and return last */
-			close(ncons[0].ssc);
-			ncons[0].ssc = 0;
-			data = last;
-			goto done;
-		} else {
-			LOGE(TAG, "can't read tcpsocket data");
-			cpu_error = IOERROR;
-			cpu_state = ST_STOPPED;
-			data = last;
-			goto done;
-		}
+	/* the input thread drops the 2nd character of telnet \r\n */
+	if ((c = hostin_get(&tty_hin)) == -1) {
+		data = last;
+		goto done;
 	}
+	data = c;
 
 	/* process read data */
-	/* telnet client sends \r\n or \r\0, drop second character */
-	if (ncons[0].telnet && (data == '\r'))
-		if (read(ncons[0].ssc, &dummy, 1) != 1)
-			LOGE(TAG, "can't read tcpsocket data");
 	if (tty_upper_case)
 		data = toupper(data);
 	last = data;
@@ -279,6 +265,10 @@ BYTE mon_tty_status_in(void)
 {
 	BYTE data;
 
+	/* close the socket when the peer closed it and all was read */
+	if (hostin_alive(&tty_hin) && hostin_eof(&tty_hin))
+		hostin_hangup(&tty_hin);
+
 	data = DSR;
 	if ((tty_cmd & TXEN) && tty_trdy)
 		data |= TBE | TRDY;
@@ -292,11 +282,13 @@ BYTE mon_tty_status_in(void)
  */
 void mon_tty_data_out(BYTE data)
 {
+	int fd;
+
 	if (!(tty_cmd & TXEN) || !tty_trdy)
 		return;
 
 	/* return if socket not connected */
-	if (ncons[0].ssc == 0)
+	if ((fd = hostin_fd(&tty_hin)) == -1)
 		goto done;
 
 	if (tty_drop_nulls && data == 0)
@@ -306,7 +298,7 @@ void mon_tty_data_out(BYTE data)
 		data &= 0x7f;
 
 again:
-	if (write(ncons[0].ssc, &data, 1) != 1) {
+	if (write(fd, &data, 1) != 1) {
 		if (errno == EINTR)
 			goto again;
 		else {
@@ -696,6 +688,32 @@ void mon_lpt_ctl_out(BYTE data)
 	UNUSED(data);
 }
 
+/*
+ *	Monitor module init, let the input thread accept and read the
+ *	telnet connection of the TTY
+ */
+void mon_init(void)
+{
+	if (tty_hin_done)
+		return;
+	tty_hin_done = true;
+
+	tty_hin.fd = -1;
+	tty_hin.ss = ncons[0].ss ? ncons[0].ss : -1;
+	tty_hin.tcp = true;
+	tty_hin.telnet = ncons[0].telnet;
+	hostin_add(&tty_hin);
+}
+
+/*
+ *	Monitor module exit, close the TTY connection
+ */
+void mon_exit(void)
+{
+	if (tty_hin_done && hostin_alive(&tty_hin))
+		hostin_hangup(&tty_hin);
+}
+
 /*
  *	Monitor module reset
  */
@@ -12,6 +12,7 @@
  * History:
  * 03-JUN-2024 first version
  * 07-JUN-2024 rewrite of the monitor ports and the timing thread
+ * 18-OCT-2026 added mon_init() and mon_exit()
  */
 
 #ifndef MDS_MONITOR_INC
@@ -58,5 +59,7 @@ extern BYTE mon_lpt_status_in(void);
 extern void mon_lpt_data_out(BYTE data), mon_lpt_ctl_out(BYTE data);
 
 extern void mon_reset(void);
+extern void mon_init(void);
+extern void mon_exit(void);
 
 #endif /* !MDS_MONITOR_INC */
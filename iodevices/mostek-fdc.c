@@ -12,6 +12,7 @@
  * 16-SEP-2019 (Mike Douglas) created from tarbell-fdc.c
  * 28-SEP-2019 (Udo Munk) use logging
  * 11-MAY-2024 (Thomas Eberhardt) add diskdir option support
+ * 18-OCT-2026 collect disk I/O statistics
  */
 
 #include <unistd.h>
@@ -24,6 +25,8 @@
 #include "simdefs.h"
 #include "simglb.h"
 
+#include "diskstats.h"
+
 #include "log.h"
 static const char *TAG = "FLP-80";
 
@@ -84,6 +87,12 @@ static char fn[MAX_LFN];	/* path/filename for disk image */
 static int fd;			/* fd for disk file i/o */
 static int dcnt;		/* data counter read/write */
 static BYTE buf[SEC_SZ];	/* buffer for one sector */
+static diskstats_t dstat[4] = {	/* disk I/O statistics */
+	DISKSTATS_INIT("FLP-80", "drive0"),
+	DISKSTATS_INIT("FLP-80", "drive1"),
+	DISKSTATS_INIT("FLP-80", "drive2"),
+	DISKSTATS_INIT("FLP-80", "drive3")
+};
 
 /*
  * get_disk_filename
@@ -323,6 +332,8 @@ void fdc1771_sec_out(BYTE data)
 BYTE fdc1771_data_in(void)
 {
 	off_t pos;		/* seek position */
+	uint64_t t0;
+	bool ok;
 
 	switch (state) {
 	case FDC_READ:		/* read data from disk sector */
@@ -363,7 +374,11 @@ BYTE fdc1771_data_in(void)
 			}
 
 			/* read the sector */
-			if (read(fd, buf, SEC_SZ) != SEC_SZ) {
+			t0 = diskstats_start();
+			ok = read(fd, buf, SEC_SZ) == SEC_SZ;
+			diskstats_io(&dstat[disk], false, fdc_track, pos,
+				     SEC_SZ, t0, ok);
+			if (!ok) {
 				state = FDC_IDLE;	/* abort read command */
 				fdc_stat = sRECORD_NOT_FOUND;
 				close(fd);
@@ -418,6 +433,7 @@ void fdc1771_data_out(BYTE data)
 	static int wrtstat;		/* state while formatting track */
 	static int bcnt;		/* byte counter for sector data */
 	static int secs;		/* # of sectors written so far */
+	uint64_t t0;
 
 	switch (state) {
 	case FDC_WRITE:			/* write data to disk sector */
@@ -468,10 +484,14 @@ void fdc1771_data_out(BYTE data)
 		/* last byte? */
 		if (dcnt == SEC_SZ) {
 			state = FDC_IDLE;
+			t0 = diskstats_start();
 			if (write(fd, buf, SEC_SZ) == SEC_SZ)
 				fdc_stat = 0;
 			else
 				fdc_stat = sWRITE_FAULT;
+			pos = (fdc_track * SPT + fdc_sec - 1) * SEC_SZ;
+			diskstats_io(&dstat[disk], true, fdc_track, pos,
+				     SEC_SZ, t0, fdc_stat == 0);
 			close(fd);
 		}
 		break;
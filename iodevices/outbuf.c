@@ -0,0 +1,142 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Common I/O devices used by various simulated machines
+ *
+ * This module implements output buffers for devices, which write
+ * each byte output by the guest to a host file descriptor. Instead
+ * of a system call for every byte the bytes are collected and written
+ * with one call when the buffer is full or when flushed.
+ *
+ * The device decides when to flush: typically when the guest polls
+ * for input, so that echoed characters show up right away, from a
+ * timer in another thread, so that output doesn't linger, and before
+ * the descriptor is closed. The buffer has a mutex, so it can be
+ * flushed from another thread than the one putting bytes into it.
+ *
+ * History:
+ * 18-OCT-2026 first version
+ */
+
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include "sim.h"
+#include "simdefs.h"
+
+#include "outbuf.h"
+
+/*
+ * write the buffer to fd, if wait is false a socket is written
+ * without blocking and the rest stays in the buffer,
+ * must be called with the mutex locked
+ */
+static bool flush_locked(outbuf_t *ob, int fd, bool wait)
+{
+	size_t done = 0;
+	ssize_t n;
+	bool ok = true;
+
+	while (done < ob->len) {
+		if (ob->sock)
+			n = send(fd, ob->buf + done, ob->len - done,
+				 wait ? 0 : MSG_DONTWAIT);
+		else
+			n = write(fd, ob->buf + done, ob->len - done);
+		if (n == -1) {
+			if (errno == EINTR)
+				continue;
+			if (!wait && ((errno == EAGAIN) ||
+				      (errno == EWOULDBLOCK)))
+				break;
+			ok = false;
+			done = ob->len;	/* drop what can't be written */
+			break;
+		}
+		done += n;
+	}
+
+	if (done < ob->len)
+		memmove(ob->buf, ob->buf + done, ob->len - done);
+	__atomic_store_n(&ob->len, ob->len - done, __ATOMIC_RELEASE);
+
+	return ok;
+}
+
+/*
+ * initialize an empty buffer, sock tells if the descriptors
+ * it is written to are sockets
+ */
+void outbuf_init(outbuf_t *ob, bool sock)
+{
+	pthread_mutex_init(&ob->mutex, NULL);
+	ob->len = 0;
+	ob->sock = sock;
+}
+
+/*
+ * put a byte into the buffer, the buffer is written to fd
+ * when it is full, returns false on a write error
+ */
+bool outbuf_put(outbuf_t *ob, int fd, BYTE data)
+{
+	bool ok = true;
+
+	pthread_mutex_lock(&ob->mutex);
+	ob->buf[ob->len] = data;
+	__atomic_store_n(&ob->len, ob->len + 1, __ATOMIC_RELEASE);
+	if (ob->len == OB_SIZE)
+		ok = flush_locked(ob, fd, true);
+	pthread_mutex_unlock(&ob->mutex);
+
+	return ok;
+}
+
+/*
+ * write the buffer to fd, returns false on a write error
+ */
+bool outbuf_flush(outbuf_t *ob, int fd, bool wait)
+{
+	bool ok = true;
+
+	if (!outbuf_pending(ob))
+		return true;
+
+	pthread_mutex_lock(&ob->mutex);
+	if (fd != -1)
+		ok = flush_locked(ob, fd, wait);
+	else
+		__atomic_store_n(&ob->len, 0, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&ob->mutex);
+
+	return ok;
+}
+
+/*
+ * write the buffer to fd when exiting, the buffer is skipped if it
+ * is locked, because exit may be called from a signal handler which
+ * interrupted the thread holding the lock
+ */
+void outbuf_drain(outbuf_t *ob, int fd)
+{
+	if (!outbuf_pending(ob) || (fd == -1))
+		return;
+
+	if (pthread_mutex_trylock(&ob->mutex) == 0) {
+		flush_locked(ob, fd, true);
+		pthread_mutex_unlock(&ob->mutex);
+	}
+}
+
+/*
+ * drop the buffered bytes, e.g. when the descriptor is closed
+ */
+void outbuf_discard(outbuf_t *ob)
+{
+	pthread_mutex_lock(&ob->mutex);
+	__atomic_store_n(&ob->len, 0, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&ob->mutex);
+}
@@ -0,0 +1,46 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Common I/O devices used by various simulated machines
+ *
+ * This module implements output buffers, which collect the bytes
+ * written by the guest to a device and write them to the host file
+ * descriptor in one go, see outbuf.c for details.
+ *
+ * History:
+ * 18-OCT-2026 first version
+ */
+
+#ifndef OUTBUF_INC
+#define OUTBUF_INC
+
+#include <stddef.h>
+#include <pthread.h>
+
+#include "sim.h"
+#include "simdefs.h"
+
+#define OB_SIZE		4096	/* size of an output buffer */
+
+typedef struct outbuf {
+	pthread_mutex_t mutex;	/* serializes buffering and flushing */
+	size_t len;		/* number of buffered bytes */
+	bool sock;		/* descriptor is a socket */
+	BYTE buf[OB_SIZE];
+} outbuf_t;
+
+/*
+ * true if bytes are waiting to be written, without locking
+ */
+static inline bool outbuf_pending(outbuf_t *ob)
+{
+	return __atomic_load_n(&ob->len, __ATOMIC_ACQUIRE) != 0;
+}
+
+extern void outbuf_init(outbuf_t *ob, bool sock);
+extern bool outbuf_put(outbuf_t *ob, int fd, BYTE data);
+extern bool outbuf_flush(outbuf_t *ob, int fd, bool wait);
+extern void outbuf_drain(outbuf_t *ob, int fd);
+extern void outbuf_discard(outbuf_t *ob);
+
+#endif /* !OUTBUF_INC */
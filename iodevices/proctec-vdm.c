@@ -15,16 +15,23 @@
  * 15-JUL-2018 use logging
  * 04-NOV-2019 eliminate usage of mem_base()
  * 03-JAN-2025 use SDL2 instead of X11
+ * 18-OCT-2026 draw characters from a glyph atlas, only changed cells
+ * 18-OCT-2026 headless capture of the frames
+ * 18-OCT-2026 delta encoded frames for the web frontend
+ * 18-OCT-2026 copy to the X11 window only if the screen changed
  */
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #ifdef WANT_SDL
 #include <SDL.h>
 #else
 #include <X11/X.h>
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
+#endif
+#if !defined(WANT_SDL) || defined(HAS_NETSERVER)
 #include <pthread.h>
 #endif
 
@@ -39,8 +46,16 @@
 
 #include "proctec-vdm-charset.h"
 #include "proctec-vdm.h"
+#include "textmode.h"
+#ifdef HAS_VIDCAP
+#include "vidcap.h"
+#endif
+#ifdef HAS_NETSERVER
+#include "netsrv.h"
+#include "wsframe.h"
+#endif
 
-#ifndef WANT_SDL
+#if !defined(WANT_SDL) || defined(HAS_NETSERVER)
 #include "log.h"
 static const char *TAG = "VDM";
 #endif
@@ -56,15 +71,14 @@ int slf = 1;				/* scanlines factor, default no lines */
 uint8_t bg_color[3] = {48, 48, 48};	/* default background color */
 uint8_t fg_color[3] = {255, 255, 255};	/* default foreground color */
 static int xsize, ysize;		/* window size */
-static int sx, sy;
+static uint32_t pix_black, pix_bg, pix_fg; /* pixels of the colors */
+static tm_screen_t tscreen;		/* text screen */
+static tm_atlas_t atlas;		/* glyphs of the character ROM */
 #ifdef WANT_SDL
 static int proctec_win_id = -1;
 static SDL_Window *window;
 static SDL_Renderer *renderer;
 static SDL_Texture *texture;
-static uint8_t *pixels;
-static int pitch;
-static uint8_t color[3];
 static char keybuf[KEYBUF_LEN];		/* typeahead buffer */
 static int keyn, keyin, keyout;
 static SDL_mutex *keybuf_mutex;
@@ -75,10 +89,12 @@ static int screen;
 static GC gc;
 static XWindowAttributes wa;
 static Pixmap pixmap;
+static XImage *ximage;
 static Colormap colormap;
 static XColor black, bg, fg;
 static char black_color[] = "#000000";	/* black */
 static XEvent event;
+static bool exposed;			/* window needs a copy of the pixmap */
 static KeySym key;
 static char text[10];
 #endif
@@ -97,6 +113,20 @@ static int beg;				/* beginning display line address */
 /* UNIX stuff */
 static pthread_t thread;
 #endif
+#ifdef HAS_NETSERVER
+static pthread_t ws_thread;
+static wsframe_t wsf;			/* frames for /vdm */
+#endif
+
+/* create the text screen with the glyphs of the character ROM */
+static void init_screen(void)
+{
+	/* glyph 0-127 normal, glyph 128-255 inverse, same as bit 7 */
+	tm_atlas_build(&atlas, &charset[0][0][0], 128, 9, 13, 1, 1, slf,
+		       pix_fg, pix_bg, pix_black);
+	tm_screen_init(&tscreen, xsize, ysize, 64 * 16, pix_black);
+	tm_layout(&tscreen, &atlas, 64, 16, XOFF, YOFF);
+}
 
 /* create the SDL2 or X11 window for VDM display */
 static void open_display(void)
@@ -118,6 +148,10 @@ static void open_display(void)
 	SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
 	SDL_RenderClear(renderer);
 	SDL_RenderPresent(renderer);
+
+	pix_black = tm_rgba((uint8_t [3]) {0, 0, 0});
+	pix_bg = tm_rgba(bg_color);
+	pix_fg = tm_rgba(fg_color);
 #else /* !WANT_SDL */
 	Window rootwindow;
 	XSizeHints *size_hints = XAllocSizeHints();
@@ -143,7 +177,7 @@ static void open_display(void)
 	XFree(size_hints);
 	wm_delete_window = XInternAtom(display, "WM_DELETE_WINDOW", False);
 	XSetWMProtocols(display, window, &wm_delete_window, 1);
-	XSelectInput(display, window, KeyPressMask);
+	XSelectInput(display, window, KeyPressMask | ExposureMask);
 	colormap = DefaultColormap(display, 0);
 	gc = XCreateGC(display, window, 0, NULL);
 	pixmap = XCreatePixmap(display, rootwindow, xsize, ysize, wa.depth);
@@ -156,18 +190,30 @@ static void open_display(void)
 	sprintf(buf, "#%02X%02X%02X", fg_color[0], fg_color[1], fg_color[2]);
 	XParseColor(display, colormap, buf, &fg);
 	XAllocColor(display, colormap, &fg);
+	pix_black = black.pixel;
+	pix_bg = bg.pixel;
+	pix_fg = fg.pixel;
+
+	ximage = XCreateImage(display, DefaultVisual(display, screen),
+			      wa.depth, ZPixmap, 0, NULL, xsize, ysize, 32, 0);
+	ximage->data = malloc(ximage->bytes_per_line * ysize);
+	/* force little-endian pixels, Xlib will convert if necessary */
+	ximage->byte_order = LSBFirst;
 
 	XMapWindow(display, window);
-	XSetForeground(display, gc, black.pixel);
-	XFillRectangle(display, pixmap, gc, 0, 0, xsize, ysize);
 	XSync(display, True);
 	XUnlockDisplay(display);
 #endif /* !WANT_SDL */
+
+	init_screen();
 }
 
 /* close the SDL2 or X11 window for VDM display */
 static void close_display(void)
 {
+	tm_screen_free(&tscreen);
+	tm_atlas_free(&atlas);
+
 #ifdef WANT_SDL
 	SDL_DestroyMutex(keybuf_mutex);
 	SDL_DestroyTexture(texture);
@@ -175,6 +221,7 @@ static void close_display(void)
 	SDL_DestroyWindow(window);
 #else
 	XLockDisplay(display);
+	XDestroyImage(ximage);
 	XFreePixmap(display, pixmap);
 	XFreeGC(display, gc);
 	XUnlockDisplay(display);
@@ -187,6 +234,16 @@ void proctec_vdm_off(void)
 {
 	state = false;		/* tell refresh thread to stop */
 
+#ifdef HAS_NETSERVER
+	if (n_flag) {
+		if (ws_thread != 0) {
+			pthread_join(ws_thread, NULL);
+			ws_thread = 0;
+		}
+		return;
+	}
+#endif
+
 #ifdef WANT_SDL
 	if (proctec_win_id >= 0) {
 		simsdl_destroy(proctec_win_id);
@@ -264,30 +321,6 @@ static void process_event(SDL_Event *event)
 	}
 }
 
-static inline void set_fg_color(void)
-{
-	color[0] = fg_color[0];
-	color[1] = fg_color[1];
-	color[2] = fg_color[2];
-}
-
-static inline void set_bg_color(void)
-{
-	color[0] = bg_color[0];
-	color[1] = bg_color[1];
-	color[2] = bg_color[2];
-}
-
-static inline void draw_point(int x, int y)
-{
-	uint8_t *p = pixels + y * pitch + x * 4;
-
-	p[3] = color[0];
-	p[2] = color[1];
-	p[1] = color[2];
-	p[0] = SDL_ALPHA_OPAQUE;
-}
-
 #else /* !WANT_SDL */
 
 /*
@@ -303,81 +336,62 @@ static inline void event_handler(void)
 		return;
 
 	/* if there is a keyboard event get it and convert with keymap */
-	if (XEventsQueued(display, QueuedAlready) > 0) {
+	if (display != NULL && XEventsQueued(display, QueuedAlready) > 0) {
 		XNextEvent(display, &event);
 		if ((event.type == KeyPress) &&
 		    XLookupString(&event.xkey, text, 1, &key, 0) == 1) {
 			kbd_data = text[0];
 			kbd_status = true;
-		}
+		} else if (event.type == Expose)
+			exposed = true;
 	}
 }
 
-static inline void set_fg_color(void)
-{
-	XSetForeground(display, gc, fg.pixel);
-}
-
-static inline void set_bg_color(void)
-{
-	XSetForeground(display, gc, bg.pixel);
-}
-
-static inline void draw_point(int x, int y)
+/*
+ * copy the changed part of the frame buffer into the pixmap,
+ * returns false if nothing changed
+ */
+static bool put_screen(void)
 {
-	XDrawPoint(display, pixmap, gc, x, y);
+	int x, y, w, h, i, j;
+	uint32_t *q;
+
+	if (!tm_dirty(&tscreen, &x, &y, &w, &h))
+		return false;
+
+	for (j = y; j < y + h; j++) {
+		q = tscreen.fb + j * tscreen.w;
+		if (ximage->bits_per_pixel == 32)
+			memcpy(ximage->data + j * ximage->bytes_per_line +
+			       x * 4, q + x, w * 4);
+		else
+			for (i = x; i < x + w; i++)
+				XPutPixel(ximage, i, j, q[i]);
+	}
+	XPutImage(display, pixmap, gc, ximage, x, y, x, y, w, h);
+	return true;
 }
 
 #endif /* !WANT_SDL */
 
-/* display characters, bit 7 = inverse video */
-static void dc(BYTE c)
-{
-	register int x, y;
-	bool inv = (c & 128) ? true : false;
-
-	for (x = 0; x < 9; x++) {
-		for (y = 0; y < 13; y++) {
-			if (charset[c & 0x7f][y][x] == 1) {
-				if (!inv)
-					set_fg_color();
-				else
-					set_bg_color();
-			} else {
-				if (!inv)
-					set_bg_color();
-				else
-					set_fg_color();
-			}
-			draw_point(sx + x, sy + (y * slf));
-		}
-	}
-}
-
-/* refresh the display buffer */
+/* refresh the display buffer, only cells with another glyph are drawn */
 static void refresh(void)
 {
-	register int x, y;
-	static int addr;
-	static BYTE c;
+	int x, y;
+	WORD addr;
 
-	sy = YOFF;
 	addr = 0xcc00 + beg * 64;
 
 	for (y = 0; y < 16; y++) {
-		sx = XOFF;
 #ifndef WANT_SDL
 		event_handler();
 #endif
 		for (x = 0; x < 64; x++) {
-			if (y >= first) {
-				c = getmem(addr + x);
-				dc(c);
-			} else
-				dc(' ');
-			sx += 9;
+			if (y >= first)
+				tm_put(&tscreen, x, y, getmem(addr + x));
+			else
+				tm_put(&tscreen, x, y, ' ');
 		}
-		sy += 13 * slf;
 		addr += 64;
 		if (addr >= 0xd000)
 			addr = 0xcc00;
@@ -389,13 +403,17 @@ static void refresh(void)
 /* function for updating the display */
 static void update_display(bool tick)
 {
+	SDL_Rect r;
+
 	UNUSED(tick);
 
 	if (state) {
-		/* update display window */
-		SDL_LockTexture(texture, NULL, (void **) &pixels, &pitch);
+		/* update display window, upload only the changed pixels */
 		refresh();
-		SDL_UnlockTexture(texture);
+		if (tm_dirty(&tscreen, &r.x, &r.y, &r.w, &r.h))
+			SDL_UpdateTexture(texture, &r,
+					  tscreen.fb + r.y * tscreen.w + r.x,
+					  tscreen.w * sizeof(uint32_t));
 		SDL_RenderCopy(renderer, texture, NULL, NULL);
 		SDL_RenderPresent(renderer);
 	}
@@ -425,11 +443,18 @@ static void *update_display(void *arg)
 		pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
 		XLockDisplay(display);
 
-		/* update display window */
+		/* read events, the window needs a copy if exposed */
+		exposed = false;
+		while (XCheckTypedWindowEvent(display, window, Expose, &event))
+			exposed = true;
+
+		/* update display window, only if something changed */
 		refresh();
-		XCopyArea(display, pixmap, window, gc, 0, 0,
-			  xsize, ysize, 0, 0);
-		XSync(display, False);
+		if (put_screen() || exposed) {
+			XCopyArea(display, pixmap, window, gc, 0, 0,
+				  xsize, ysize, 0, 0);
+			XSync(display, False);
+		}
 
 		/* unlock display, thread can be canceled again */
 		XUnlockDisplay(display);
@@ -448,6 +473,81 @@ static void *update_display(void *arg)
 
 #endif /* !WANT_SDL */
 
+#ifdef HAS_NETSERVER
+/* thread for sending the screen to the web frontend */
+static void *ws_update(void *arg)
+{
+	BYTE scr[64 * 16];
+	uint64_t t;
+	long tleft;
+	int x, y;
+	WORD addr;
+
+	UNUSED(arg);
+
+	t = get_clock_us();
+
+	while (state) {
+		/* the cells as displayed, same as refresh() */
+		if (net_device_ready(DEV_VDM)) {
+			addr = 0xcc00 + beg * 64;
+			for (y = 0; y < 16; y++) {
+				for (x = 0; x < 64; x++)
+					scr[y * 64 + x] = (y >= first) ?
+							  getmem(addr + x) : ' ';
+				addr += 64;
+				if (addr >= 0xd000)
+					addr = 0xcc00;
+			}
+			wsframe_send(&wsf, 0, scr, sizeof(scr));
+		}
+
+		/* sleep rest to 33333us so that we get 30 fps */
+		tleft = 33333L - (long) (get_clock_us() - t);
+		if (tleft > 0)
+			sleep_for_us(tleft);
+
+		t = get_clock_us();
+	}
+
+	/* an empty frame clears the screen */
+	wsframe_send(&wsf, 0, NULL, 0);
+
+	pthread_exit(NULL);
+}
+#endif /* HAS_NETSERVER */
+
+#ifdef HAS_VIDCAP
+/* draw a frame for the headless capture */
+static const uint32_t *capture_frame(void)
+{
+	if (state)
+		refresh();
+	else
+		tm_clear(&tscreen, pix_black);
+
+	return tscreen.fb;
+}
+
+static vidcap_t vdm_cap = { .name = "vdm", .render = capture_frame };
+
+/* create the text screen for the headless capture instead of a window */
+static void open_capture(void)
+{
+	xsize = 576 + (XOFF * 2);
+	ysize = (208 * slf) + (YOFF * 2);
+
+	pix_black = vidcap_rgb((uint8_t [3]) {0, 0, 0});
+	pix_bg = vidcap_rgb(bg_color);
+	pix_fg = vidcap_rgb(fg_color);
+	init_screen();
+
+	vdm_cap.w = xsize;
+	vdm_cap.h = ysize;
+	vidcap_add(&vdm_cap);
+}
+#endif /* HAS_VIDCAP */
+
 /* I/O port for the VDM */
 void proctec_vdm_ctl_out(BYTE data)
 {
@@ -457,6 +557,37 @@ void proctec_vdm_ctl_out(BYTE data)
 
 	state = true;
 
+#ifdef HAS_VIDCAP
+	/* frames are drawn by the CPU thread in emulated time */
+	if (V_flag) {
+		if (tscreen.fb == NULL)
+			open_capture();
+		return;
+	}
+#endif
+
+#ifdef HAS_NETSERVER
+	/* frames are sent to the web frontend instead of a window */
+	if (n_flag) {
+		if (ws_thread == 0) {
+			if (wsf.buf == NULL) {
+				wsframe_init(&wsf, DEV_VDM, 64 * 16);
+				wsf.font = &charset[0][0][0];
+				wsf.fw = 9;
+				wsf.fh = 13;
+				wsf.fn = 128;
+				wsf.fg = fg_color;
+				wsf.bg = bg_color;
+			}
+			if (pthread_create(&ws_thread, NULL, ws_update, NULL)) {
+				LOGE(TAG, "can't create thread");
+				exit(EXIT_FAILURE);
+			}
+		}
+		return;
+	}
+#endif
+
 #ifdef WANT_SDL
 	if (proctec_win_id < 0)
 		proctec_win_id = simsdl_create(&proctec_funcs);
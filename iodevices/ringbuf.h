@@ -0,0 +1,110 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Common I/O devices used by various simulated machines
+ *
+ * This module implements a lock-free byte ring buffer for one producer
+ * and one consumer thread. Typically an input thread reads from host
+ * file descriptors and puts the bytes into the ring, and the I/O port
+ * handlers of the CPU thread test and get them with plain memory
+ * accesses, without a system call for each status or data read.
+ *
+ * The producer marks the end of its input with rb_close(), the
+ * consumer resets the ring with rb_reset() when the producer is
+ * known not to touch it.
+ *
+ * A ringbuf_t initialized with zeros is empty.
+ *
+ * History:
+ * 18-OCT-2026 first version
+ */
+
+#ifndef RINGBUF_INC
+#define RINGBUF_INC
+
+#include <stddef.h>
+
+#include "sim.h"
+#include "simdefs.h"
+
+#define RB_SIZE		1024	/* size of a ring, must be a power of two */
+
+typedef struct ringbuf {
+	unsigned head;		/* next put position, written by producer */
+	unsigned tail;		/* next get position, written by consumer */
+	bool closed;		/* producer reached end of input */
+	BYTE buf[RB_SIZE];
+} ringbuf_t;
+
+/*
+ * number of bytes in the ring
+ */
+static inline size_t rb_count(ringbuf_t *rb)
+{
+	return __atomic_load_n(&rb->head, __ATOMIC_ACQUIRE) -
+	       __atomic_load_n(&rb->tail, __ATOMIC_ACQUIRE);
+}
+
+static inline bool rb_empty(ringbuf_t *rb)
+{
+	return rb_count(rb) == 0;
+}
+
+static inline size_t rb_space(ringbuf_t *rb)
+{
+	return RB_SIZE - rb_count(rb);
+}
+
+/*
+ * producer: put a byte into the ring, false if the ring is full
+ */
+static inline bool rb_put(ringbuf_t *rb, BYTE data)
+{
+	unsigned head = __atomic_load_n(&rb->head, __ATOMIC_RELAXED);
+
+	if (head - __atomic_load_n(&rb->tail, __ATOMIC_ACQUIRE) == RB_SIZE)
+		return false;
+	rb->buf[head & (RB_SIZE - 1)] = data;
+	__atomic_store_n(&rb->head, head + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+/*
+ * consumer: get a byte from the ring, false if the ring is empty
+ */
+static inline bool rb_get(ringbuf_t *rb, BYTE *data)
+{
+	unsigned tail = __atomic_load_n(&rb->tail, __ATOMIC_RELAXED);
+
+	if (__atomic_load_n(&rb->head, __ATOMIC_ACQUIRE) == tail)
+		return false;
+	*data = rb->buf[tail & (RB_SIZE - 1)];
+	__atomic_store_n(&rb->tail, tail + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+/*
+ * producer: mark end of input
+ */
+static inline void rb_close(ringbuf_t *rb)
+{
+	__atomic_store_n(&rb->closed, true, __ATOMIC_RELEASE);
+}
+
+static inline bool rb_closed(ringbuf_t *rb)
+{
+	return __atomic_load_n(&rb->closed, __ATOMIC_ACQUIRE);
+}
+
+/*
+ * consumer: empty the ring and clear end of input
+ */
+static inline void rb_reset(ringbuf_t *rb)
+{
+	__atomic_store_n(&rb->tail, __atomic_load_n(&rb->head,
+						    __ATOMIC_ACQUIRE),
+			 __ATOMIC_RELEASE);
+	__atomic_store_n(&rb->closed, false, __ATOMIC_RELEASE);
+}
+
+#endif /* !RINGBUF_INC */
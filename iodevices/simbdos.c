@@ -21,6 +21,23 @@
  * as 128 byte sectors until an EOF character (0x1A, ctrl-z) is found.
  * This results in the last write typically being less than 128 bytes.
  *
+ * In addition to the BDOS like functions, multiple records can be
+ * transferred with one request:
+ *
+ * READM    DE = number of records to read into memory at the DMA address.
+ *	    Returns A = 0 and the number of records read in HL, or
+ *	    A = 0xff if the end of the file was reached.
+ * WRITEM   DE = number of records to write from memory at the DMA
+ *	    address. Text files are written up to the first ctrl-z.
+ *	    Returns A = 0, or A = 0xff on error.
+ * READALL  DE = last address of a memory range starting at the DMA
+ *	    address. The whole file is read into this range. Returns
+ *	    the number of records read in HL and A = 0 if the whole
+ *	    file did fit, A = 1 if not (the rest can be read with READM)
+ *	    or A = 0xff on error.
+ *
+ * At most 512 records (64 KB) are transferred with one request.
+ *
  * The CP/M programs R.COM and W.COM use this interface to transfer
  * files between the host and CP/M file systems. Note that on a
  * case-sensitive operating system, file names must be in all caps
@@ -29,11 +46,15 @@
  * History:
  * 03-OCT-2019 (Mike Douglas) Original
  * 23-JAN-2025 (Thomas Eberhardt) Use DMA memory access
+ * 18-OCT-2026 Use DMA block memory access
+ * 18-OCT-2026 Use unbuffered host file I/O, added multi-record transfers
  */
 
+#include <unistd.h>
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
+#include <fcntl.h>
 
 #include "sim.h"
 #include "simdefs.h"
@@ -51,7 +72,14 @@
 #define MAKEF	22		/* make file */
 #define SETDMA	26		/* set DMA address */
 
+/* Host file I/O extensions */
+
+#define READM	200		/* read multiple records */
+#define WRITEM	201		/* write multiple records */
+#define READALL	202		/* read whole file into memory range */
+
 #define	SECLEN	128		/* logical sector length */
+#define MAXRECS	512		/* max. number of records per transfer */
 #define	CTRL_Z	0x1A		/* CP/M EOF character */
 
 /* The following file types will be treated as text files */
@@ -64,9 +92,54 @@ static const char *textExts[] = {
 
 /* Static variables */
 
-static FILE *fp = NULL;		/* file pointer */
+static int fd = -1;		/* file descriptor */
 static WORD dmaAddr = 0x80;	/* buffer address in emulated space */
 static bool textFile = false;	/* text file flag */
+static BYTE xferBuf[MAXRECS * SECLEN]; /* transfer buffer */
+
+/*
+ * readRecs - read up to n records from the host file into memory at
+ *    the DMA address, a partial last record is filled with ctrl-z.
+ *    Returns the number of records read.
+ */
+
+static int readRecs(int n)
+{
+	int len = 0;
+	int i;
+
+	if (n > MAXRECS)
+		n = MAXRECS;
+	while (len < n * SECLEN) {
+		if ((i = read(fd, xferBuf + len, n * SECLEN - len)) <= 0)
+			break;
+		len += i;
+	}
+	n = (len + SECLEN - 1) / SECLEN;
+	memset(xferBuf + len, CTRL_Z, n * SECLEN - len);
+	dma_write_block(dmaAddr, xferBuf, n * SECLEN);
+	return n;
+}
+
+/*
+ * writeRecs - write n records from memory at the DMA address to the
+ *    host file, text files are written up to the first ctrl-z.
+ *    Returns false on a write error.
+ */
+
+static bool writeRecs(int n)
+{
+	BYTE *p;
+	int len;
+
+	if (n > MAXRECS)
+		n = MAXRECS;
+	len = n * SECLEN;
+	dma_read_block(dmaAddr, xferBuf, len);
+	if (textFile && (p = memchr(xferBuf, CTRL_Z, len)) != NULL)
+		len = p - xferBuf;	/* ctrl-z (EOF) found */
+	return len == 0 || write(fd, xferBuf, len) == len;
+}
 
 /*
  * host_bdos_out - an output to this I/O device is somewhat equivalent
@@ -81,9 +154,9 @@ void host_bdos_out(BYTE outByte)
 	WORD fcbAddr;		/* address of FCB in simulator memory */
 	char fname[16];
 	char extension[8];
-	BYTE buf[128];
-	char openFlags[4];	/* flags for fopen call */
-	int xferLen;
+	BYTE fcb[12];		/* drive, file name and extension of FCB */
+	int openFlags;		/* flags for open call */
+	int n;
 	int i;
 
 	outByte = ~outByte;	/* compiler requires assignment */
@@ -96,15 +169,17 @@ void host_bdos_out(BYTE outByte)
 	fcbAddr = (D << 8) + E;	/* FCB address in simulator memory */
 
 	if ((C == OPENF) || (C == MAKEF)) {
+		dma_read_block(fcbAddr, fcb, sizeof(fcb));
+
 		for (i = 0; i < 8; i++) {	/* copy file name */
-			fname[i] = tolower(dma_read(fcbAddr + 1 + i));
+			fname[i] = tolower(fcb[1 + i]);
 			if (fname[i] == ' ')
 				break;
 		}
 		fname[i] = 0;
 
 		for (i = 0; i < 3; i++) {	/* copy extension */
-			extension[i] = tolower(dma_read(fcbAddr + 9 + i));
+			extension[i] = tolower(fcb[9 + i]);
 			if (extension[i] == ' ')
 				break;
 		}
@@ -116,13 +191,12 @@ void host_bdos_out(BYTE outByte)
 		}
 
 		if (C == MAKEF) {
-			strcpy(openFlags, "wb"); /* MAKEF opens for writing */
+			/* MAKEF opens for writing */
+			openFlags = O_WRONLY | O_CREAT | O_TRUNC;
 
 #ifdef SIMBDOS_NO_OVERWRITE
-			if (fopen(fname, "rb") != NULL) { /* file exist? */
-				fclose(fp);
-				openFlags[0] = 0; /* yes, don't over-write */
-			}
+			if (access(fname, F_OK) == 0) /* file exist? */
+				openFlags = -1;	/* yes, don't over-write */
 #endif
 			textFile = false;	/* binary file is assumed */
 			for (i = 0; textExts[i] != NULL; i++)
@@ -131,50 +205,39 @@ void host_bdos_out(BYTE outByte)
 					break;
 				}
 		} else
-			strcpy(openFlags, "rb"); /* OPENF for reading */
+			openFlags = O_RDONLY;	/* OPENF for reading */
 
-		if (openFlags[0] != 0)		/* don't open if null string */
-			if ((fp = fopen(fname, openFlags)) != NULL)
+		if (fd != -1) {			/* close a left over file */
+			close(fd);
+			fd = -1;
+		}
+		if (openFlags != -1)		/* don't open if -1 */
+			if ((fd = open(fname, openFlags, 0644)) != -1)
 				A = 0;		/* success */
 	}
 
 	/* CLOSE file */
 
 	else if (C == CLOSEF) {
-		if (fp != NULL)
-			fclose(fp);
+		if (fd != -1) {
+			close(fd);
+			fd = -1;
+		}
 		A = 0;
 	}
 
 	/* READ file */
 
 	else if (C == READF) {
-		if (fp != NULL) {
-			xferLen = fread(buf, 1, SECLEN, fp);
-			if (xferLen != 0) {
-				for (i = 0; i < xferLen; i++)
-					dma_write(dmaAddr + i, buf[i]);
-				for (; i < SECLEN; i++)
-					dma_write(dmaAddr + i, CTRL_Z);
-				A = 0;
-			}
-		}
+		if (fd != -1 && readRecs(1) != 0)
+			A = 0;
 	}
 
 	/* WRITE file */
 
 	else if (C == WRITEF) {
-		if (fp != NULL) {
-			for (xferLen = 0; xferLen < SECLEN; xferLen++) {
-				buf[xferLen] = dma_read(dmaAddr + xferLen);
-				if ((buf[xferLen] == CTRL_Z) && textFile)
-					break;	/* ctrl-z (EOF) found */
-			}
-			if (xferLen == 0)	/* record contains only ctrl-z */
-				A = 0;
-			else if ((size_t) xferLen == fwrite(buf, 1, xferLen, fp))
-				A = 0;
-		}
+		if (fd != -1 && writeRecs(1))
+			A = 0;
 	}
 
 	/* Set DMA Address */
@@ -183,4 +246,38 @@ void host_bdos_out(BYTE outByte)
 		dmaAddr = fcbAddr;
 		A = 0;
 	}
+
+	/* READ multiple records */
+
+	else if (C == READM) {
+		H = L = 0;
+		if (fd != -1 && (n = readRecs(fcbAddr)) != 0) {
+			H = n >> 8;
+			L = n & 0xff;
+			A = 0;
+		}
+	}
+
+	/* WRITE multiple records */
+
+	else if (C == WRITEM) {
+		if (fd != -1 && writeRecs(fcbAddr))
+			A = 0;
+	}
+
+	/* READ whole file into memory range */
+
+	else if (C == READALL) {
+		H = L = 0;
+		if (fd != -1 && fcbAddr >= dmaAddr
+		    && lseek(fd, 0, SEEK_SET) != -1) {
+			n = readRecs((fcbAddr - dmaAddr + 1) / SECLEN);
+			H = n >> 8;
+			L = n & 0xff;
+			/* check if there is more */
+			A = (read(fd, xferBuf, 1) == 1) ? 1 : 0;
+			if (A)
+				lseek(fd, -1, SEEK_CUR);
+		}
+	}
 }
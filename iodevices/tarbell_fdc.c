@@ -23,6 +23,8 @@
  * 15-JUL-2018 use logging
  * 23-SEP-2019 bug fixes and improvements by Mike Douglas
  * 24-SEP-2019 restore and seek also affect step direction
+ * 18-OCT-2026 read ahead whole tracks from disk images
+ * 18-OCT-2026 collect disk I/O statistics
  */
 
 #include <unistd.h>
@@ -36,6 +38,8 @@
 #include "simglb.h"
 
 #include "tarbell_fdc.h"
+#include "trackcache.h"
+#include "diskstats.h"
 
 #include "log.h"
 static const char *TAG = "Tarbell";
@@ -62,6 +66,13 @@ static int fd;			/* fd for disk file i/o */
 static int dcnt;		/* data counter read/write */
 static BYTE buf[SEC_SZ];	/* buffer for one sector */
 static int stepdir = -1;	/* stepping direction */
+static trackcache_t tcache[4];	/* read-ahead buffers for the disks */
+static diskstats_t dstat[4] = {	/* I/O statistics for the disks */
+	DISKSTATS_INIT("Tarbell", "drivea.dsk"),
+	DISKSTATS_INIT("Tarbell", "driveb.dsk"),
+	DISKSTATS_INIT("Tarbell", "drivec.dsk"),
+	DISKSTATS_INIT("Tarbell", "drived.dsk")
+};
 
 /* these are our disk drives */
 static const char *disks[4] = {
@@ -242,6 +253,8 @@ BYTE tarbell_data_in(void)
 {
 	off_t pos;		/* seek position */
 	struct stat s;
+	uint64_t t0;
+	bool ok;
 
 	switch (state) {
 	case FDC_READ:		/* read data from disk sector */
@@ -282,17 +295,15 @@ BYTE tarbell_data_in(void)
 				return (BYTE) 0;
 			}
 
-			/* seek to sector */
+			/* read the sector, or the whole track if not cached */
 			pos = (fdc_track * SPT + fdc_sec - 1) * SEC_SZ;
-			if (lseek(fd, pos, SEEK_SET) == -1L) {
-				state = FDC_IDLE;	/* abort command */
-				fdc_stat = 0x10;	/* record not found */
-				close(fd);
-				return (BYTE) 0;
-			}
-
-			/* read the sector */
-			if (read(fd, buf, SEC_SZ) != SEC_SZ) {
+			t0 = diskstats_start();
+			ok = trackcache_read(&tcache[disk], fd, &s,
+					     fdc_track * SPT * SEC_SZ,
+					     SPT * SEC_SZ, pos, buf, SEC_SZ);
+			diskstats_io(&dstat[disk], false, fdc_track, pos, SEC_SZ,
+				     t0, ok);
+			if (!ok) {
 				state = FDC_IDLE;	/* abort read command */
 				fdc_stat = 0x10;	/* record not found */
 				close(fd);
@@ -346,6 +357,7 @@ void tarbell_data_out(BYTE data)
 	static int bcnt;		/* byte counter for sector data */
 	static int secs;		/* # of sectors written so far */
 	struct stat s;
+	uint64_t t0;
 
 	switch (state) {
 	case FDC_WRITE:			/* write data to disk sector */
@@ -397,6 +409,7 @@ void tarbell_data_out(BYTE data)
 				close(fd);
 				return;
 			}
+			trackcache_inval(&tcache[disk], pos, SEC_SZ);
 		}
 
 		/* write data bytes into sector buffer */
@@ -405,16 +418,21 @@ void tarbell_data_out(BYTE data)
 		/* last byte? */
 		if (dcnt == SEC_SZ) {
 			state = FDC_IDLE;		/* reset DRQ */
+			t0 = diskstats_start();
 			if (write(fd, buf, SEC_SZ) == SEC_SZ)
 				fdc_stat = 0;
 			else
 				fdc_stat = 0x20;	/* write fault */
+			pos = (fdc_track * SPT + fdc_sec - 1) * SEC_SZ;
+			diskstats_io(&dstat[disk], true, fdc_track, pos, SEC_SZ,
+				     t0, fdc_stat == 0);
 			close(fd);
 		}
 		break;
 
 	case FDC_WRTTRK:		/* write (format) TRACK */
 		if (dcnt == 0) {
+			trackcache_flush(&tcache[disk]);
 			/* unlink disk image */
 			dsk_path();
 			strcat(fn, "/");
@@ -0,0 +1,232 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Common I/O devices used by various simulated machines
+ *
+ * This module implements the text screen of the video boards, which
+ * display characters from a ROM. The character ROM is rasterized once
+ * into a glyph atlas for a scale, with every character in normal and
+ * inverse video, so a cell is drawn by copying its lines from the atlas.
+ * The screen remembers the glyph shown in each cell and only cells with
+ * another glyph are drawn again. The rectangle of changed pixels tells
+ * the display what to upload, an unchanged screen costs nothing more
+ * than the compare of the cells.
+ *
+ * Glyph g of the atlas is character g of the ROM, glyph g + nchars the
+ * same character in inverse video. With scanlines only every slf-th
+ * line of a cell shows the character, the others are drawn in the gap
+ * color.
+ *
+ * History:
+ * 18-OCT-2026 first version
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+#include "simdefs.h"
+
+#include "textmode.h"
+
+/* #define LOG_LOCAL_LEVEL LOG_DEBUG */
+#include "log.h"
+static const char *TAG = "textmode";
+
+/*
+ * allocate memory or give up
+ */
+static void *tm_alloc(size_t size)
+{
+	void *p;
+
+	if ((p = malloc(size)) == NULL) {
+		LOGE(TAG, "can't allocate %zu bytes for text screen", size);
+		exit(EXIT_FAILURE);
+	}
+
+	return p;
+}
+
+/*
+ * rasterize nchars characters of gw * gh pixels from font into atlas a,
+ * every pixel is scaled to xscale * yscale pixels, font pixels are 1 for
+ * the foreground color fg and 0 for the background color bg
+ */
+void tm_atlas_build(tm_atlas_t *a, const char *font, int nchars,
+		    int gw, int gh, int xscale, int yscale, int slf,
+		    uint32_t fg, uint32_t bg, uint32_t gap)
+{
+	const char *bits;
+	uint32_t *p;
+	int g, x, y;
+	bool inv;
+
+	a->cw = gw * xscale;
+	a->ch = gh * yscale * slf;
+	a->nglyphs = 2 * nchars;
+	a->pix = tm_alloc((size_t) a->nglyphs * a->cw * a->ch *
+			  sizeof(uint32_t));
+
+	p = a->pix;
+	for (g = 0; g < a->nglyphs; g++) {
+		bits = font + (g % nchars) * gw * gh;
+		inv = g >= nchars;
+		for (y = 0; y < a->ch; y++) {
+			for (x = 0; x < a->cw; x++) {
+				if (y % slf)
+					*p++ = gap;
+				else if ((bits[(y / slf / yscale) * gw +
+					       x / xscale] == 1) != inv)
+					*p++ = fg;
+				else
+					*p++ = bg;
+			}
+		}
+	}
+
+	LOGD(TAG, "atlas of %d glyphs %dx%d built", a->nglyphs, a->cw, a->ch);
+}
+
+void tm_atlas_free(tm_atlas_t *a)
+{
+	free(a->pix);
+	a->pix = NULL;
+}
+
+/*
+ * mark a rectangle of the frame buffer changed
+ */
+static void tm_touch(tm_screen_t *s, int x0, int y0, int x1, int y1)
+{
+	if (s->dx0 >= s->dx1) {
+		s->dx0 = x0;
+		s->dy0 = y0;
+		s->dx1 = x1;
+		s->dy1 = y1;
+		return;
+	}
+
+	if (x0 < s->dx0)
+		s->dx0 = x0;
+	if (y0 < s->dy0)
+		s->dy0 = y0;
+	if (x1 > s->dx1)
+		s->dx1 = x1;
+	if (y1 > s->dy1)
+		s->dy1 = y1;
+}
+
+/*
+ * forget what the cells show, they are all drawn again
+ */
+static void tm_invalidate(tm_screen_t *s)
+{
+	int i;
+
+	for (i = 0; i < s->ncells; i++)
+		s->cell[i] = -1;
+}
+
+/*
+ * create a frame buffer of w * h pixels filled with pix
+ * for up to ncells cells
+ */
+void tm_screen_init(tm_screen_t *s, int w, int h, int ncells, uint32_t pix)
+{
+	s->fb = tm_alloc((size_t) w * h * sizeof(uint32_t));
+	s->w = w;
+	s->h = h;
+	s->cell = tm_alloc(ncells * sizeof(int));
+	s->ncells = ncells;
+	s->atlas = NULL;
+	s->cols = s->rows = 0;
+	s->xoff = s->yoff = 0;
+	s->blank = false;
+	tm_clear(s, pix);
+}
+
+void tm_screen_free(tm_screen_t *s)
+{
+	free(s->fb);
+	s->fb = NULL;
+	free(s->cell);
+	s->cell = NULL;
+}
+
+/*
+ * show cols * rows cells with glyphs of atlas a, the first cell at
+ * pixel position xoff, yoff
+ */
+void tm_layout(tm_screen_t *s, const tm_atlas_t *a, int cols, int rows,
+	       int xoff, int yoff)
+{
+	if (s->atlas == a && s->cols == cols && s->rows == rows &&
+	    s->xoff == xoff && s->yoff == yoff)
+		return;
+
+	s->atlas = a;
+	s->cols = cols;
+	s->rows = rows;
+	s->xoff = xoff;
+	s->yoff = yoff;
+	tm_invalidate(s);
+}
+
+/*
+ * fill the frame buffer with pix, e.g. if the video is switched off
+ */
+void tm_clear(tm_screen_t *s, uint32_t pix)
+{
+	int i;
+
+	if (s->blank)
+		return;
+
+	for (i = 0; i < s->w * s->h; i++)
+		s->fb[i] = pix;
+	tm_invalidate(s);
+	s->blank = true;
+	s->dx0 = s->dx1 = 0;
+	tm_touch(s, 0, 0, s->w, s->h);
+}
+
+/*
+ * draw glyph into a cell
+ */
+void tm_blit(tm_screen_t *s, int col, int row, int glyph)
+{
+	const tm_atlas_t *a = s->atlas;
+	const uint32_t *q = a->pix + (size_t) glyph * a->cw * a->ch;
+	int x = s->xoff + col * a->cw, y = s->yoff + row * a->ch;
+	uint32_t *p = s->fb + y * s->w + x;
+	int i;
+
+	for (i = 0; i < a->ch; i++) {
+		memcpy(p, q, a->cw * sizeof(uint32_t));
+		p += s->w;
+		q += a->cw;
+	}
+
+	s->cell[row * s->cols + col] = glyph;
+	s->blank = false;
+	tm_touch(s, x, y, x + a->cw, y + a->ch);
+}
+
+/*
+ * get the rectangle of pixels changed since the last call,
+ * false if nothing changed
+ */
+bool tm_dirty(tm_screen_t *s, int *x, int *y, int *w, int *h)
+{
+	if (s->dx0 >= s->dx1)
+		return false;
+
+	*x = s->dx0;
+	*y = s->dy0;
+	*w = s->dx1 - s->dx0;
+	*h = s->dy1 - s->dy0;
+	s->dx0 = s->dx1 = 0;
+
+	return true;
+}
@@ -0,0 +1,70 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Common I/O devices used by various simulated machines
+ *
+ * This module implements the text screen of the video boards, which
+ * display characters from a ROM, see textmode.c for details.
+ *
+ * History:
+ * 18-OCT-2026 first version
+ */
+
+#ifndef TEXTMODE_INC
+#define TEXTMODE_INC
+
+#include <stdint.h>
+
+#include "sim.h"
+#include "simdefs.h"
+
+typedef struct tm_atlas {
+	int cw, ch;		/* cell size in pixels */
+	int nglyphs;		/* number of glyphs */
+	uint32_t *pix;		/* nglyphs * cw * ch pixels, NULL if not built */
+} tm_atlas_t;
+
+typedef struct tm_screen {
+	uint32_t *fb;		/* frame buffer, w * h pixels */
+	int w, h;		/* frame buffer size */
+	int xoff, yoff;		/* position of the first cell */
+	int cols, rows;		/* screen size in cells */
+	const tm_atlas_t *atlas; /* glyphs of the cells */
+	int *cell;		/* glyph shown in a cell, -1 if none */
+	int ncells;		/* max. number of cells */
+	bool blank;		/* frame buffer cleared, no glyphs shown */
+	int dx0, dy0, dx1, dy1;	/* changed rectangle, empty if dx0 >= dx1 */
+} tm_screen_t;
+
+/*
+ * SDL_PIXELFORMAT_RGBA8888 pixel of color c
+ */
+static inline uint32_t tm_rgba(const uint8_t c[3])
+{
+	return ((uint32_t) c[0] << 24) | ((uint32_t) c[1] << 16) |
+	       ((uint32_t) c[2] << 8) | 0xff;
+}
+
+extern void tm_atlas_build(tm_atlas_t *a, const char *font, int nchars,
+			   int gw, int gh, int xscale, int yscale, int slf,
+			   uint32_t fg, uint32_t bg, uint32_t gap);
+extern void tm_atlas_free(tm_atlas_t *a);
+extern void tm_screen_init(tm_screen_t *s, int w, int h, int ncells,
+			   uint32_t pix);
+extern void tm_screen_free(tm_screen_t *s);
+extern void tm_layout(tm_screen_t *s, const tm_atlas_t *a, int cols,
+		      int rows, int xoff, int yoff);
+extern void tm_clear(tm_screen_t *s, uint32_t pix);
+extern void tm_blit(tm_screen_t *s, int col, int row, int glyph);
+extern bool tm_dirty(tm_screen_t *s, int *x, int *y, int *w, int *h);
+
+/*
+ * show glyph in a cell, nothing to do if it's shown already
+ */
+static inline void tm_put(tm_screen_t *s, int col, int row, int glyph)
+{
+	if (s->cell[row * s->cols + col] != glyph)
+		tm_blit(s, col, row, glyph);
+}
+
+#endif /* !TEXTMODE_INC */
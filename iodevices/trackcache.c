@@ -0,0 +1,148 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Common I/O devices used by various simulated machines
+ *
+ * This module implements a read-ahead buffer for disk controllers.
+ * On the first read of a sector the whole track is read from the
+ * disk image, following reads of sectors on the same track are served
+ * from memory, so that a guest reading a skewed track doesn't cause
+ * a seek and read on the host for every sector. Tracks larger than
+ * TC_WINDOW, e.g. of large hard disk images, are read in aligned
+ * windows of TC_WINDOW bytes, so that a random access doesn't read
+ * megabytes for one sector.
+ *
+ * A trackcache_t initialized with zeros is empty.
+ *
+ * Writes to the disk image must be announced with trackcache_inval(),
+ * which drops the track if the write overlaps it. The track also is
+ * dropped when another image was mounted or the image was modified
+ * on the host. Controllers which stat the image anyway pass the stat
+ * with each read, otherwise the cache stats the image itself when it
+ * reads a track, and on hits at most every TC_RECHECK microseconds.
+ *
+ * History:
+ * 18-OCT-2026 first version
+ * 18-OCT-2026 read large tracks in windows of TC_WINDOW bytes
+ * 18-OCT-2026 stat the image only on a miss or every TC_RECHECK us
+ */
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+#include "simdefs.h"
+#include "simport.h"
+
+#include "trackcache.h"
+
+/* #define LOG_LOCAL_LEVEL LOG_DEBUG */
+#include "log.h"
+static const char *TAG = "trackcache";
+
+#define TC_WINDOW	32768	/* max. bytes read ahead */
+#define TC_RECHECK	1000000	/* us between stats of an image on hits */
+
+/*
+ * read len bytes at image offset pos into buf, using the cached
+ * track at trkpos with length trklen, s is the stat of the image
+ * or NULL if the cache should stat it when needed
+ */
+bool trackcache_read(trackcache_t *tc, int fd, const struct stat *s,
+		     off_t trkpos, size_t trklen,
+		     off_t pos, BYTE *buf, size_t len)
+{
+	struct stat st;
+	uint64_t t;
+	BYTE *p;
+
+	if (s == NULL && tc->len != 0 &&
+	    (t = get_clock_us()) - tc->checked >= TC_RECHECK) {
+		tc->checked = t;
+		if (fstat(fd, &st) == -1)
+			tc->len = 0;
+		else
+			s = &st;
+	}
+
+	if (s != NULL && tc->len != 0 &&
+	    (s->st_dev != tc->dev || s->st_ino != tc->ino ||
+	     s->st_size != tc->isize || s->st_mtime != tc->mtime))
+		tc->len = 0;	/* image was changed */
+
+	/* not in the cached track, read ahead the track of the sector */
+	if (pos < tc->pos || pos + (off_t) len > tc->pos + (off_t) tc->len) {
+		tc->len = 0;
+		if (pos < trkpos || pos + (off_t) len > trkpos + (off_t) trklen)
+			goto direct;	/* sector not inside the track */
+		if (trklen > TC_WINDOW) {
+			off_t w = trkpos + (pos - trkpos) / TC_WINDOW * TC_WINDOW;
+
+			trklen = trkpos + (off_t) trklen - w;
+			if (trklen > TC_WINDOW)
+				trklen = TC_WINDOW;
+			trkpos = w;
+			if (pos + (off_t) len > trkpos + (off_t) trklen)
+				goto direct;	/* sector crosses window */
+		}
+		if (s == NULL) {
+			if (fstat(fd, &st) == -1)
+				goto direct;
+			s = &st;
+			tc->checked = get_clock_us();
+		}
+		if (trklen > tc->size) {
+			if ((p = realloc(tc->buf, trklen)) == NULL) {
+				LOGW(TAG, "can't allocate track buffer");
+				goto direct;
+			}
+			tc->buf = p;
+			tc->size = trklen;
+		}
+		if (pread(fd, tc->buf, trklen, trkpos) != (ssize_t) trklen)
+			goto direct;	/* partial track at end of image */
+		LOGD(TAG, "read track at %lld", (long long) trkpos);
+		tc->pos = trkpos;
+		tc->len = trklen;
+		tc->dev = s->st_dev;
+		tc->ino = s->st_ino;
+		tc->isize = s->st_size;
+		tc->mtime = s->st_mtime;
+	}
+
+	memcpy(buf, tc->buf + (pos - tc->pos), len);
+	return true;
+
+direct:
+	return pread(fd, buf, len, pos) == (ssize_t) len;
+}
+
+/*
+ * drop the cached track if it overlaps len bytes written at pos
+ */
+void trackcache_inval(trackcache_t *tc, off_t pos, size_t len)
+{
+	if (tc->len != 0 && pos < tc->pos + (off_t) tc->len &&
+	    pos + (off_t) len > tc->pos)
+		tc->len = 0;
+}
+
+/*
+ * drop the cached track
+ */
+void trackcache_flush(trackcache_t *tc)
+{
+	tc->len = 0;
+}
+
+/*
+ * drop the cached track and release the buffer
+ */
+void trackcache_free(trackcache_t *tc)
+{
+	free(tc->buf);
+	tc->buf = NULL;
+	tc->size = 0;
+	tc->len = 0;
+}
@@ -0,0 +1,44 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Common I/O devices used by various simulated machines
+ *
+ * This module implements a read-ahead buffer for one track of a
+ * disk image, see trackcache.c for details.
+ *
+ * History:
+ * 18-OCT-2026 first version
+ * 18-OCT-2026 stat the image only on a miss or every TC_RECHECK us
+ */
+
+#ifndef TRACKCACHE_INC
+#define TRACKCACHE_INC
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "sim.h"
+#include "simdefs.h"
+
+typedef struct trackcache {
+	off_t pos;		/* image offset of cached track */
+	size_t len;		/* length of cached track, 0 if empty */
+	size_t size;		/* size of allocated buffer */
+	BYTE *buf;		/* track buffer */
+	dev_t dev;		/* identity of the cached disk image */
+	ino_t ino;
+	off_t isize;
+	time_t mtime;
+	uint64_t checked;	/* time of the last stat of the image */
+} trackcache_t;
+
+extern bool trackcache_read(trackcache_t *tc, int fd, const struct stat *s,
+			    off_t trkpos, size_t trklen,
+			    off_t pos, BYTE *buf, size_t len);
+extern void trackcache_inval(trackcache_t *tc, off_t pos, size_t len);
+extern void trackcache_flush(trackcache_t *tc);
+extern void trackcache_free(trackcache_t *tc);
+
+#endif /* !TRACKCACHE_INC */
@@ -13,18 +13,17 @@
  * 22-APR-2018 implemented TCP socket polling
  * 14-JUL-2018 use logging
  * 16-JUL-2020 fix bug/warning detected by gcc 9
+ * 18-OCT-2026 removed SIGIO accept and blocking telnet negotiation
  */
 
 #include <unistd.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
-#include <fcntl.h>
 #include <sys/file.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/socket.h>
-#include <sys/poll.h>
 #include <sys/un.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
@@ -83,9 +82,6 @@ void init_tcp_server_socket(net_connector_t *p)
 {
 	struct sockaddr_in sin;
 	int on = 1;
-#ifdef TCPASYNC
-	int n;
-#endif
 
 	/* if the TCP/IP port is not configured we're done here */
 	if (p->port == 0)
@@ -104,16 +100,6 @@ void init_tcp_server_socket(net_connector_t *p)
 		exit(EXIT_FAILURE);
 	}
 
-#ifdef TCPASYNC
-	/* configure socket for async I/O */
-	fcntl(p->ss, F_SETOWN, getpid());
-	n = fcntl(p->ss, F_GETFL, 0);
-	if (fcntl(p->ss, F_SETFL, n | O_ASYNC) == -1) {
-		LOGE(TAG, "can't fcntl O_ASYNC on server socket");
-		exit(EXIT_FAILURE);
-	}
-#endif
-
 	/* bind socket and listen on it */
 	memset((void *) &sin, 0, sizeof(sin));
 	sin.sin_family = AF_INET;
@@ -130,102 +116,3 @@ void init_tcp_server_socket(net_connector_t *p)
 
 	LOG(TAG, "telnet console listening on port %d\r\n", p->port);
 }
-
-#if NUMNSOC > 0
-/*
- * SIGIO interrupt handler for TCP/IP server sockets
- * if SIGIO not working (Cygwin e.g.) call from appropriate I/O thread
- */
-void sigio_tcp_server_socket(int sig)
-{
-	register int i;
-	struct pollfd p[NUMNSOC];
-	struct sockaddr_in fsin;
-	socklen_t alen;
-	int go_away;
-	int on = 1;
-
-	UNUSED(sig);
-
-	for (i = 0; i < NUMNSOC; i++) {
-		p[i].fd = ncons[i].ss;
-		p[i].events = POLLIN;
-		p[i].revents = 0;
-	}
-
-	poll(p, NUMNSOC, 0);
-
-	for (i = 0; i < NUMNSOC; i++) {
-		if ((ncons[i].ss != 0) && (p[i].revents)) {
-			alen = sizeof(fsin);
-
-			if (ncons[i].ssc != 0) {
-				go_away = accept(ncons[i].ss,
-						 (struct sockaddr *) &fsin,
-						 &alen);
-				close(go_away);
-				return;
-			}
-
-			if ((ncons[i].ssc = accept(ncons[i].ss,
-						   (struct sockaddr *) &fsin,
-						   &alen)) == -1) {
-				LOGW(TAG, "can't accept on server socket");
-				ncons[i].ssc = 0;
-			}
-
-			if (setsockopt(ncons[i].ssc, IPPROTO_TCP, TCP_NODELAY,
-				       (void *) &on, sizeof(on)) == -1) {
-				LOGW(TAG, "can't set sockopt TCP_NODELAY on server socket");
-			}
-
-			if (ncons[i].telnet) {
-				telnet_negotiation(ncons[i].ssc);
-			}
-		}
-	}
-}
-#endif
-
-/*
- *	telnet option negotiation on TCP/IP server sockets
- */
-void telnet_negotiation(int fd)
-{
-	static unsigned char will_echo[3] = {255, 251, 1};
-	static unsigned char char_mode[3] = {255, 251, 3};
-	struct pollfd p[1];
-	BYTE c[3];
-
-	/* send the telnet options we need */
-	if (write(fd, &char_mode, 3) != 3)
-		LOGE(TAG, "can't send char_mode telnet option");
-	if (write(fd, &will_echo, 3) != 3)
-		LOGE(TAG, "can't send will_echo telnet option");
-
-	/* and reject all others offered */
-	p[0].fd = fd;
-	p[0].events = POLLIN;
-	while (true) {
-		/* wait for input */
-		p[0].revents = 0;
-		poll(p, 1, TELNET_TIMEOUT);
-
-		/* done if no more input */
-		if (! p[0].revents)
-			break;
-
-		/* else read the option */
-		if (read(fd, &c, 3) != 3)
-			LOGE(TAG, "can't read telnet option");
-		LOGD(TAG, "telnet: %d %d %d", c[0], c[1], c[2]);
-		if (c[2] == 1 || c[2] == 3)
-			continue;	/* ignore answers to our requests */
-		if (c[1] == 251)	/* and reject other options */
-			c[1] = 254;
-		else if (c[1] == 253)
-			c[1] = 252;
-		if (write(fd, &c, 3) != 3)
-			LOGE(TAG, "can't write telnet option");
-	}
-}
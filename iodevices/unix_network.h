@@ -12,6 +12,7 @@
  * 22-MAR-2017 implemented UNIX domain sockets and tested with Altair SIO/2SIO
  * 22-APR-2018 implemented TCP socket polling
  * 14-JUL-2018 use logging
+ * 18-OCT-2026 removed sigio_tcp_server_socket() and telnet_negotiation()
  */
 
 #ifndef UNIX_NETWORK_INC
@@ -28,7 +29,6 @@ typedef struct unix_connector {
 /* structure for TCP/IP socket connections */
 typedef struct net_connector {
 	int ss;		/* server socket descriptor */
-	int ssc;	/* connected server socket descriptor */
 	int port;	/* TCP/IP port for server socket */
 	int telnet;	/* telnet protocol flag for TCP/IP server socket */
 } net_connector_t;
@@ -36,8 +36,5 @@ typedef struct net_connector {
 extern void init_unix_server_socket(unix_connector_t *p, const char *fn);
 
 extern void init_tcp_server_socket(net_connector_t *p);
-extern void sigio_tcp_server_socket(int sig);
-
-extern void telnet_negotiation(int fd);
 
 #endif /* !UNIX_NETWORK_INC */
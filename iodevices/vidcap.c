@@ -0,0 +1,357 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Common I/O devices used by various simulated machines
+ *
+ * This module implements the headless capture of the frames of video
+ * devices, e.g. for regression tests of graphics software without a
+ * display. The video devices don't open windows then, but register a
+ * capture with a function which draws a frame into memory. The CPU
+ * calls vidcap_frame() in emulated time, VIDCAP_FPS times per second
+ * at the clock set with -f, so the CPU can run as fast as possible and
+ * still gets the same frames for every run.
+ *
+ * The format is selected by the extension of the file name given:
+ *
+ *	name.y4m	one YUV4MPEG2 stream with 4:4:4 frames
+ *	name.png	a PNG file for every frame
+ *	other		a list with frame number, T-states and
+ *			a FNV-1a hash of the RGB pixels per frame
+ *
+ * The name of the device is appended to the name, e.g. capture.y4m
+ * for the VIO is written to capture-vio.y4m and capture.png to
+ * capture-vio-000001.png, capture-vio-000002.png, ...
+ *
+ * PNG files are written with uncompressed deflate blocks, so no
+ * compression library is needed.
+ *
+ * History:
+ * 18-OCT-2026 first version
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "sim.h"
+#include "simdefs.h"
+#include "simglb.h"
+
+#include "vidcap.h"
+
+/* #define LOG_LOCAL_LEVEL LOG_DEBUG */
+#include "log.h"
+static const char *TAG = "vidcap";
+
+enum { HASH, Y4M, PNG };
+
+Tstates_t vidcap_period;	/* T-states per frame */
+Tstates_t vidcap_next;		/* T-state count for the next frame */
+Tstates_t vidcap_last;		/* T-state count of the last frame */
+
+static int format;		/* HASH, Y4M or PNG */
+static char base[MAX_LFN - 64]; /* file name without extension */
+static char ext[16];		/* extension of the file name */
+static vidcap_t *caps;		/* list of captures */
+static uint32_t crc_table[256];	/* for the PNG chunk CRCs */
+
+/*
+ * get the output format from the file name fn and
+ * set the frame rate for the CPU clock
+ */
+void vidcap_init(const char *fn)
+{
+	const char *dot = strrchr(fn, '.');
+	int n;
+
+	if (dot == NULL || strchr(dot, '/') != NULL)
+		dot = fn + strlen(fn);
+	n = dot - fn;
+	if (n >= (int) sizeof(base))
+		n = sizeof(base) - 1;
+	memcpy(base, fn, n);
+	base[n] = '\0';
+	snprintf(ext, sizeof(ext), "%s", dot);
+
+	if (!strcmp(ext, ".y4m"))
+		format = Y4M;
+	else if (!strcmp(ext, ".png"))
+		format = PNG;
+	else
+		format = HASH;
+
+	vidcap_period = (Tstates_t) (f_value ? f_value : VIDCAP_MHZ) *
+			1000000 / VIDCAP_FPS;
+	vidcap_next = vidcap_period;
+}
+
+/*
+ * start the capture of a video device
+ */
+void vidcap_add(vidcap_t *vc)
+{
+	char fn[MAX_LFN];
+
+	if (vc->added)
+		return;
+
+	vc->frames = 0;
+	vc->fp = NULL;
+	if ((vc->rgb = malloc((size_t) vc->w * vc->h * 3)) == NULL) {
+		LOGE(TAG, "can't allocate frame for %s", vc->name);
+		return;
+	}
+
+	if (format != PNG) {
+		snprintf(fn, MAX_LFN, "%s-%s%s", base, vc->name, ext);
+		if ((vc->fp = fopen(fn, "w")) == NULL) {
+			LOGE(TAG, "can't create %s", fn);
+			free(vc->rgb);
+			return;
+		}
+		if (format == Y4M)
+			fprintf(vc->fp, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 "
+				"C444\n", vc->w, vc->h, VIDCAP_FPS);
+		LOGI(TAG, "capturing %s to %s", vc->name, fn);
+	} else
+		LOGI(TAG, "capturing %s to %s-%s-*.png", vc->name, base,
+		     vc->name);
+
+	vc->added = true;
+	vc->next = caps;
+	caps = vc;
+}
+
+/*
+ * write a frame as YUV 4:4:4 with BT.601 coefficients
+ */
+static bool put_y4m(vidcap_t *vc)
+{
+	size_t n = (size_t) vc->w * vc->h, i;
+	BYTE *p, *plane, *q;
+	int r, g, b;
+	bool ok;
+
+	if ((plane = malloc(n * 3)) == NULL)
+		return false;
+
+	for (i = 0, p = vc->rgb, q = plane; i < n; i++, p += 3, q++) {
+		r = p[0];
+		g = p[1];
+		b = p[2];
+		q[0] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+		q[n] = (-38 * r - 74 * g + 112 * b + 128 + (128 << 8)) >> 8;
+		q[2 * n] = (112 * r - 94 * g - 18 * b + 128 + (128 << 8)) >> 8;
+	}
+	ok = fputs("FRAME\n", vc->fp) != EOF &&
+	     fwrite(plane, 1, n * 3, vc->fp) == n * 3;
+	free(plane);
+
+	return ok;
+}
+
+/*
+ * update the CRC of a PNG chunk
+ */
+static uint32_t crc(uint32_t c, const BYTE *p, size_t len)
+{
+	while (len--)
+		c = crc_table[(c ^ *p++) & 0xff] ^ (c >> 8);
+
+	return c;
+}
+
+static void put_be32(BYTE *p, uint32_t v)
+{
+	p[0] = v >> 24;
+	p[1] = v >> 16;
+	p[2] = v >> 8;
+	p[3] = v;
+}
+
+/*
+ * write a PNG chunk with len bytes data, data is preceded by 8 free
+ * bytes for the length and type and followed by 4 free bytes for the CRC
+ */
+static bool put_chunk(FILE *fp, const char *type, BYTE *data, size_t len)
+{
+	BYTE *p = data - 8;
+
+	put_be32(p, len);
+	memcpy(p + 4, type, 4);
+	put_be32(data + len, crc(0xffffffff, p + 4, len + 4) ^ 0xffffffff);
+
+	return fwrite(p, 1, len + 12, fp) == len + 12;
+}
+
+/*
+ * write a frame as PNG file, RGB with 8 bits per color, the image data
+ * is one zlib stream of uncompressed deflate blocks
+ */
+static bool put_png(vidcap_t *vc)
+{
+	static const BYTE sig[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a,
+				     '\n' };
+	size_t line = (size_t) vc->w * 3 + 1, raw = line * vc->h;
+	size_t nblk = (raw + 65534) / 65535, len, i, n;
+	uint32_t s1 = 1, s2 = 0;
+	BYTE hdr[8 + 13 + 4], end[8 + 4], *buf, *p, *q;
+	char fn[MAX_LFN], tmp[MAX_LFN + 4];
+	FILE *fp;
+	bool ok;
+	int y;
+
+	if (crc_table[1] == 0) {
+		uint32_t c;
+		int k;
+
+		for (i = 0; i < 256; i++) {
+			for (c = i, k = 0; k < 8; k++)
+				c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+			crc_table[i] = c;
+		}
+	}
+
+	/* zlib header, blocks with 5 bytes header, Adler-32 */
+	len = 2 + raw + nblk * 5 + 4;
+	if ((buf = malloc(8 + len + 4)) == NULL)
+		return false;
+	p = buf + 8;
+	*p++ = 0x78;
+	*p++ = 0x01;
+	for (y = 0, n = 0; y < vc->h; y++) {
+		q = vc->rgb + (size_t) y * vc->w * 3;
+		for (i = 0; i < line; i++) {
+			if (n % 65535 == 0) {
+				size_t blen = raw - n < 65535 ? raw - n : 65535;
+
+				*p++ = (raw - n == blen) ? 1 : 0;
+				*p++ = blen;
+				*p++ = blen >> 8;
+				*p++ = ~blen;
+				*p++ = ~blen >> 8;
+			}
+			/* filter type 0 at the start of a line */
+			*p = i ? q[i - 1] : 0;
+			s1 = (s1 + *p++) % 65521;
+			s2 = (s2 + s1) % 65521;
+			n++;
+		}
+	}
+	put_be32(p, (s2 << 16) | s1);
+
+	/* written under a temporary name, no partial frames if killed */
+	snprintf(fn, MAX_LFN, "%s-%s-%06lu.png", base, vc->name,
+		 vc->frames + 1);
+	snprintf(tmp, sizeof(tmp), "%s.tmp", fn);
+	if ((fp = fopen(tmp, "wb")) == NULL) {
+		LOGE(TAG, "can't create %s", tmp);
+		free(buf);
+		return false;
+	}
+
+	put_be32(hdr + 8, vc->w);
+	put_be32(hdr + 12, vc->h);
+	hdr[16] = 8;		/* bits per color */
+	hdr[17] = 2;		/* RGB */
+	hdr[18] = hdr[19] = hdr[20] = 0;
+	ok = fwrite(sig, 1, 8, fp) == 8 &&
+	     put_chunk(fp, "IHDR", hdr + 8, 13) &&
+	     put_chunk(fp, "IDAT", buf + 8, len) &&
+	     put_chunk(fp, "IEND", end + 8, 0);
+	ok = (fclose(fp) == 0) && ok;
+	ok = ok && rename(tmp, fn) == 0;
+	free(buf);
+
+	return ok;
+}
+
+/*
+ * write the FNV-1a hash of a frame
+ */
+static bool put_hash(vidcap_t *vc)
+{
+	size_t n = (size_t) vc->w * vc->h * 3, i;
+	uint64_t h = 0xcbf29ce484222325ULL;
+
+	for (i = 0; i < n; i++) {
+		h ^= vc->rgb[i];
+		h *= 0x100000001b3ULL;
+	}
+
+	return fprintf(vc->fp, "%lu %" PRIu64 " %016" PRIx64 "\n",
+		       vc->frames + 1, T, h) > 0;
+}
+
+/*
+ * capture a frame of all video devices, called by the CPU
+ * when the T-state count reached vidcap_next
+ */
+void vidcap_frame(void)
+{
+	vidcap_t *vc;
+	const uint32_t *p;
+	BYTE *q;
+	size_t n, i;
+	bool ok;
+
+	for (vc = caps; vc != NULL; vc = vc->next) {
+		if (vc->rgb == NULL)
+			continue;
+
+		p = (*vc->render)();
+		n = (size_t) vc->w * vc->h;
+		for (i = 0, q = vc->rgb; i < n; i++, p++) {
+			*q++ = *p >> 16;
+			*q++ = *p >> 8;
+			*q++ = *p;
+		}
+
+		switch (format) {
+		case Y4M:
+			ok = put_y4m(vc);
+			break;
+		case PNG:
+			ok = put_png(vc);
+			break;
+		default:
+			ok = put_hash(vc);
+			break;
+		}
+		if (ok && vc->fp != NULL)
+			ok = fflush(vc->fp) == 0;
+		if (!ok) {
+			LOGE(TAG, "can't write frame of %s, capture stopped",
+			     vc->name);
+			if (vc->fp != NULL)
+				fclose(vc->fp);
+			vc->fp = NULL;
+			free(vc->rgb);
+			vc->rgb = NULL;
+			continue;
+		}
+		vc->frames++;
+	}
+
+	vidcap_last = T;
+	while (vidcap_next <= T)
+		vidcap_next += vidcap_period;
+}
+
+/*
+ * finish all captures
+ */
+void vidcap_close(void)
+{
+	vidcap_t *vc;
+
+	for (vc = caps; vc != NULL; vc = vc->next) {
+		if (vc->fp != NULL)
+			fclose(vc->fp);
+		vc->fp = NULL;
+		free(vc->rgb);
+		vc->rgb = NULL;
+		LOGI(TAG, "%lu frames of %s captured", vc->frames, vc->name);
+	}
+}
@@ -0,0 +1,63 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Common I/O devices used by various simulated machines
+ *
+ * This module implements the headless capture of the frames of video
+ * devices in emulated time, see vidcap.c for details.
+ *
+ * History:
+ * 18-OCT-2026 first version
+ */
+
+#ifndef VIDCAP_INC
+#define VIDCAP_INC
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "sim.h"
+#include "simdefs.h"
+
+#define VIDCAP_FPS	30	/* frames per second of emulated time */
+#define VIDCAP_MHZ	4	/* CPU clock used if the CPU runs unlimited */
+
+typedef struct vidcap {
+	const char *name;	/* device name, part of the file names */
+	int w, h;		/* frame size in pixels */
+	const uint32_t *(*render)(void); /* draw a frame, w * h XRGB8888 */
+
+	/* used by the capture */
+	FILE *fp;		/* Y4M stream or hash list, NULL if none */
+	unsigned long frames;	/* number of frames written */
+	BYTE *rgb;		/* frame converted to RGB bytes */
+	bool added;		/* capture running */
+	struct vidcap *next;	/* next capture */
+} vidcap_t;
+
+extern Tstates_t vidcap_period;	/* T-states per frame */
+extern Tstates_t vidcap_next;	/* T-state count for the next frame */
+extern Tstates_t vidcap_last;	/* T-state count of the last frame */
+
+/*
+ * pixel of the RGB color c
+ */
+static inline uint32_t vidcap_rgb(const uint8_t c[3])
+{
+	return ((uint32_t) c[0] << 16) | ((uint32_t) c[1] << 8) | c[2];
+}
+
+/*
+ * T-states of us microseconds emulated time
+ */
+static inline Tstates_t vidcap_tstates(int us)
+{
+	return vidcap_period * VIDCAP_FPS * us / 1000000;
+}
+
+extern void vidcap_init(const char *fn);
+extern void vidcap_add(vidcap_t *vc);
+extern void vidcap_frame(void);
+extern void vidcap_close(void);
+
+#endif /* !VIDCAP_INC */
@@ -0,0 +1,217 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Common I/O devices used by various simulated machines
+ *
+ * This module implements the delta encoded frames of video memory,
+ * which are sent to the web frontend. The encoder keeps a copy of the
+ * memory the client has and sends only the changed bytes, all changes
+ * of a frame in one binary websocket message. Nothing is sent for a
+ * frame without changes. A message starts with a header of 4 bytes:
+ *
+ *	byte 0		flags, WSF_KEY if the client clears its memory
+ *			before the updates are applied
+ *	byte 1		mode of the device, e.g. the Dazzler format
+ *	byte 2, 3	size of the video memory, little endian
+ *
+ * followed by updates until the end of the message:
+ *
+ *	skip		number of unchanged bytes before the update
+ *	count		number of bytes << 1, bit 0 set for a fill
+ *	data		count bytes, or one byte repeated count times
+ *
+ * Numbers are unsigned LEB128, 7 bits per byte with bit 7 set if
+ * more bytes follow. Changes separated by less than WSF_GAP unchanged
+ * bytes are sent as one update, runs of at least WSF_FILL equal bytes
+ * are compressed into fills.
+ *
+ * A client gets a key frame with the complete memory after it
+ * connected. Devices which display characters from a ROM send the
+ * glyphs before it, in a message with the header:
+ *
+ *	byte 0		WSF_FONT
+ *	byte 1		glyph width
+ *	byte 2, 3	number of glyphs, little endian
+ *	byte 4		glyph height
+ *	byte 5 - 10	RGB of the foreground and background color
+ *
+ * followed by the glyph lines, (width + 7) / 8 bytes per line with
+ * the leftmost pixel in bit 7 of the first byte.
+ *
+ * History:
+ * 18-OCT-2026 first version
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+#include "simdefs.h"
+
+#ifdef HAS_NETSERVER
+
+#include "wsframe.h"
+
+/* #define LOG_LOCAL_LEVEL LOG_DEBUG */
+#include "log.h"
+static const char *TAG = "wsframe";
+
+#define WSF_GAP		4	/* unchanged bytes merged into an update */
+#define WSF_FILL	4	/* min. equal bytes compressed into a fill */
+
+/*
+ * allocate the buffers of a frame encoder for device dev,
+ * with video memory of up to max bytes
+ */
+void wsframe_init(wsframe_t *f, net_device_t dev, int max)
+{
+	memset(f, 0, sizeof(wsframe_t));
+	f->dev = dev;
+	f->max = max;
+	f->shadow = malloc(max);
+	/* worst case an update with a fill for every WSF_FILL bytes */
+	f->buf = malloc(4 + 3 * max + 16);
+	if (f->shadow == NULL || f->buf == NULL) {
+		LOGE(TAG, "can't allocate frame buffers");
+		exit(EXIT_FAILURE);
+	}
+}
+
+static BYTE *put_num(BYTE *p, unsigned n)
+{
+	while (n > 0x7f) {
+		*p++ = (n & 0x7f) | 0x80;
+		n >>= 7;
+	}
+	*p++ = n;
+
+	return p;
+}
+
+static BYTE *put_lit(BYTE *p, unsigned skip, const BYTE *data, int n)
+{
+	p = put_num(p, skip);
+	p = put_num(p, n << 1);
+	memcpy(p, data, n);
+
+	return p + n;
+}
+
+static BYTE *put_fill(BYTE *p, unsigned skip, BYTE data, int n)
+{
+	p = put_num(p, skip);
+	p = put_num(p, (n << 1) | 1);
+	*p++ = data;
+
+	return p;
+}
+
+/*
+ * send the glyph set to the client
+ */
+static void send_font(wsframe_t *f)
+{
+	int bpl = (f->fw + 7) / 8, n = f->fn * f->fh;
+	const char *s = f->font;
+	BYTE *p, *q;
+	int i, x;
+
+	if ((q = calloc(11 + n * bpl, 1)) == NULL) {
+		LOGE(TAG, "can't allocate glyph set");
+		return;
+	}
+
+	q[0] = WSF_FONT;
+	q[1] = f->fw;
+	q[2] = f->fn & 0xff;
+	q[3] = f->fn >> 8;
+	q[4] = f->fh;
+	memcpy(q + 5, f->fg, 3);
+	memcpy(q + 8, f->bg, 3);
+	for (i = 0, p = q + 11; i < n; i++, p += bpl)
+		for (x = 0; x < f->fw; x++)
+			if (*s++ == 1)
+				p[x >> 3] |= 0x80 >> (x & 7);
+
+	net_device_send(f->dev, (char *) q, 11 + n * bpl);
+	free(q);
+}
+
+/*
+ * send the changes of the size bytes of video memory mem and of the
+ * mode to the client, if one is connected
+ */
+void wsframe_send(wsframe_t *f, int mode, const BYTE *mem, int size)
+{
+	unsigned client = net_device_ready(f->dev);
+	const BYTE *sh = f->shadow;
+	BYTE *p = f->buf + 4;
+	unsigned skip;
+	int i, j, k, end, lit, r;
+	bool key = false;
+
+	if (client == 0)
+		return;
+	if (size > f->max)
+		size = f->max;
+
+	/* a new client or another memory size gets a key frame */
+	if (client != f->client || size != f->size) {
+		if (client != f->client && f->font != NULL)
+			send_font(f);
+		f->client = client;
+		f->size = size;
+		f->mode = -1;
+		memset(f->shadow, 0, size);
+		key = true;
+	}
+
+	for (i = 0, skip = 0; i < size; ) {
+		if (mem[i] == sh[i]) {
+			i++;
+			skip++;
+			continue;
+		}
+
+		/* extend the update up to the next large enough gap */
+		for (end = i + 1, j = i + 1; j < size && j - end < WSF_GAP; j++)
+			if (mem[j] != sh[j])
+				end = j + 1;
+
+		/* split it into literal bytes and fills */
+		for (k = i, lit = i; k < end; k += r) {
+			for (r = 1; k + r < end && mem[k + r] == mem[k]; r++)
+				;
+			if (r >= WSF_FILL) {
+				if (k > lit) {
+					p = put_lit(p, skip, mem + lit, k - lit);
+					skip = 0;
+				}
+				p = put_fill(p, skip, mem[k], r);
+				skip = 0;
+				lit = k + r;
+			}
+		}
+		if (end > lit) {
+			p = put_lit(p, skip, mem + lit, end - lit);
+			skip = 0;
+		}
+
+		memcpy(f->shadow + i, mem + i, end - i);
+		i = end;
+	}
+
+	if (!key && mode == f->mode && p == f->buf + 4)
+		return;
+
+	f->mode = mode;
+	f->buf[0] = key ? WSF_KEY : 0;
+	f->buf[1] = mode;
+	f->buf[2] = size & 0xff;
+	f->buf[3] = size >> 8;
+	net_device_send(f->dev, (char *) f->buf, p - f->buf);
+	LOGD(TAG, "%s frame of %d bytes", key ? "key" : "delta",
+	     (int) (p - f->buf));
+}
+
+#endif /* HAS_NETSERVER */
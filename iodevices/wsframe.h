@@ -0,0 +1,46 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Common I/O devices used by various simulated machines
+ *
+ * This module implements the delta encoded frames of video memory,
+ * which are sent to the web frontend, see wsframe.c for details.
+ *
+ * History:
+ * 18-OCT-2026 first version
+ */
+
+#ifndef WSFRAME_INC
+#define WSFRAME_INC
+
+#include <stdint.h>
+
+#include "sim.h"
+#include "simdefs.h"
+
+#include "netsrv.h"
+
+#define WSF_KEY		1	/* flag: client clears its memory first */
+#define WSF_FONT	2	/* flag: message is a glyph set */
+
+typedef struct wsframe {
+	net_device_t dev;	/* websocket device */
+	int max;		/* max. size of the video memory */
+
+	/* optional glyph set, sent before every key frame */
+	const char *font;	/* n glyphs of w * h bytes, 1 for foreground */
+	int fw, fh, fn;		/* glyph size and number of glyphs */
+	const uint8_t *fg, *bg;	/* RGB colors of the glyphs */
+
+	/* used by the encoder */
+	unsigned client;	/* serial number of the client served */
+	int size;		/* size of the memory the client has */
+	int mode;		/* mode the client has */
+	BYTE *shadow;		/* memory the client has */
+	BYTE *buf;		/* message */
+} wsframe_t;
+
+extern void wsframe_init(wsframe_t *f, net_device_t dev, int max);
+extern void wsframe_send(wsframe_t *f, int mode, const BYTE *mem, int size);
+
+#endif /* !WSFRAME_INC */
@@ -12,11 +12,14 @@
  *	       computers by treating 0xe000-0xefff as ROM.
  * 04-NOV-2019 (Udo Munk) add functions for direct memory access
  * 14-DEC-2024 (Thomas Eberhardt) added hardware breakpoint support
+ * 18-OCT-2026 add block functions for direct memory access
  */
 
 #ifndef SIMMEM_INC
 #define SIMMEM_INC
 
+#include <string.h>
+
 #include "sim.h"
 #include "simdefs.h"
 #ifdef WANT_ICE
@@ -91,6 +94,41 @@ static inline BYTE dma_read(WORD addr)
 	return memory[addr];
 }
 
+/*
+ * block memory access for DMA devices, the transfer is split at page
+ * boundaries and each page is copied with memcpy()
+ */
+static inline void dma_write_block(WORD addr, const BYTE *buf, int len)
+{
+	register int n;
+
+	while (len > 0) {
+		n = 256 - (addr & 0xff);
+		if (n > len)
+			n = len;
+		if ((addr & 0xf000) != 0xe000)
+			memcpy(&memory[addr], buf, n);
+		addr += n;
+		buf += n;
+		len -= n;
+	}
+}
+
+static inline void dma_read_block(WORD addr, BYTE *buf, int len)
+{
+	register int n;
+
+	while (len > 0) {
+		n = 65536 - addr;
+		if (n > len)
+			n = len;
+		memcpy(buf, &memory[addr], n);
+		addr += n;
+		buf += n;
+		len -= n;
+	}
+}
+
 /*
  * direct memory access for simulation frame, video logic, etc.
  */
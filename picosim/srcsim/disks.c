@@ -11,6 +11,7 @@
  * 28-MAY-2024 implemented sector I/O to disk images
  * 03-JUN-2024 added directory list for code files and disk images
  * 29-JUN-2024 split of from memsim.c and picosim.c
+ * 18-OCT-2026 use DMA block memory access
  */
 
 #include <stdlib.h>
@@ -145,7 +146,6 @@ bool load_file(const char *name)
 {
 	int i = 0;
 	bool res;
-	register unsigned int j;
 	unsigned int br;
 	char SFN[25];
 
@@ -162,8 +162,7 @@ bool load_file(const char *name)
 
 	/* read file into memory */
 	while ((sd_res = f_read(&sd_file, dsk_buf, SEC_SZ, &br)) == FR_OK) {
-		for (j = 0; j < br; j++)
-			dma_write(i + j, dsk_buf[j]);
+		dma_write_block(i, dsk_buf, br);
 		if (br < SEC_SZ)	/* last record reached */
 			break;
 		i += SEC_SZ;
@@ -284,7 +283,6 @@ BYTE read_sec(int drive, int track, int sector, WORD addr)
 {
 	BYTE stat;
 	unsigned int br;
-	register int i;
 
 	/* prepare for sector read */
 	stat = prep_io(drive, track, sector, addr, false);
@@ -296,8 +294,7 @@ BYTE read_sec(int drive, int track, int sector, WORD addr)
 			if (br < SEC_SZ)	/* UH OH */
 				stat = FDC_STAT_READ;
 			else {
-				for (i = 0; i < SEC_SZ; i++)
-					dma_write(addr + i, dsk_buf[i]);
+				dma_write_block(addr, dsk_buf, SEC_SZ);
 				stat = FDC_STAT_OK;
 			}
 		} else
@@ -319,15 +316,13 @@ BYTE write_sec(int drive, int track, int sector, WORD addr)
 {
 	BYTE stat;
 	unsigned int br;
-	register int i;
 
 	/* prepare for sector write */
 	stat = prep_io(drive, track, sector, addr, true);
 	if (stat == FDC_STAT_OK) {
 
 		/* write sector to disk image */
-		for (i = 0; i < SEC_SZ; i++)
-			dsk_buf[i] = dma_read(addr + i);
+		dma_read_block(addr, dsk_buf, SEC_SZ);
 		sd_res = f_write(&sd_file, dsk_buf, SEC_SZ, &br);
 		if (sd_res == FR_OK) {
 			if (br < SEC_SZ)	/* UH OH */
@@ -351,8 +346,5 @@ BYTE write_sec(int drive, int track, int sector, WORD addr)
  */
 void get_fdccmd(BYTE *cmd, WORD addr)
 {
-	register int i;
-
-	for (i = 0; i < 4; i++)
-		cmd[i] = dma_read(addr + i);
+	dma_read_block(addr, cmd, 4);
 }
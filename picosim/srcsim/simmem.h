@@ -10,11 +10,14 @@
  * 23-APR-2024 derived from z80sim
  * 29-JUN-2024 implemented banked memory
  * 14-DEC-2024 added hardware breakpoint support
+ * 18-OCT-2026 add block functions for direct memory access
  */
 
 #ifndef SIMMEM_INC
 #define SIMMEM_INC
 
+#include <string.h>
+
 #include "sim.h"
 #include "simdefs.h"
 #ifdef WANT_ICE
@@ -106,6 +109,48 @@ static inline BYTE dma_read(WORD addr)
 		return bnk1[addr];
 }
 
+/*
+ * block memory access for DMA devices, the transfer is split at page
+ * boundaries and each page is copied with memcpy()
+ */
+static inline void dma_write_block(WORD addr, const BYTE *buf, int len)
+{
+	register int n;
+
+	while (len > 0) {
+		n = 256 - (addr & 0xff);
+		if (n > len)
+			n = len;
+		if ((selbnk == 0) || (addr >= 0xc000)) {
+			if (addr < 0xff00)
+				memcpy(&bnk0[addr], buf, n);
+		} else {
+			memcpy(&bnk1[addr], buf, n);
+		}
+		addr += n;
+		buf += n;
+		len -= n;
+	}
+}
+
+static inline void dma_read_block(WORD addr, BYTE *buf, int len)
+{
+	register int n;
+
+	while (len > 0) {
+		n = 256 - (addr & 0xff);
+		if (n > len)
+			n = len;
+		if ((selbnk == 0) || (addr >= 0xc000))
+			memcpy(buf, &bnk0[addr], n);
+		else
+			memcpy(buf, &bnk1[addr], n);
+		addr += n;
+		buf += n;
+		len -= n;
+	}
+}
+
 /*
  * direct memory access for simulation frame, video logic, etc.
  */
@@ -5,6 +5,13 @@
  *
  * History:
  * 12-JUL-2018	1.0	Initial Release
+ * 18-OCT-2026		add disk I/O statistics handler
+ * 18-OCT-2026		input rings instead of SysV message queues
+ * 18-OCT-2026		collect terminal and printer output into frames
+ * 18-OCT-2026		Dazzler frames and VDM-1 devices
+ * 18-OCT-2026		copy the disk statistics under their lock
+ * 18-OCT-2026		build for the Altair too
+ * 18-OCT-2026		the consumer resets the input ring for a new client
  */
 
 /**
@@ -17,9 +24,9 @@
 #include <time.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <inttypes.h>
 #include <dirent.h>
-#include <sys/ipc.h>
-#include <sys/msg.h>
+#include <pthread.h>
 #include <sys/stat.h>
 #include <sys/utsname.h>
 
@@ -44,7 +51,13 @@
 #endif
 #include "cromemco-tu-art.h"
 #endif
+#if defined(IMSAISIM) || defined(CROMEMCOSIM)
 #include "diskmanager.h"
+#endif
+#include "ringbuf.h"
+#ifdef HAS_DISKS
+#include "diskstats.h"
+#endif
 
 #ifdef HAS_NETSERVER
 
@@ -52,29 +65,54 @@
 static const char *TAG = "netsrv";
 
 #define MAX_WS_CLIENTS (_DEV_MAX)
-
-typedef struct msgbuf_s {
-	long mtype;
-	unsigned char mtext[128];
-} msgbuf_t;
-
-static msgbuf_t msg;
+#define WS_OUT_SIZE	1024	/* max. output bytes collected into a frame */
+#define WS_OUT_DELAY	10	/* ms output is collected before sending */
 
 typedef struct ws_client {
 	struct mg_connection *conn;
 	int state;
 } ws_client_t;
 
+/*
+ * Input received by the websocket handlers is put into a ring per
+ * device, which the device emulation reads without system calls.
+ * The civetweb thread of the connection is the only producer, the
+ * CPU or device thread the only consumer. Readers waiting for a
+ * block of data sleep on cond, which is signaled after every frame.
+ * Input left over from the previous client is dropped by the
+ * consumer, when it sees the serial number of a new client.
+ */
 static struct {
-	int queue;
+	bool alive;
+	unsigned ready;			/* serial number of the ready client */
+	unsigned seen;			/* ready serial the consumer has seen */
+	ringbuf_t rb;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
 	ws_client_t ws_client;
 	void (*cbfunc)(BYTE *);
+	size_t olen;			/* collected output bytes */
+	char obuf[WS_OUT_SIZE];		/* collected output */
 } dev[MAX_WS_CLIENTS];
 
+/*
+ * The byte stream output of the terminal and printer devices is
+ * collected per device and sent as one frame, when the buffer is
+ * full or by the output thread WS_OUT_DELAY ms after the first byte.
+ * out_mutex protects the output buffers of all devices.
+ */
+static pthread_mutex_t out_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t out_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t out_thread;
+static bool out_pending;		/* output thread has work */
+static bool out_running;		/* output thread started */
+static bool out_exit;			/* tell output thread to exit */
+
 static net_device_t net_device_a[_DEV_MAX] = {
 	DEV_TTY, DEV_TTY2, DEV_TTY3,
 	DEV_LPT, DEV_VIO, DEV_CPA,
-	DEV_DZLR, DEV_88ACC, DEV_D7AIO, DEV_PTR
+	DEV_DZLR, DEV_88ACC, DEV_D7AIO, DEV_PTR,
+	DEV_DZLRF, DEV_VDM
 };
 
 static const char *dev_name[] = {
@@ -87,9 +125,13 @@ static const char *dev_name[] = {
 	"DZLR",
 	"ACC",
 	"D7AIO",
-	"PTR"
+	"PTR",
+	"DZLRF",
+	"VDM"
 };
 
+static unsigned ready_serial;		/* serial number of the last client */
+
 static int last_error = 0; //TODO: replace
 
 /*
@@ -99,11 +141,45 @@ extern void quit_callback(void);
 */
 
 /**
- * Check if a queue is provisioned
+ * Check if a client is connected to the device
  */
 bool net_device_alive(net_device_t device)
 {
-	return dev[device].queue >= 0;
+	return __atomic_load_n(&dev[device].alive, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Serial number of the client connected to the device, which changes
+ * with every new client, 0 if no client is ready for data
+ */
+unsigned net_device_ready(net_device_t device)
+{
+	return __atomic_load_n(&dev[device].ready, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Put a received frame into the input ring of a device, the
+ * frame is dropped if it doesn't fit
+ */
+static int net_device_put(net_device_t device, const char *data, size_t len)
+{
+	size_t i;
+
+	if (!net_device_alive(device))
+		return 0;
+
+	if (rb_space(&dev[device].rb) < len) {
+		LOGW(TAG, "%s Overflow", dev_name[device]);
+		return 0;
+	}
+	for (i = 0; i < len; i++)
+		rb_put(&dev[device].rb, (BYTE) data[i]);
+
+	pthread_mutex_lock(&dev[device].mutex);
+	pthread_cond_broadcast(&dev[device].cond);
+	pthread_mutex_unlock(&dev[device].mutex);
+
+	return 1;
 }
 
 void net_device_service(net_device_t device, void (*cbfunc)(BYTE *data))
@@ -112,90 +188,181 @@ void net_device_service(net_device_t device, void (*cbfunc)(BYTE *data))
 }
 
 /**
- * Assumes the data is:
- *	TEXT	if only a single byte
- *	BINARY	if there are multiple bytes
- *	TTY & LPT are always BINARY now
+ * Send the collected output of a device as one frame,
+ * must be called with out_mutex locked
  */
-void net_device_send(net_device_t device, char *msg, int len)
+static void net_device_flush(net_device_t device)
+{
+	if (dev[device].olen == 0)
+		return;
+
+	if (net_device_alive(device))
+		mg_websocket_write(dev[device].ws_client.conn,
+				   MG_WEBSOCKET_OPCODE_BINARY,
+				   dev[device].obuf, dev[device].olen);
+	dev[device].olen = 0;
+}
+
+/**
+ * Output thread, sends the collected output WS_OUT_DELAY ms
+ * after it was started
+ */
+static void *net_output_thread(void *arg)
 {
-	int op_code;
+	int i;
+
+	UNUSED(arg);
+
+	pthread_mutex_lock(&out_mutex);
+	while (!out_exit) {
+		if (!out_pending) {
+			pthread_cond_wait(&out_cond, &out_mutex);
+			continue;
+		}
+
+		/* let the output pile up */
+		pthread_mutex_unlock(&out_mutex);
+		sleep_for_ms(WS_OUT_DELAY);
+		pthread_mutex_lock(&out_mutex);
+
+		out_pending = false;
+		for (i = 0; i < MAX_WS_CLIENTS; i++)
+			net_device_flush((net_device_t) i);
+	}
+	for (i = 0; i < MAX_WS_CLIENTS; i++)
+		net_device_flush((net_device_t) i);
+	pthread_mutex_unlock(&out_mutex);
 
+	return NULL;
+}
+
+/**
+ * Terminal and printer devices are byte streams
+ */
+static bool net_device_stream(net_device_t device)
+{
 	switch (device) {
 	case DEV_TTY:
 	case DEV_TTY2:
 	case DEV_TTY3:
 	case DEV_PTR:
 	case DEV_LPT:
-		op_code = MG_WEBSOCKET_OPCODE_BINARY;
-		break;
+		return true;
 	default:
-		op_code = (len == 1) ? MG_WEBSOCKET_OPCODE_TEXT : MG_WEBSOCKET_OPCODE_BINARY;
-		break;
+		return false;
 	}
+}
 
-	if (dev[device].queue >= 0)
-		mg_websocket_write(dev[device].ws_client.conn,
-				   op_code,
-				   msg, len);
+/**
+ * Assumes the data is:
+ *	TEXT	if only a single byte
+ *	BINARY	if there are multiple bytes
+ *	TTY & LPT are always BINARY now, their output is collected
+ *	into frames
+ */
+void net_device_send(net_device_t device, char *msg, int len)
+{
+	int i, op_code;
+
+	if (!net_device_alive(device))
+		return;
+
+	if (net_device_stream(device)) {
+		if (out_running) {
+			pthread_mutex_lock(&out_mutex);
+			for (i = 0; i < len; i++) {
+				if (dev[device].olen == WS_OUT_SIZE)
+					net_device_flush(device);
+				dev[device].obuf[dev[device].olen++] = msg[i];
+			}
+			if (!out_pending) {
+				out_pending = true;
+				pthread_cond_signal(&out_cond);
+			}
+			pthread_mutex_unlock(&out_mutex);
+			return;
+		}
+		op_code = MG_WEBSOCKET_OPCODE_BINARY;
+	} else
+		op_code = (len == 1) ? MG_WEBSOCKET_OPCODE_TEXT : MG_WEBSOCKET_OPCODE_BINARY;
+
+	mg_websocket_write(dev[device].ws_client.conn, op_code, msg, len);
+}
+
+/**
+ * Called by the consumer, empties the input ring when a new
+ * client is ready
+ */
+static void net_device_sync(net_device_t device)
+{
+	unsigned ready = net_device_ready(device);
+
+	if (ready != 0 && ready != dev[device].seen) {
+		rb_reset(&dev[device].rb);
+		dev[device].seen = ready;
+	}
 }
 
 /**
- * Always removes something from the queue is data waiting
+ * Always removes something from the ring if data is waiting
  * returns:
- *	char	if data is waiting in the queue
- *	-1	if the queue is not open, is empty
+ *	char	if data is waiting in the ring
+ *	-1	if the device is not connected or the ring is empty
  */
 int net_device_get(net_device_t device)
 {
-	ssize_t res;
-	msgbuf_t msg;
-
-	if (dev[device].queue >= 0) {
-		res = msgrcv(dev[device].queue, &msg, 2, 1L, IPC_NOWAIT);
-		LOGD(TAG, "GET: device[%d] res[%ld] msg[%ld, %s]",
-		     device, res, msg.mtype, msg.mtext);
-		if (res == 2)
-			return msg.mtext[0];
+	BYTE c;
+
+	net_device_sync(device);
+	if (net_device_alive(device) && rb_get(&dev[device].rb, &c)) {
+		LOGD(TAG, "GET: device[%d] char[%02x]", device, c);
+		return c;
 	}
 
 	return -1;
 }
 
+/**
+ * Wait until len bytes are received and copy them to dst
+ * returns:
+ *	len	if the data was received
+ *	<len	bytes received until the client disconnected
+ *	-1	if the device is not connected
+ */
 int net_device_get_data(net_device_t device, char *dst, int len)
 {
-	ssize_t res;
-	msgbuf_t msg;
-
-	if (dev[device].queue >= 0) {
-		res = msgrcv(dev[device].queue, &msg, len, 1L, MSG_NOERROR);
-		memcpy((void *)dst, (void *)msg.mtext, res);
-		return res;
+	int n = 0;
+	BYTE c;
+
+	if (!net_device_alive(device))
+		return -1;
+
+	net_device_sync(device);
+	pthread_mutex_lock(&dev[device].mutex);
+	while (n < len) {
+		if (rb_get(&dev[device].rb, &c))
+			dst[n++] = (char) c;
+		else if (net_device_alive(device))
+			pthread_cond_wait(&dev[device].cond,
+					  &dev[device].mutex);
+		else
+			break;
 	}
+	pthread_mutex_unlock(&dev[device].mutex);
 
-	return -1;
+	return n;
 }
 
 /**
- * Doesn't remove data from the queue
+ * Doesn't remove data from the ring
  * returns:
- *	1	if data is waiting in the queue
- *	0	if the queue is not open or is empty
+ *	1	if data is waiting in the ring
+ *	0	if the device is not connected or the ring is empty
  */
 int net_device_poll(net_device_t device)
 {
-	ssize_t res;
-	msgbuf_t msg;
-
-	if (dev[device].queue >= 0) {
-		res = msgrcv(dev[device].queue, &msg, 1, 1L, IPC_NOWAIT);
-		LOGV(TAG, "POLL: device[%d] res[%ld] errno[%d]", device, res, errno);
-		if (res == -1 && errno == E2BIG) {
-			LOGD(TAG, "CHARACTERS WAITING");
-			return 1;
-		}
-	}
-	return 0;
+	net_device_sync(device);
+	return net_device_alive(device) && !rb_empty(&dev[device].rb);
 }
 
 request_t *get_request(const HttpdConnection_t *conn)
@@ -400,6 +567,11 @@ static int SystemHandler(HttpdConnection_t *conn, void *unused)
 
 		httpdPrintf(conn, ", \"memextra\": [ ");
 
+#ifdef ALTAIRSIM
+		if (_boot_switch[M_value])
+			httpdPrintf(conn, "\"Power-on jump address %04XH\", ",
+				    _boot_switch[M_value]);
+#else
 		if (boot_switch[M_value])
 			httpdPrintf(conn, "\"Power-on jump address %04XH\", ",
 				    boot_switch[M_value]);
@@ -409,6 +581,7 @@ static int SystemHandler(HttpdConnection_t *conn, void *unused)
 		if (num_banks)
 			httpdPrintf(conn, "\"MMU has %d additional RAM banks of %d KB\",",
 				    num_banks, SEGSIZ >> 10);
+#endif
 
 		httpdPrintf(conn, " \"\" ]");
 #endif
@@ -456,6 +629,59 @@ static int SystemHandler(HttpdConnection_t *conn, void *unused)
 	return 1;
 }
 
+#ifdef HAS_DISKS
+static int DiskStatsHandler(HttpdConnection_t *conn, void *unused)
+{
+	request_t *req = get_request(conn);
+	diskstats_t dss[DS_MAXDRIVES], *ds;
+	int i, j, n;
+
+	UNUSED(unused);
+
+	switch (req->method) {
+	case HTTP_GET:
+		httpdStartResponse(conn, 200);
+		httpdHeader(conn, "Content-Type", "application/json");
+		httpdEndHeaders(conn);
+
+		/* a copy, the CPU thread goes on updating the statistics */
+		n = diskstats_copy(dss, DS_MAXDRIVES);
+		httpdPrintf(conn, "[ ");
+		for (j = 0, ds = dss; j < n; j++, ds++) {
+			httpdPrintf(conn, "{ ");
+			httpdPrintf(conn, "\"ctrl\": \"%s\", ", ds->ctrl);
+			httpdPrintf(conn, "\"drive\": \"%s\", ", ds->drive);
+			httpdPrintf(conn, "\"reads\": %" PRIu64 ", ", ds->reads);
+			httpdPrintf(conn, "\"writes\": %" PRIu64 ", ", ds->writes);
+			httpdPrintf(conn, "\"rbytes\": %" PRIu64 ", ", ds->rbytes);
+			httpdPrintf(conn, "\"wbytes\": %" PRIu64 ", ", ds->wbytes);
+			httpdPrintf(conn, "\"seeks\": %" PRIu64 ", ", ds->seeks);
+			httpdPrintf(conn, "\"errors\": %" PRIu64 ", ", ds->errors);
+			httpdPrintf(conn, "\"seq\": %" PRIu64 ", ", ds->seq);
+			httpdPrintf(conn, "\"rnd\": %" PRIu64 ", ", ds->rnd);
+			httpdPrintf(conn, "\"lat\": [ ");
+			for (i = 0; i < DS_BUCKETS; i++)
+				httpdPrintf(conn, "%s%" PRIu64, (i == 0) ? "" : ", ",
+					    ds->lat[i]);
+			httpdPrintf(conn, " ] }%s ", (j < n - 1) ? "," : "");
+		}
+		httpdPrintf(conn, "]");
+		break;
+	case HTTP_DELETE:
+		diskstats_clear();
+		httpdStartResponse(conn, 205);
+		httpdEndHeaders(conn);
+		break;
+	default:
+		httpdStartResponse(conn, 405);  //http error code 'Method Not Allowed'
+		httpdEndHeaders(conn);
+		break;
+	}
+
+	return 1;
+}
+#endif
+
 int DirectoryHandler(HttpdConnection_t *conn, void *path)
 {
 	request_t *req = get_request(conn);
@@ -577,7 +803,6 @@ static int WebSocketConnectHandler(const HttpdConnection_t *conn, void *device)
 {
 	struct mg_context *ctx = mg_get_context(conn);
 	int reject = 1;
-	int res;
 	net_device_t d = *(net_device_t *) device;
 
 	mg_lock_context(ctx);
@@ -596,11 +821,9 @@ static int WebSocketConnectHandler(const HttpdConnection_t *conn, void *device)
 		case DEV_DZLR:
 		case DEV_88ACC:
 		case DEV_D7AIO:
-			res = msgget(IPC_PRIVATE, 0644 | IPC_CREAT); //TODO: check flags
-			if (res < 0)
-				perror("msgget()");
-			else
-				dev[d].queue = res;
+		case DEV_DZLRF:
+		case DEV_VDM:
+			__atomic_store_n(&dev[d].alive, true, __ATOMIC_RELEASE);
 			break;
 		default:
 			break;
@@ -619,6 +842,7 @@ static void WebSocketReadyHandler(HttpdConnection_t *conn, void *device)
 	const char *text = "\r\nConnected to the OSX port of Z80PACK\r\n";
 	ws_client_t *client = (ws_client_t *) mg_get_user_connection_data(conn);
 	net_device_t d = *(net_device_t *) device;
+	unsigned serial;
 
 	if (d == DEV_TTY || d == DEV_TTY2 || d == DEV_TTY3)
 		mg_websocket_write(conn, MG_WEBSOCKET_OPCODE_TEXT, text, strlen(text));
@@ -634,6 +858,10 @@ static void WebSocketReadyHandler(HttpdConnection_t *conn, void *device)
 	LOGI(TAG, "WS CLIENT CONNECTED to %s", dev_name[d]);
 
 	client->state = 2;
+	serial = __atomic_add_fetch(&ready_serial, 1, __ATOMIC_RELAXED);
+	if (serial == 0)
+		serial = __atomic_add_fetch(&ready_serial, 1, __ATOMIC_RELAXED);
+	__atomic_store_n(&dev[d].ready, serial, __ATOMIC_RELEASE);
 }
 
 static int WebsocketDataHandler(HttpdConnection_t *conn,
@@ -686,39 +914,22 @@ static int WebsocketDataHandler(HttpdConnection_t *conn,
 				     (int) len);
 				return 0;
 			}
-			msg.mtype = 1L;
-			msg.mtext[0] = data[0];
-			msg.mtext[1] = '\0';
-			if (msgsnd(dev[d].queue, &msg, 2, IPC_NOWAIT)) {
-				if (errno == EAGAIN) {
-					LOGW(TAG, "%s Overflow", dev_name[d]);
-				} else
-					perror("msgsnd()");
-				return 0;
-			};
-			break;
+			return net_device_put(d, data, 1);
 		case DEV_88ACC:
 			// LOGI(TAG, "rec: %d, %d", (int)len, (BYTE)*data);
-			msg.mtype = 1L;
-			memcpy(msg.mtext, data, len);
-			if (msgsnd(dev[d].queue, &msg, len, IPC_NOWAIT)) {
-				if (errno == EAGAIN) {
-					LOGW(TAG, "%s Overflow", dev_name[d]);
-				} else
-					perror("msgsnd()");
-				return 0;
-			};
-			break;
+			return net_device_put(d, data, len);
 		default:
 			break;
 		};
 	}
 	if ((((unsigned char) bits) & 0x0F) == MG_WEBSOCKET_OPCODE_TEXT) {
 		switch (d) {
+#if defined(IMSAISIM) || defined(CROMEMCOSIM)
 		case DEV_LPT:
 			if (len == 1 && *data == 'R')
 				lpt_reset();
 			break;
+#endif
 		case DEV_TTY:
 		case DEV_TTY2:
 		case DEV_TTY3:
@@ -728,17 +939,7 @@ static int WebsocketDataHandler(HttpdConnection_t *conn,
 				     (int) len);
 				return 0;
 			}
-			msg.mtype = 1L;
-			msg.mtext[0] = data[0];
-			msg.mtext[1] = '\0';
-			if (msgsnd(dev[d].queue, &msg, 2, IPC_NOWAIT)) {
-				if (errno == EAGAIN) {
-					LOGW(TAG, "%s Overflow", dev_name[d]);
-				} else
-					perror("msgsnd()");
-				return 0;
-			};
-			break;
+			return net_device_put(d, data, 1);
 		default:
 			break;
 		};
@@ -753,19 +954,25 @@ static void WebSocketCloseHandler(const HttpdConnection_t *conn, void *device)
 	ws_client_t *client = (ws_client_t *) mg_get_user_connection_data(conn);
 	net_device_t d = *(net_device_t *) device;
 
+	/* drop the collected output, the connection is gone */
+	__atomic_store_n(&dev[d].ready, 0, __ATOMIC_RELEASE);
+	pthread_mutex_lock(&out_mutex);
+	dev[d].olen = 0;
 	mg_lock_context(ctx);
 	client->state = 0;
 	client->conn = NULL;
 	mg_unlock_context(ctx);
+	pthread_mutex_unlock(&out_mutex);
 
 	LOGI(TAG, "WS CLIENT CLOSED %s", dev_name[d]);
 
-	if (dev[d].queue >= 0 && msgctl(dev[d].queue, IPC_RMID, NULL) == -1)
-		perror("msgctl()");
+	/* wake up readers waiting for data */
+	pthread_mutex_lock(&dev[d].mutex);
+	__atomic_store_n(&dev[d].alive, false, __ATOMIC_RELEASE);
+	pthread_cond_broadcast(&dev[d].cond);
+	pthread_mutex_unlock(&dev[d].mutex);
 
-	LOGD(TAG, "Message queue closed (%d) [%08X]", d, dev[d].queue);
-
-	dev[d].queue = -1;
+	LOGD(TAG, "Input ring closed (%d)", d);
 }
 
 static struct mg_context *ctx = NULL;
@@ -773,6 +980,16 @@ static struct mg_context *ctx = NULL;
 void stop_net_services(void)
 {
 	if (ctx != NULL) {
+		/* send the collected output */
+		if (out_running) {
+			pthread_mutex_lock(&out_mutex);
+			out_exit = true;
+			pthread_cond_signal(&out_cond);
+			pthread_mutex_unlock(&out_mutex);
+			pthread_join(out_thread, NULL);
+			out_running = false;
+		}
+
 		InformWebsockets(ctx);
 
 		/* Stop the server */
@@ -822,8 +1039,11 @@ int start_net_services(int port)
 	const struct mg_option *opts;
 #endif
 
-	for (i = 0; i < MAX_WS_CLIENTS; i++)
-		dev[i].queue = -1;
+	for (i = 0; i < MAX_WS_CLIENTS; i++) {
+		dev[i].alive = false;
+		pthread_mutex_init(&dev[i].mutex, NULL);
+		pthread_cond_init(&dev[i].cond, NULL);
+	}
 
 	atexit(stop_net_services);
 
@@ -846,11 +1066,21 @@ int start_net_services(int port)
 		return EXIT_FAILURE;
 	}
 
+	if (pthread_create(&out_thread, NULL, net_output_thread, NULL) == 0)
+		out_running = true;
+	else
+		LOGW(TAG, "can't create output thread, output isn't collected");
+
 	//TODO: sort out all the paths for the handlers
 	mg_set_request_handler(ctx, "/system", 	SystemHandler, 	0);
 	mg_set_request_handler(ctx, "/conf", 	ConfigHandler,	(void *) "conf");
+#if defined(IMSAISIM) || defined(CROMEMCOSIM)
 	mg_set_request_handler(ctx, "/library", LibraryHandler, 0);
 	mg_set_request_handler(ctx, "/disks", 	DiskHandler, 	0);
+#endif
+#ifdef HAS_DISKS
+	mg_set_request_handler(ctx, "/diskstats", DiskStatsHandler, 0);
+#endif
 
 	mg_set_websocket_handler(ctx, "/tty",
 				 WebSocketConnectHandler,
@@ -922,6 +1152,20 @@ int start_net_services(int port)
 				 WebSocketCloseHandler,
 				 (void *) &net_device_a[DEV_D7AIO]);
 
+	mg_set_websocket_handler(ctx, "/dazzler-frames",
+				 WebSocketConnectHandler,
+				 WebSocketReadyHandler,
+				 WebsocketDataHandler,
+				 WebSocketCloseHandler,
+				 (void *) &net_device_a[DEV_DZLRF]);
+
+	mg_set_websocket_handler(ctx, "/vdm",
+				 WebSocketConnectHandler,
+				 WebSocketReadyHandler,
+				 WebsocketDataHandler,
+				 WebSocketCloseHandler,
+				 (void *) &net_device_a[DEV_VDM]);
+
 #ifdef DEBUG
 	/* List all listening ports */
 	memset(ports, 0, sizeof(ports));
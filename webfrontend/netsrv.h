@@ -5,6 +5,7 @@
  *
  * History:
  * 12-JUL-2018	1.0	Initial Release
+ * 18-OCT-2026		Dazzler frames and VDM-1 devices
  */
 
 #ifndef NETSRV_INC
@@ -29,10 +30,13 @@ typedef enum net_device {
 	DEV_88ACC,
 	DEV_D7AIO,
 	DEV_PTR,
+	DEV_DZLRF,
+	DEV_VDM,
 	_DEV_MAX
 } net_device_t;
 
 extern bool net_device_alive(net_device_t device);
+extern unsigned net_device_ready(net_device_t device);
 extern void net_device_service(net_device_t device, void (*cbfunc)(BYTE *data));
 extern void net_device_send(net_device_t device, char *msg, int len);
 extern int net_device_get(net_device_t device);
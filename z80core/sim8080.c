@@ -22,6 +22,10 @@
 #include "simctl.h"
 #endif
 
+#ifdef HAS_VIDCAP
+#include "vidcap.h"
+#endif
+
 #ifndef EXCLUDE_I8080
 
 #ifdef WANT_GUI
@@ -625,6 +629,16 @@ void cpu_8080(void)
 			if (cpu_time)
 				cpu_freq = T * 1000000ULL / cpu_time;
 			t1 = t2;
+#ifdef HAS_BATCH
+			if (b_tlimit && T >= b_tlimit) {
+				cpu_error = TSLIMIT;
+				cpu_state = ST_STOPPED;
+			}
+#endif
+#ifdef HAS_VIDCAP
+			if (V_flag && T >= vidcap_next)
+				vidcap_frame();
+#endif
 		}
 
 #ifdef WANT_ICE
@@ -215,6 +215,9 @@ void report_cpu_error(void)
 	case INTERROR:
 		LOGW(TAG, "Unsupported bus data during INT: 0x%02x", int_data);
 		break;
+	case TSLIMIT:
+		LOGE(TAG, "T-state limit reached at 0x%04x", PC);
+		break;
 	case POWEROFF:
 		LOG(TAG, "System powered off\r\n");
 		break;
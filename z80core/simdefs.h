@@ -83,6 +83,7 @@
 #define OPTRAP4		8	/* illegal 4 byte op-code trap */
 #define USERINT		9	/* user interrupt */
 #define INTERROR	10	/* unsupported bus data on interrupt */
+#define TSLIMIT		11	/* T-state limit reached */
 #define POWEROFF	255	/* CPU off, no error */
 
 typedef uint16_t WORD;		/* 16 bit unsigned */
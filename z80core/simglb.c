@@ -114,6 +114,13 @@ bool F_flag = true;		/* flag for -F option */
 #ifdef HAS_NETSERVER
 bool n_flag;			/* flag for -n option */
 #endif
+#ifdef HAS_BATCH
+bool b_flag;			/* flag for -b option */
+Tstates_t b_tlimit;		/* stop CPU at this T-state count, 0 = never */
+#endif
+#ifdef HAS_VIDCAP
+bool V_flag;			/* flag for -V option */
+#endif
 #ifdef INFOPANEL
 #ifdef FRONTPANEL
 bool p_flag = true;		/* flag for -p option */
@@ -126,6 +133,12 @@ bool p_flag = false;		/* flag for -p option */
  *	Variables for configuration and disk images
  */
 char xfn[MAX_LFN];		/* buffer for filename (option -x) */
+#ifdef HAS_BATCH
+char bfn[MAX_LFN];		/* batch script (option -b) */
+#endif
+#ifdef HAS_VIDCAP
+char vfn[MAX_LFN];		/* video capture (option -V) */
+#endif
 #ifdef HAS_DISKS
 char *diskdir = NULL;		/* path for disk images (option -d) */
 char diskd[MAX_LFN];		/* disk image directory in use */
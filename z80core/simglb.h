@@ -86,11 +86,24 @@ extern bool	F_flag;
 #ifdef HAS_NETSERVER
 extern bool	n_flag;
 #endif
+#ifdef HAS_BATCH
+extern bool	b_flag;
+extern Tstates_t b_tlimit;
+#endif
+#ifdef HAS_VIDCAP
+extern bool	V_flag;
+#endif
 #ifdef INFOPANEL
 extern bool	p_flag;
 #endif
 
 extern char	xfn[MAX_LFN];
+#ifdef HAS_BATCH
+extern char	bfn[MAX_LFN];
+#endif
+#ifdef HAS_VIDCAP
+extern char	vfn[MAX_LFN];
+#endif
 #ifdef HAS_DISKS
 extern char	*diskdir, diskd[MAX_LFN];
 #endif
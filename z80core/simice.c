@@ -31,6 +31,9 @@
 #include "simfun.h"
 #include "simint.h"
 #endif
+#ifdef HAS_DISKS
+#include "diskstats.h"
+#endif
 
 #ifdef WANT_ICE
 
@@ -95,6 +98,9 @@ static void do_switch(char *s);
 static void do_uflag(void);
 static void do_iflag(void);
 static void do_show(void);
+#ifdef HAS_DISKS
+static void do_disk(char *s);
+#endif
 static void do_help(void);
 
 #ifndef BAREMETAL
@@ -210,6 +216,11 @@ void ice_cmd_loop(int go_mode)
 		case 's':
 			do_show();
 			break;
+#ifdef HAS_DISKS
+		case 'k':
+			do_disk(cmd + 1);
+			break;
+#endif
 		case '?':
 			do_help();
 			break;
@@ -1279,6 +1290,22 @@ static void do_show(void)
 	printf("T-State counting %spossible\n", i ? "" : "not ");
 }
 
+#ifdef HAS_DISKS
+/*
+ *	Show or clear the disk I/O statistics
+ */
+static void do_disk(char *s)
+{
+	while (isspace((unsigned char) *s))
+		s++;
+	if (tolower((unsigned char) *s) == 'c') {
+		diskstats_clear();
+		puts("Disk I/O statistics cleared");
+	} else
+		diskstats_print();
+}
+#endif
+
 /*
  *	Output help text
  */
@@ -1308,6 +1335,10 @@ static void do_help(void)
 	puts("u                         toggle trap on undocumented op-codes");
 	puts("i                         toggle trap on undefined ports I/O");
 	puts("s                         show settings");
+#ifdef HAS_DISKS
+	puts("k                         show disk I/O statistics");
+	puts("kc                        clear disk I/O statistics");
+#endif
 #if !defined (EXCLUDE_I8080) && !defined(EXCLUDE_Z80)
 	puts("8                         toggle between Z80 & 8080 mode");
 	puts("8 [z|8]                   switch to Z80 or 8080 mode");
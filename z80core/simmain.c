@@ -40,6 +40,12 @@
 #ifdef INFOPANEL
 #include "simpanel.h"
 #endif
+#ifdef HAS_BATCH
+#include "batch.h"
+#endif
+#ifdef HAS_VIDCAP
+#include "vidcap.h"
+#endif
 
 static void save_core(void);
 static bool load_core(void);
@@ -140,6 +146,44 @@ int main(int argc, char *argv[])
 				s--;
 				break;
 
+#ifdef HAS_BATCH
+			case 'b':	/* get filename with batch script */
+				b_flag = true;
+				s++;
+				if (*s == '\0') {
+					if (argc <= 1)
+						goto usage;
+					argc--;
+					argv++;
+					s = argv[0];
+				}
+				p = bfn;
+				while (*s)
+					*p++ = *s++;
+				*p = '\0';
+				s--;
+				break;
+#endif
+
+#ifdef HAS_VIDCAP
+			case 'V':	/* get filename for video capture */
+				V_flag = true;
+				s++;
+				if (*s == '\0') {
+					if (argc <= 1)
+						goto usage;
+					argc--;
+					argv++;
+					s = argv[0];
+				}
+				p = vfn;
+				while (*s)
+					*p++ = *s++;
+				*p = '\0';
+				s--;
+				break;
+#endif
+
 #ifdef HAS_CONFIG
 			case 'r':	/* get path for boot ROM images */
 				s++;
@@ -294,6 +338,12 @@ usage:
 #endif
 #ifdef HAS_NETSERVER
 				fputs(" -n", stdout);
+#endif
+#ifdef HAS_BATCH
+				fputs(" -b filename", stdout);
+#endif
+#ifdef HAS_VIDCAP
+				fputs(" -V filename", stdout);
 #endif
 				fputs("\n\n", stdout);
 #ifndef EXCLUDE_Z80
@@ -348,12 +398,39 @@ usage:
 #endif
 #ifdef INFOPANEL
 				puts("\t-p = toggle introspection panel");
+#endif
+#ifdef HAS_BATCH
+				puts("\t-b = run batch job with console script "
+				     "filename");
+#endif
+#ifdef HAS_VIDCAP
+				puts("\t-V = capture video frames headless to "
+				     "filename");
+				puts("\t     .y4m = video stream, .png = images, "
+				     "else hashes");
 #endif
 				return EXIT_FAILURE;
 			}
 
 	putchar('\n');
 
+#ifdef HAS_BATCH
+	/* batch jobs run as fast as possible */
+	if (b_flag) {
+		f_value = 0;
+		tmax = 100000;
+	}
+#endif
+
+#ifdef HAS_VIDCAP
+	/* frames are captured in emulated time, as fast as possible */
+	if (V_flag) {
+		vidcap_init(vfn);
+		f_value = 0;
+		tmax = vidcap_period / 8;
+	}
+#endif
+
 #ifndef EXCLUDE_Z80
 	if (cpu == Z80) {
 puts("#######  #####    ###            #####    ###   #     #");
@@ -457,7 +534,15 @@ puts(" #####    ###     #####    ###            #####    ###   #     #");
 #endif
 	exit_io();		/* stop I/O devices */
 	int_off();		/* stop UNIX interrupts */
+#ifdef HAS_VIDCAP
+	if (V_flag)
+		vidcap_close();	/* finish video capture */
+#endif
 
+#ifdef HAS_BATCH
+	if (b_flag)
+		return batch_status();
+#endif
 	return EXIT_SUCCESS;
 }
 
@@ -8,13 +8,19 @@
 /*
  *	This module contains an introspection panel to view various
  *	status information of the simulator.
+ *
+ *	The panel keeps the pixels of the last frame and a model of
+ *	what is shown. Characters are only drawn if they changed, from
+ *	glyph atlases with one byte per pixel. The layout is only drawn
+ *	again if the panel or the CPU type changed. Only the rectangle of
+ *	changed pixels is copied to the window.
  */
 
 #include <string.h>
+#include <stdlib.h>
 #ifdef WANT_SDL
 #include <SDL.h>
 #else
-#include <stdlib.h>
 #include <X11/X.h>
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
@@ -94,8 +100,18 @@ typedef struct grid {
 	unsigned cheight;
 	unsigned cols;
 	unsigned rows;
+	uint32_t *cells;	/* character and color shown, all 1 if none */
 } grid_t;
 
+/*
+ *	Glyph atlas of a font with one byte per pixel,
+ *	1 for the foreground and 0 for the background.
+ */
+typedef struct atlas {
+	const font_t *font;
+	uint8_t *pix;
+} atlas_t;
+
 /*
  *	Button type
  */
@@ -177,6 +193,22 @@ static int panel;		/* current panel type */
 static WORD mbase;		/* memory panel base address */
 static bool sticky;		/* I/O ports panel sticky flag */
 
+/* model of what is shown */
+#define LED_NONE	0xff		/* no state shown for a port */
+#define INFO_COLS	64		/* max. columns of the info line */
+
+static bool redraw = true;	/* draw everything again */
+static int shown_panel = -1;	/* panel type shown */
+static int shown_cpu = -1;	/* CPU type of the registers shown */
+static uint32_t regs_cells[47 * 3];
+static uint32_t mem_cells[71 * 17];
+static uint32_t ports_cells[67 * 17];
+static uint32_t info_cells[INFO_COLS];
+static uint8_t shown_leds[256];	/* in and out flag of the ports shown */
+static uint8_t shown_buttons[3]; /* state of the buttons shown */
+static atlas_t atlases[4];	/* glyphs of the fonts used */
+static unsigned dx0, dy0, dx1, dy1; /* changed pixels, none if dx0 >= dx1 */
+
 /*
  * Create the SDL2 or X11 window for panel display
  */
@@ -212,6 +244,13 @@ static void open_display(void)
 		window = NULL;
 		return;
 	}
+	pixels = (uint32_t *) malloc(xsize * ysize * sizeof(uint32_t));
+	if (pixels == NULL) {
+		LOGE(TAG, "can't allocate pixel buffer");
+		exit(EXIT_FAILURE);
+	}
+	pitch = xsize;
+	redraw = true;
 #else /* !WANT_SDL */
 	Window rootwindow;
 	XSetWindowAttributes swa;
@@ -240,7 +279,7 @@ static void open_display(void)
 	swa.colormap = colormap;
 	swa.event_mask = KeyPressMask | KeyReleaseMask |
 			 ButtonPressMask | ButtonReleaseMask |
-			 PointerMotionMask;
+			 PointerMotionMask | ExposureMask;
 	window = XCreateWindow(display, rootwindow, 0, 0, xsize, ysize,
 			       1, vinfo.depth, InputOutput, visual,
 			       CWBorderPixel | CWColormap | CWEventMask, &swa);
@@ -263,6 +302,7 @@ static void open_display(void)
 	/* force little-endian pixels, Xlib will convert if necessary */
 	ximage->byte_order = LSBFirst;
 	pitch = ximage->bytes_per_line / 4;
+	redraw = true;
 
 	XMapWindow(display, window);
 	XUnlockDisplay(display);
@@ -275,6 +315,8 @@ static void open_display(void)
 static void close_display(void)
 {
 #ifdef WANT_SDL
+	free(pixels);
+	pixels = NULL;
 	if (texture != NULL) {
 		SDL_DestroyTexture(texture);
 		texture = NULL;
@@ -303,6 +345,29 @@ static void close_display(void)
 #endif
 }
 
+/*
+ *	Mark a rectangle of pixels changed.
+ */
+static inline void damage(const unsigned x, const unsigned y,
+			  const unsigned w, const unsigned h)
+{
+	if (dx0 >= dx1) {
+		dx0 = x;
+		dy0 = y;
+		dx1 = x + w;
+		dy1 = y + h;
+		return;
+	}
+	if (x < dx0)
+		dx0 = x;
+	if (y < dy0)
+		dy0 = y;
+	if (x + w > dx1)
+		dx1 = x + w;
+	if (y + h > dy1)
+		dy1 = y + h;
+}
+
 #ifdef WANT_SDL
 
 /*
@@ -433,6 +498,11 @@ static inline void process_events(void)
 	while (XPending(display)) {
 		XNextEvent(display, &event);
 		switch (event.type) {
+		case Expose:
+			/* copy all pixels to the window again */
+			damage(0, 0, xsize, ysize);
+			break;
+
 		case ButtonPress:
 			if (event.xbutton.button < 4)
 				check_buttons(event.xbutton.x, event.xbutton.y,
@@ -550,6 +620,7 @@ static inline void draw_clear(const uint32_t color)
 		memcpy(p, pixels, pitch * 4);
 		p += pitch;
 	}
+	damage(0, 0, xsize, ysize);
 }
 
 /*
@@ -570,6 +641,45 @@ static inline void draw_pixel(const unsigned x, const unsigned y,
 	}
 #endif
 	*(pixels + y * pitch + x) = color;
+	damage(x, y, 1, 1);
+}
+
+/*
+ *	Get the glyph atlas of a font, it's built when the font is used
+ *	the first time.
+ */
+static const uint8_t *get_glyphs(const font_t *font)
+{
+	atlas_t *a;
+	uint8_t *q;
+	unsigned c, i, j, off;
+
+	for (a = atlases; a->font != NULL; a++) {
+		if (a->font == font)
+			return a->pix;
+		if (a == &atlases[sizeof(atlases) / sizeof(atlas_t) - 1]) {
+			LOGE(TAG, "too many fonts for glyph atlases");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	a->pix = (uint8_t *) malloc(128 * font->height * font->width);
+	if (a->pix == NULL) {
+		LOGE(TAG, "can't allocate glyph atlas");
+		exit(EXIT_FAILURE);
+	}
+	q = a->pix;
+	for (c = 0; c < 128; c++) {
+		for (j = 0; j < font->height; j++) {
+			off = c * font->width;
+			for (i = 0; i < font->width; i++, off++)
+				*q++ = (font->bits[j * font->stride + (off >> 3)] &
+					(0x80 >> (off & 7))) != 0;
+		}
+	}
+	a->font = font;
+
+	return a->pix;
 }
 
 /*
@@ -579,10 +689,7 @@ static inline void draw_char(const unsigned x, const unsigned y, const char c,
 			     const font_t *font, const uint32_t fgc,
 			     const uint32_t bgc)
 {
-	const unsigned off = (c & 0x7f) * font->width;
-	const uint8_t *p0 = font->bits + (off >> 3), *p;
-	const uint8_t m0 = 0x80 >> (off & 7);
-	uint8_t m;
+	const uint8_t *p;
 	uint32_t *q0, *q;
 	unsigned i, j;
 
@@ -604,28 +711,27 @@ static inline void draw_char(const unsigned x, const unsigned y, const char c,
 		return;
 	}
 #endif
+	p = get_glyphs(font) + (c & 0x7f) * font->height * font->width;
 	q0 = pixels + y * pitch + x;
 	for (j = font->height; j > 0; j--) {
-		m = m0;
-		p = p0;
 		q = q0;
-		for (i = font->width; i > 0; i--) {
-			if (*p & m) {
-				if (fgc != C_TRANS)
-					*q = fgc;
-			} else {
-				if (bgc != C_TRANS)
-					*q = bgc;
-			}
-			if ((m >>= 1) == 0) {
-				m = 0x80;
-				p++;
+		if (fgc != C_TRANS && bgc != C_TRANS) {
+			for (i = font->width; i > 0; i--)
+				*q++ = *p++ ? fgc : bgc;
+		} else {
+			for (i = font->width; i > 0; i--, p++, q++) {
+				if (*p) {
+					if (fgc != C_TRANS)
+						*q = fgc;
+				} else {
+					if (bgc != C_TRANS)
+						*q = bgc;
+				}
 			}
-			q++;
 		}
-		p0 += font->stride;
 		q0 += pitch;
 	}
+	damage(x, y, font->width, font->height);
 }
 
 /*
@@ -648,6 +754,7 @@ static inline void draw_hline(const unsigned x, const unsigned y, unsigned w,
 		return;
 	}
 #endif
+	damage(x, y, w, 1);
 	p = pixels + y * pitch + x;
 	while (w--)
 		*p++ = col;
@@ -673,6 +780,7 @@ static inline void draw_vline(const unsigned x, const unsigned y, unsigned h,
 		return;
 	}
 #endif
+	damage(x, y, 1, h);
 	p = pixels + y * pitch + x;
 	while (h--) {
 		*p = col;
@@ -737,10 +845,14 @@ static inline void draw_setup_grid(grid_t *grid, const unsigned xoff,
 		grid->rows = (ysize - yoff + spc) / grid->cheight;
 	else
 		grid->rows = rows;
+	grid->cells = NULL;
 }
 
 /*
  *	Draw a character using grid coordinates in the specified color.
+ *	If the grid has cells, the character is only drawn if it or its
+ *	foreground color changed, the background color of a grid must
+ *	not change.
  */
 static inline void draw_grid_char(const unsigned x, const unsigned y,
 				  const char c, const grid_t *grid,
@@ -756,6 +868,15 @@ static inline void draw_grid_char(const unsigned x, const unsigned y,
 		return;
 	}
 #endif
+	uint32_t *cell, key;
+
+	if (grid->cells != NULL) {
+		cell = &grid->cells[y * grid->cols + x];
+		key = ((uint32_t) (c & 0x7f) << 24) | (fgc & 0x00ffffff);
+		if (*cell == key)
+			return;
+		*cell = key;
+	}
 	draw_char(x * grid->cwidth + grid->xoff,
 		  y * grid->cheight + grid->yoff,
 		  c, grid->font, fgc, bgc);
@@ -946,7 +1067,7 @@ static const int num_regs_8080 = sizeof(regs_8080) / sizeof(reg_t);
 
 #endif /* !EXCLUDE_I8080 */
 
-static void draw_cpu_regs(void)
+static void draw_cpu_regs(int cpu_type)
 {
 	char c;
 	int i, j, n = 0;
@@ -955,9 +1076,8 @@ static void draw_cpu_regs(void)
 	const char *s;
 	const reg_t *rp = NULL;
 	grid_t grid = { };
-	int cpu_type = cpu;
 
-	/* use cpu_type in the rest of this function, since cpu can change */
+	/* use cpu_type in this function, since cpu can change */
 
 #ifndef EXCLUDE_Z80
 	if (cpu_type == Z80) {
@@ -977,31 +1097,37 @@ static void draw_cpu_regs(void)
 	if (cpu_type == Z80) {
 		draw_setup_grid(&grid, RXOFF, RYOFF, 47, 3, &font18, RSPC);
 
-		/* draw vertical grid lines */
-		draw_grid_vline(7, 0, 2, &grid, C_DKYELLOW);
-		draw_grid_vline(15, 0, 3, &grid, C_DKYELLOW);
-		draw_grid_vline(23, 0, 3, &grid, C_DKYELLOW);
-		draw_grid_vline(31, 0, 3, &grid, C_DKYELLOW);
-		draw_grid_vline(39, 0, 2, &grid, C_DKYELLOW);
-		/* draw horizontal grid lines */
-		draw_grid_hline(0, 1, grid.cols, &grid, C_DKYELLOW);
-		draw_grid_hline(0, 2, grid.cols, &grid, C_DKYELLOW);
+		if (redraw) {
+			/* draw vertical grid lines */
+			draw_grid_vline(7, 0, 2, &grid, C_DKYELLOW);
+			draw_grid_vline(15, 0, 3, &grid, C_DKYELLOW);
+			draw_grid_vline(23, 0, 3, &grid, C_DKYELLOW);
+			draw_grid_vline(31, 0, 3, &grid, C_DKYELLOW);
+			draw_grid_vline(39, 0, 2, &grid, C_DKYELLOW);
+			/* draw horizontal grid lines */
+			draw_grid_hline(0, 1, grid.cols, &grid, C_DKYELLOW);
+			draw_grid_hline(0, 2, grid.cols, &grid, C_DKYELLOW);
+		}
 	}
 #endif
 #ifndef EXCLUDE_I8080
 	if (cpu_type == I8080) {
 		draw_setup_grid(&grid, RXOFF, RYOFF, 47, 2, &font18, RSPC);
 
-		/* draw vertical grid lines */
-		draw_grid_vline(7, 0, 1, &grid, C_DKYELLOW);
-		draw_grid_vline(15, 0, 2, &grid, C_DKYELLOW);
-		draw_grid_vline(23, 0, 1, &grid, C_DKYELLOW);
-		draw_grid_vline(31, 0, 1, &grid, C_DKYELLOW);
-		draw_grid_vline(39, 0, 1, &grid, C_DKYELLOW);
-		/* draw horizontal grid line */
-		draw_grid_hline(0, 1, grid.cols, &grid, C_DKYELLOW);
+		if (redraw) {
+			/* draw vertical grid lines */
+			draw_grid_vline(7, 0, 1, &grid, C_DKYELLOW);
+			draw_grid_vline(15, 0, 2, &grid, C_DKYELLOW);
+			draw_grid_vline(23, 0, 1, &grid, C_DKYELLOW);
+			draw_grid_vline(31, 0, 1, &grid, C_DKYELLOW);
+			draw_grid_vline(39, 0, 1, &grid, C_DKYELLOW);
+			/* draw horizontal grid line */
+			draw_grid_hline(0, 1, grid.cols, &grid, C_DKYELLOW);
+		}
 	}
 #endif
+	grid.cells = regs_cells;
+
 	/* draw register labels & contents */
 	for (i = 0; i < n; rp++, i++) {
 		if ((s = rp->l) != NULL) {
@@ -1076,10 +1202,17 @@ static void draw_memory_panel(void)
 	grid_t grid;
 
 	draw_setup_grid(&grid, MXOFF, MYOFF, 71, 17, &font16, MSPC);
-
-	/* draw vertical grid lines */
-	for (i = 0; i < 17; i++)
-		draw_grid_vline(5 + i * 3, 0, grid.rows, &grid, C_DKYELLOW);
+	grid.cells = mem_cells;
+
+	if (redraw) {
+		/* draw grid lines */
+		for (i = 0; i < 17; i++)
+			draw_grid_vline(5 + i * 3, 0, grid.rows, &grid,
+					C_DKYELLOW);
+		for (j = 0; j < 16; j++)
+			draw_grid_hline(0, j + 1, grid.cols, &grid,
+					C_DKYELLOW);
+	}
 
 	a = mbase;
 	for (i = 0; i < 16; i++) {
@@ -1088,7 +1221,6 @@ static void draw_memory_panel(void)
 		draw_grid_char(7 + i * 3, 0, c, &grid, C_GREEN, C_DKBLUE);
 	}
 	for (j = 0; j < 16; j++) {
-		draw_grid_hline(0, j + 1, grid.cols, &grid, C_DKYELLOW);
 		c = (a >> 12) & 0xf;
 		c += (c < 10 ? '0' : 'A' - 10);
 		draw_grid_char(0, j + 1, c, &grid, C_GREEN, C_DKBLUE);
@@ -1140,31 +1272,44 @@ static void draw_memory_panel(void)
 static void draw_ports_panel(void)
 {
 	port_flags_t *p = port_flags;
+	uint8_t *led = shown_leds;
 	char c;
 	int i, j;
 	unsigned x, y;
+	uint8_t state;
 	grid_t grid;
 
 	draw_setup_grid(&grid, IOXOFF, IOYOFF, 67, 17, &font16, IOSPC);
-
-	/* draw vertical grid lines */
-	for (i = 0; i < 16; i++)
-		draw_grid_vline(3 + i * 4, 0, grid.rows, &grid, C_DKYELLOW);
+	grid.cells = ports_cells;
+
+	if (redraw) {
+		/* draw grid lines */
+		for (i = 0; i < 16; i++)
+			draw_grid_vline(3 + i * 4, 0, grid.rows, &grid,
+					C_DKYELLOW);
+		for (j = 0; j < 16; j++)
+			draw_grid_hline(0, j + 1, grid.cols, &grid,
+					C_DKYELLOW);
+	}
 
 	for (i = 0; i < 16; i++) {
 		c = i + (i < 10 ? '0' : 'A' - 10);
 		draw_grid_char(5 + i * 4, 0, c, &grid, C_GREEN, C_DKBLUE);
 	}
 	for (j = 0; j < 16; j++) {
-		draw_grid_hline(0, j + 1, grid.cols, &grid, C_DKYELLOW);
 		c = j + (j < 10 ? '0' : 'A' - 10);
 		draw_grid_char(0, j + 1, c, &grid, C_GREEN, C_DKBLUE);
 		draw_grid_char(1, j + 1, '0', &grid, C_GREEN, C_DKBLUE);
 		for (i = 0; i < 16; i++) {
-			x = (4 + i * 4) * grid.cwidth + grid.xoff + 1;
-			y = (j + 1) * grid.cheight + grid.yoff + 3;
-			draw_led(x, y, p->in ? C_GREEN : C_DKBLUE);
-			draw_led(x + 13, y, p->out ? C_RED : C_DKBLUE);
+			state = p->in | (p->out << 1);
+			if (*led != state) {
+				x = (4 + i * 4) * grid.cwidth + grid.xoff + 1;
+				y = (j + 1) * grid.cheight + grid.yoff + 3;
+				draw_led(x, y, p->in ? C_GREEN : C_DKBLUE);
+				draw_led(x + 13, y, p->out ? C_RED : C_DKBLUE);
+				*led = state;
+			}
+			led++;
 			p++;
 		}
 	}
@@ -1187,22 +1332,26 @@ static void draw_info(bool tick)
 	const char *s;
 	const font_t *font = &font18;
 	const unsigned w = font->width;
-	const unsigned n = xsize / w;
+	const unsigned n = xsize / w < INFO_COLS ? xsize / w : INFO_COLS;
 	const unsigned x = (xsize - n * w) / 2;
 	const unsigned y = ysize - font->height;
 	static unsigned count, fps;
 	static uint64_t freq;
+	grid_t grid;
+
+	draw_setup_grid(&grid, x, y, n, 1, font, 0);
+	grid.cells = info_cells;
 
 	/* draw product info */
 	s = "Z80pack " RELEASE;
 	for (i = 0; *s; i++)
-		draw_char(i * w + x, y, *s++, font, C_ORANGE, C_DKBLUE);
+		draw_grid_char(i, 0, *s++, &grid, C_ORANGE, C_DKBLUE);
 
 	/* draw frequency label */
-	draw_char((n - 7) * w + x, y, '.', font, C_ORANGE, C_DKBLUE);
-	draw_char((n - 3) * w + x, y, 'M', font, C_ORANGE, C_DKBLUE);
-	draw_char((n - 2) * w + x, y, 'H', font, C_ORANGE, C_DKBLUE);
-	draw_char((n - 1) * w + x, y, 'z', font, C_ORANGE, C_DKBLUE);
+	draw_grid_char(n - 7, 0, '.', &grid, C_ORANGE, C_DKBLUE);
+	draw_grid_char(n - 3, 0, 'M', &grid, C_ORANGE, C_DKBLUE);
+	draw_grid_char(n - 2, 0, 'H', &grid, C_ORANGE, C_DKBLUE);
+	draw_grid_char(n - 1, 0, 'z', &grid, C_ORANGE, C_DKBLUE);
 
 	/* update fps every second */
 	count++;
@@ -1210,15 +1359,14 @@ static void draw_info(bool tick)
 		fps = count;
 		count = 0;
 	}
-	draw_char(30 * w + x, y, fps > 99 ? fps / 100 + '0' : ' ',
-		  font, C_ORANGE, C_DKBLUE);
-	draw_char(31 * w + x, y, fps > 9 ? (fps / 10) % 10 + '0' : ' ',
-		  font, C_ORANGE, C_DKBLUE);
-	draw_char(32 * w + x, y, fps % 10 + '0',
-		  font, C_ORANGE, C_DKBLUE);
-	draw_char(34 * w + x, y, 'f', font, C_ORANGE, C_DKBLUE);
-	draw_char(35 * w + x, y, 'p', font, C_ORANGE, C_DKBLUE);
-	draw_char(36 * w + x, y, 's', font, C_ORANGE, C_DKBLUE);
+	draw_grid_char(30, 0, fps > 99 ? fps / 100 + '0' : ' ',
+		       &grid, C_ORANGE, C_DKBLUE);
+	draw_grid_char(31, 0, fps > 9 ? (fps / 10) % 10 + '0' : ' ',
+		       &grid, C_ORANGE, C_DKBLUE);
+	draw_grid_char(32, 0, fps % 10 + '0', &grid, C_ORANGE, C_DKBLUE);
+	draw_grid_char(34, 0, 'f', &grid, C_ORANGE, C_DKBLUE);
+	draw_grid_char(35, 0, 'p', &grid, C_ORANGE, C_DKBLUE);
+	draw_grid_char(36, 0, 's', &grid, C_ORANGE, C_DKBLUE);
 
 	/* update frequency every second */
 	if (tick && cpu_time)
@@ -1236,8 +1384,7 @@ static void draw_info(bool tick)
 			c = ' ';
 		else
 			onlyz = false;
-		draw_char((n - 11 + i) * w + x, y, c,
-			  font, C_ORANGE, C_DKBLUE);
+		draw_grid_char(n - 11 + i, 0, c, &grid, C_ORANGE, C_DKBLUE);
 		if (i < 6)
 			digit /= 10;
 		if (i == 3)
@@ -1254,10 +1401,19 @@ static void draw_buttons(void)
 	unsigned x, y;
 	button_t *p = buttons;
 	uint32_t color;
+	uint8_t state;
 	const char *s;
 
-	for (i = 0; i < nbuttons; i++) {
-		if (p->enabled) {
+	for (i = 0; i < nbuttons; i++, p++) {
+		state = p->enabled | (p->hilighted << 1) | (p->active << 2) |
+			(p->pressed << 3);
+		if (shown_buttons[i] == state)
+			continue;
+		shown_buttons[i] = state;
+		if (!p->enabled) {
+			for (y = p->y; y < p->y + p->height; y++)
+				draw_hline(p->x, y, p->width, C_DKBLUE);
+		} else {
 			color = p->hilighted ? C_ORANGE : C_WHITE;
 			draw_hline(p->x + 2, p->y, p->width - 4, color);
 			draw_pixel(p->x + 1, p->y + 1, color);
@@ -1290,7 +1446,6 @@ static void draw_buttons(void)
 				x += p->font->width;
 			}
 		}
-		p++;
 	}
 }
 
@@ -1379,16 +1534,34 @@ static void check_buttons(unsigned x, unsigned y, int event)
  */
 static void refresh(bool tick)
 {
-	draw_clear(C_DKBLUE);
+	int cpu_type = cpu;
 
 	update_buttons();
+
+	/* start over if the layout changed */
+	if (panel != shown_panel || cpu_type != shown_cpu)
+		redraw = true;
+	if (redraw) {
+		draw_clear(C_DKBLUE);
+		memset(regs_cells, 0xff, sizeof(regs_cells));
+		memset(mem_cells, 0xff, sizeof(mem_cells));
+		memset(ports_cells, 0xff, sizeof(ports_cells));
+		memset(info_cells, 0xff, sizeof(info_cells));
+		memset(shown_leds, LED_NONE, sizeof(shown_leds));
+		memset(shown_buttons, 0xff, sizeof(shown_buttons));
+		shown_panel = panel;
+		shown_cpu = cpu_type;
+	}
+
 	draw_buttons();
-	draw_cpu_regs();
+	draw_cpu_regs(cpu_type);
 	if (panel == MEMORY_PANEL)
 		draw_memory_panel();
 	else if (panel == PORTS_PANEL)
 		draw_ports_panel();
 	draw_info(tick);
+
+	redraw = false;
 }
 
 #ifdef WANT_SDL
@@ -1396,10 +1569,19 @@ static void refresh(bool tick)
 /* function for updating the display */
 static void update_display(bool tick)
 {
-	SDL_LockTexture(texture, NULL, (void **) &pixels, &pitch);
-	pitch /= 4;
+	SDL_Rect r;
+
 	refresh(tick);
-	SDL_UnlockTexture(texture);
+	if (dx0 < dx1) {
+		/* copy only the changed pixels to the texture */
+		r.x = dx0;
+		r.y = dy0;
+		r.w = dx1 - dx0;
+		r.h = dy1 - dy0;
+		SDL_UpdateTexture(texture, &r, pixels + dy0 * pitch + dx0,
+				  pitch * 4);
+		dx0 = dx1 = 0;
+	}
 	SDL_RenderCopy(renderer, texture, NULL, NULL);
 	SDL_RenderPresent(renderer);
 }
@@ -1445,9 +1627,13 @@ static void *update_display(void *arg)
 
 		/* update display window */
 		refresh(tick);
-		XPutImage(display, window, gc, ximage, 0, 0, 0, 0,
-			  xsize, ysize);
-		XSync(display, False);
+		if (dx0 < dx1) {
+			/* copy only the changed pixels to the window */
+			XPutImage(display, window, gc, ximage, dx0, dy0,
+				  dx0, dy0, dx1 - dx0, dy1 - dy0);
+			XSync(display, False);
+			dx0 = dx1 = 0;
+		}
 
 		/* unlock display, thread can be canceled again */
 		XUnlockDisplay(display);
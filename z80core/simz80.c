@@ -26,6 +26,10 @@
 #include "simctl.h"
 #endif
 
+#ifdef HAS_VIDCAP
+#include "vidcap.h"
+#endif
+
 #ifndef EXCLUDE_Z80
 
 #ifdef WANT_GUI
@@ -637,6 +641,16 @@ void cpu_z80(void)
 			if (cpu_time)
 				cpu_freq = T * 1000000ULL / cpu_time;
 			t1 = t2;
+#ifdef HAS_BATCH
+			if (b_tlimit && T >= b_tlimit) {
+				cpu_error = TSLIMIT;
+				cpu_state = ST_STOPPED;
+			}
+#endif
+#ifdef HAS_VIDCAP
+			if (V_flag && T >= vidcap_next)
+				vidcap_frame();
+#endif
 		}
 
 #ifdef WANT_ICE